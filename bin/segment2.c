@@ -2403,6 +2403,15 @@ const Gfx dl_ia_text_tex_settings[] = {
     gsSP2Triangles( 0,  1,  2, 0x0, 0,  2,  3, 0x0),
     gsSPEndDisplayList(),
 };
+
+#if MULTILANG && defined(FONT_GLYPH_ATLAS)
+// Draws a glyph of the font atlas, the atlas page and render tile are set up by render_generic_char
+const Gfx dl_ia_text_atlas_char[] = {
+    gsSPVertex(vertex_ia8_char, 4, 0),
+    gsSP2Triangles( 0,  1,  2, 0x0, 0,  2,  3, 0x0),
+    gsSPEndDisplayList(),
+};
+#endif
 #elif defined(VERSION_JP) || defined(VERSION_SH)
 // 0x0200EE68 - 0x0200EEA8
 const Gfx dl_ia_text_begin[] = {
@@ -0,0 +1,9 @@
+# Compress binary file with whichever format scores best for this segment
+$(BUILD_DIR)/%.szp: $(BUILD_DIR)/%.bin
+	$(call print,Compressing:,$<,$@)
+	$(V)$(PYTHON) $(COMPRESS_AUTO) --weight $(COMPRESS_AUTO_WEIGHT) --formats "$(COMPRESS_AUTO_FORMATS)" --tools-dir $(TOOLS_DIR) --gzip $(GZIP) --gzip-level $(if $(filter std,$(GZIPVER)),9,12) $< $@
+
+# convert binary szp to object file
+$(BUILD_DIR)/%.szp.o: $(BUILD_DIR)/%.szp
+	$(call print,Converting AUTO to ELF:,$<,$@)
+	$(V)$(LD) -r -b binary $< -o $@
@@ -0,0 +1,9 @@
+# Compress binary file
+$(BUILD_DIR)/%.szp: $(BUILD_DIR)/%.bin
+	$(call print,Compressing:,$<,$@)
+	$(V)$(LZ4TOOL) $< $@
+
+# convert binary szp to object file
+$(BUILD_DIR)/%.szp.o: $(BUILD_DIR)/%.szp
+	$(call print,Converting LZ4 to ELF:,$<,$@)
+	$(V)$(LD) -r -b binary $< -o $@
\ No newline at end of file
@@ -26,6 +26,25 @@
  */
 #define MAX_REFERENCED_WALLS 4
 
+/**
+ * Gathers the surfaces around Mario once per step, so the wall, floor and ceiling checks of his four quarter steps only go through the surfaces that could actually be hit.
+ * The results are exactly the same as without it, checks that don't fit in the gathered area fall back to the normal lists.
+ * COLLISION_PROBE_MAX_CELLS is how many cells can be gathered and COLLISION_PROBE_MAX_SURFACES how many surfaces, past either the probe is skipped for that step.
+ */
+#define COLLISION_PROBE
+#define COLLISION_PROBE_MAX_CELLS 4
+#define COLLISION_PROBE_MAX_SURFACES 256
+
+/**
+ * Gathers the static surfaces around the camera for its floor, ceiling, wall and ray checks, and keeps them across frames until the camera leaves the gathered area.
+ * Requires COLLISION_PROBE. The gathered area is COLLISION_PROBE_CAMERA_SLACK units larger than needed on every side, so a moving camera doesn't gather again every frame.
+ * Past COLLISION_PROBE_CAMERA_MAX_CELLS cells or COLLISION_PROBE_CAMERA_MAX_SURFACES surfaces the camera uses the normal lists.
+ */
+#define COLLISION_PROBE_CAMERA
+#define COLLISION_PROBE_CAMERA_MAX_CELLS 16
+#define COLLISION_PROBE_CAMERA_MAX_SURFACES 1024
+#define COLLISION_PROBE_CAMERA_SLACK 512
+
 /**
  * Collision data is the type that the collision system uses. All data by default is stored as an s16, but you may change it to s32.
  * Naturally, that would double the size of all collision data, but would allow you to use 32 bit values instead of 16.
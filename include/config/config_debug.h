@@ -64,6 +64,19 @@
  */
 // #define VISUAL_DEBUG
 
+/**
+ * Records every floor, ceiling, wall, water and raycast query into a ring buffer.
+ * With UNF enabled, each frame's queries are streamed over USB so they can be replayed with tools/colreplay.
+ */
+// #define COLLISION_TRACE
+
+/**
+ * Keeps a rolling history of per-frame profiler times, object counts, dynamic surfaces, gfx pool usage and audio notes.
+ * Whenever a frame misses its vblank, the frames around it are frozen into a snapshot, viewable on the "Lag Frames" Puppyprint page.
+ * With UNF enabled, snapshots are also printed over USB as they are recorded. Requires USE_PROFILER.
+ */
+// #define LAG_FRAME_RECORDER
+
 /**
  * Opens all courses and doors. Used for debugging purposes to unlock all content.
  */
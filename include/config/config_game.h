@@ -93,6 +93,12 @@
  */
 #define PREVENT_DEATH_LOOP
 
+/**
+ * Sets aside a general purpose heap (gGeneralHeap, GENERAL_HEAP_SIZE bytes) in the main pool, whose blocks can be freed in any order.
+ * Nothing in the game allocates from it yet, so only enable this for code that uses heap_pool_alloc.
+ */
+// #define GENERAL_HEAP
+
 /**
  * The level that the game starts with immediately after file select.
  * The levelscript needs to have a MARIO_POS command for this to work.
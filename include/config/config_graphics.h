@@ -5,10 +5,17 @@
  *********************/
 
 /**
- * The size of the master display list (gDisplayListHead). 6400 is vanilla.
+ * The size of the master display list (gDisplayListHead), in Gfx commands of 8 bytes each. 6400 is vanilla.
  */
 #define GFX_POOL_SIZE 10000
 
+/**
+ * Lets the CPU start on the next frame while the RSP and RDP are still drawing the previous one, using a third gfx pool.
+ * The scheduler presents each framebuffer as soon as the RDP is done with it, so the CPU and RDP halves of a frame overlap instead of adding up.
+ * Costs another gfx pool of RAM (GFX_POOL_SIZE Gfx commands, 8 bytes each), and up to one extra frame of input latency.
+ */
+// #define PIPELINED_GFX
+
 /**
  * Causes the global light direction to be in world space,
  * this allows you to have a singular light source that doesn't change with the camera's rotation.
@@ -39,6 +46,49 @@
  */
 #define SKYBOX_SIZE 1
 
+/**
+ * Keeps the skybox's display list across frames and only rebuilds it when the camera turns far enough to change the tiles being drawn. Costs about 1.2KB of RAM per gfx pool at SKYBOX_SIZE 1 and saves the same amount of gfx pool every frame.
+ */
+#define SKYBOX_CACHE
+
+/**
+ * Keeps each painting's transform across frames while it doesn't move, and a rippling painting's mesh until its ripple changes. Rippling paintings far from the camera also update their ripples less often.
+ */
+#define PAINTING_CACHE
+
+/**
+ * With MULTILANG, expands the 1-bit dialog font into an IA4 atlas once instead of into the gfx pool for every character
+ * drawn. Text then loads a whole 64 glyph page of the atlas into TMEM at once and only reloads when the page changes.
+ * Costs 16KB of RAM.
+ */
+#define FONT_GLYPH_ATLAS
+
+/**
+ * Keeps the display lists of short print_text labels (the HUD counters) and of the power meter across frames,
+ * and only rebuilds them when what they show changes. Costs about 5KB of RAM per gfx pool.
+ */
+#define HUD_DL_CACHE
+
+/**
+ * Billboards drawn with the same scale share their fixed point rotation, so each coin, flame or other billboarded
+ * object only converts its translation instead of its whole matrix. Also loads the LookAt once per frame instead of
+ * once for every display list drawn.
+ */
+#define BILLBOARD_INSTANCING
+
+/**
+ * Flattens the static parts of each area's level geometry (display list and fixed transform nodes) into a list of
+ * display lists with precomputed matrices and bounds when the area loads. The renderer draws that list, skipping
+ * pieces that are off screen, instead of walking those nodes and rebuilding their matrices every frame.
+ */
+#define STATIC_GEO_FLATTENING
+
+/**
+ * Keeps the vertices and display lists of scrolling textures (sand, waterfalls, lava, treadmills) across frames,
+ * and only rewrites their texture coordinates when the texture moved. Costs about 2.5KB of RAM per gfx pool.
+ */
+#define MOVTEX_VTX_CACHE
+
 /**
  * When this option is enabled, LODs will ONLY work on console.
  * When this option is disabled, LODs will work regardless of whether console or emulator is used.
@@ -121,6 +171,11 @@
  */
 #define LEGACY_SHADOW_IDS
 
+/**
+ * Lets the shadows of objects without a floor of their own reuse the floor they found on the last few frames while the object stays over it, instead of calling find_floor every frame.
+ */
+#define SHADOW_FLOOR_CACHE
+
 
 /**
  * May break viewport widescreen hacks.
@@ -4,6 +4,29 @@
  * SPECIFIC OBJECT SETTINGS *
  ****************************/
 
+/*******************
+ * -- PARTICLES --
+ *******************/
+
+/**
+ * Spawns the mist, dust and white puff particles from cur_obj_spawn_particles in a separate particle pool
+ * instead of as objects. They're updated in one pass and drawn with one display list per particle type,
+ * and no longer use up object slots.
+ */
+// #define LIGHTWEIGHT_PARTICLES
+
+/*****************
+ * -- LOOKUPS --
+ *****************/
+
+/**
+ * Keeps every object in a chain with the other objects that share its behavior, so that
+ * cur_obj_find_nearest_object_with_behavior, count_objects_with_behavior and
+ * cur_obj_find_nearby_held_actor only look at objects that can match instead of walking a
+ * whole object list. Costs 12 bytes per object.
+ */
+#define OBJECT_BEHAVIOR_CHAINS
+
 /**************
  * -- COIN --
  **************/
@@ -63,6 +63,8 @@
     #undef PUPPYPRINT_DEBUG_CYCLES
     #undef VANILLA_STYLE_CUSTOM_DEBUG
     #undef VISUAL_DEBUG
+    #undef COLLISION_TRACE
+    #undef LAG_FRAME_RECORDER
     #undef UNLOCK_ALL
     #undef COMPLETE_SAVE_FILE
     #undef UNLOCK_FPS
@@ -107,6 +109,10 @@
     #define USE_PROFILER
 #endif // PUPPYPRINT_DEBUG
 
+#ifndef USE_PROFILER
+    #undef LAG_FRAME_RECORDER
+#endif // !USE_PROFILER
+
 #ifdef COMPLETE_SAVE_FILE
     #undef UNLOCK_ALL
     #define UNLOCK_ALL
@@ -140,6 +146,15 @@
 #endif // !FLYING_CAMERA_MODE
 
 
+/*****************
+ * config_collision.h
+ */
+
+#ifndef COLLISION_PROBE
+    #undef COLLISION_PROBE_CAMERA // The camera probe is built on the step probe.
+#endif // !COLLISION_PROBE
+
+
 /*****************
  * config_game.h
  */
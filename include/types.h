@@ -185,7 +185,10 @@ struct SPTask {
     /*0x40*/ OSMesgQueue *msgqueue;
     /*0x44*/ OSMesg msg;
     /*0x48*/ enum SpTaskState state;
-}; // size = 0x4C, align = 0x8
+#ifdef PIPELINED_GFX
+    /*0x4C*/ void *framebuffer; // Presented by the scheduler once the RDP is done drawing into it.
+#endif
+}; // size = 0x4C (0x50 with PIPELINED_GFX), align = 0x8
 
 struct VblankHandler {
     OSMesgQueue *queue;
@@ -260,6 +263,9 @@ struct ObjectNode {
 // whether some of these pointers point to ObjectNode or Object.
 #define MAX_OBJECT_FIELDS 0x50
 
+// The members up to and including the start of rawData are the ones read for every object, every frame,
+// by the object update and collision loops, so they're kept together to share as few cache lines as possible.
+// Members only touched by behaviors or when something actually happens live after rawData.
 struct Object {
     /*0x000*/ struct ObjectNode header;
     /*0x068*/ struct Object *parentObj;
@@ -267,7 +273,10 @@ struct Object {
     /*0x070*/ u32 collidedObjInteractTypes;
     /*0x074*/ s16 activeFlags;
     /*0x076*/ s16 numCollidedObjs;
-    /*0x078*/ struct Object *collidedObjs[4];
+    /*0x078*/ f32 hitboxRadius;
+    /*0x07C*/ f32 hitboxHeight;
+    /*0x080*/ f32 hurtboxRadius;
+    /*0x084*/ f32 hitboxDownOffset;
     /*0x088*/
     union {
         // Object fields. See object_fields.h.
@@ -306,17 +315,26 @@ struct Object {
     /*0x1D4*/ uintptr_t bhvStack[8];
     /*0x1F4*/ s16 bhvDelayTimer;
     /*0x1F6*/ s16 respawnInfoType;
-    /*0x1F8*/ f32 hitboxRadius;
-    /*0x1FC*/ f32 hitboxHeight;
-    /*0x200*/ f32 hurtboxRadius;
-    /*0x204*/ f32 hurtboxHeight;
-    /*0x208*/ f32 hitboxDownOffset;
+    /*0x1F8*/ struct Object *collidedObjs[4];
+    /*0x208*/ f32 hurtboxHeight;
     /*0x20C*/ const BehaviorScript *behavior;
     /*0x210*/ u32 unused2;
     /*0x214*/ struct Object *platform;
     /*0x218*/ void *collisionData;
     /*0x21C*/ Mat4 transform;
     /*0x25C*/ void *respawnInfo;
+#ifdef SHADOW_FLOOR_CACHE
+    /// The floor the object's shadow was last found on, see get_cached_shadow_floor
+    struct Surface *shadowFloor;
+    Vec3f shadowFloorPos;
+    u32 shadowFloorTimer;
+#endif
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    /// Links to the other objects whose behavior hashes to the same chain, see spawn_object.c
+    struct Object *behaviorChainNext;
+    struct Object *behaviorChainPrev;
+    u8 objListIndex;
+#endif
 };
 
 struct ObjectHitbox {
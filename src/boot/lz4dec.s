@@ -0,0 +1,143 @@
+/* LZ4 block decoder, scheduled by hand for the VR4300.
+	void lz4_decompress(unsigned char *compress, unsigned char *decompress);
+	first argument is the LZ4S data (align 4), made by tools/lz4pack.
+	next argument is the output buffer, which must hold the decoded size from the header.
+
+	Header: "LZ4S", decoded size, payload size, 4 bytes of padding. The payload is a plain
+	LZ4 block, a list of sequences of
+		token (literal length << 4 | (match length - 4)), literal length extension bytes,
+		literals, match offset (16-bit little endian), match length extension bytes
+	where a nibble of 15 means extension bytes follow, each adding its value, until one is
+	not 255. The last sequence ends after its literals.
+
+	Every load has an unrelated instruction before its result is used and every branch delay
+	slot does work where possible. Copies use lwl/lwr/swl/swr to move a word at a time no
+	matter how the input and output line up, and fall back to bytes for the last 0-3 bytes
+	and for matches closer than 4 bytes.
+*/
+# assembler directives
+.set noat      # allow manual use of $at
+.set noreorder # delay slots are filled by hand
+.set gp=64
+.include "macros.inc"
+
+.text
+glabel lz4_decompress
+	lw	$t0, 4($a0)		# t0 = decoded size
+	addiu	$a0, $a0, 16		# a0 = first token
+	li	$t9, 15			# t9 = nibble value with extension bytes
+	li	$t8, 255		# t8 = extension byte value with more following
+	beq	$t0, $zero, .Ldone	# nothing to decode
+	 addu	$t0, $t0, $a1		# t0 = output end
+
+/* ===== SEQUENCE ===== */
+.Lsequence:
+	lbu	$t1, 0($a0)		# t1 = token
+	addiu	$a0, $a0, 1
+	srl	$t2, $t1, 4		# t2 = literal length
+	beq	$t2, $zero, .Lmatch
+	 andi	$t1, $t1, 0xF		# t1 = match length - 4
+	bne	$t2, $t9, .Lliterals
+	 addu	$t3, $a1, $t2		# t3 = literal end
+.Llitext:
+	lbu	$t6, 0($a0)
+	addiu	$a0, $a0, 1
+	beq	$t6, $t8, .Llitext
+	 addu	$t2, $t2, $t6
+	addu	$t3, $a1, $t2		# t3 = literal end
+
+/* ===== LITERALS ===== */
+.Lliterals:
+	sltiu	$at, $t2, 4
+	bne	$at, $zero, .Llitbytes
+	 nop
+.Llitwords:
+	lwl	$t4, 0($a0)
+	lwr	$t4, 3($a0)
+	addiu	$a0, $a0, 4
+	addiu	$a1, $a1, 4
+	swl	$t4, -4($a1)
+	subu	$at, $t3, $a1
+	sltiu	$at, $at, 4
+	beq	$at, $zero, .Llitwords
+	 swr	$t4, -1($a1)
+.Llitbytes:
+	beq	$a1, $t3, .Llitdone
+	 nop
+.Llitbyte:
+	lbu	$t4, 0($a0)
+	addiu	$a0, $a0, 1
+	addiu	$a1, $a1, 1
+	bne	$a1, $t3, .Llitbyte
+	 sb	$t4, -1($a1)
+.Llitdone:
+	beq	$a1, $t0, .Ldone	# the last sequence has no match
+	 nop
+
+/* ===== MATCH ===== */
+.Lmatch:
+	lbu	$t4, 0($a0)		# offset low byte
+	lbu	$t5, 1($a0)		# offset high byte
+	addiu	$a0, $a0, 2
+	sll	$t5, $t5, 8
+	or	$t4, $t4, $t5		# t4 = offset
+	bne	$t1, $t9, .Lmatchcopy
+	 subu	$t5, $a1, $t4		# t5 = match source
+.Lmatchext:
+	lbu	$t6, 0($a0)
+	addiu	$a0, $a0, 1
+	beq	$t6, $t8, .Lmatchext
+	 addu	$t1, $t1, $t6
+.Lmatchcopy:
+	addiu	$t1, $t1, 4		# t1 = match length, at least 4
+	sltiu	$at, $t4, 4
+	bne	$at, $zero, .Lmatchnear
+	 addu	$t3, $a1, $t1		# t3 = match end
+.Lmatchwords:
+	lwl	$t6, 0($t5)		# 4 or more bytes back, so the whole word is already written
+	lwr	$t6, 3($t5)
+	addiu	$t5, $t5, 4
+	addiu	$a1, $a1, 4
+	swl	$t6, -4($a1)
+	subu	$at, $t3, $a1
+	sltiu	$at, $at, 4
+	beq	$at, $zero, .Lmatchwords
+	 swr	$t6, -1($a1)
+.Lmatchbytes:
+	beq	$a1, $t3, .Lsequence
+	 nop
+.Lmatchbyte:
+	lbu	$t6, 0($t5)
+	addiu	$t5, $t5, 1
+	addiu	$a1, $a1, 1
+	bne	$a1, $t3, .Lmatchbyte
+	 sb	$t6, -1($a1)
+	b	.Lsequence
+	 nop
+
+/* ===== NEAR MATCH ===== */
+/* Offsets 1-3 read bytes written by this match, so the first 4 bytes are copied one at a time.
+   Runs with offset 1 or 2 also repeat every 4 bytes, so they continue a word at a time. */
+.Lmatchnear:
+	lbu	$t6, 0($t5)
+	xori	$t7, $t4, 3		# t7 = 0 for offset 3
+	sb	$t6, 0($a1)
+	lbu	$t6, 1($t5)
+	addiu	$a1, $a1, 4
+	sb	$t6, -3($a1)
+	lbu	$t6, 2($t5)
+	subu	$at, $t3, $a1
+	sb	$t6, -2($a1)
+	lbu	$t6, 3($t5)
+	sltiu	$at, $at, 4
+	sb	$t6, -1($a1)
+	beq	$t7, $zero, .Lmatchbytes
+	 addiu	$t5, $t5, 4
+	beq	$at, $zero, .Lmatchwords
+	 addiu	$t5, $a1, -4		# the same bytes, a word back
+	b	.Lmatchbytes
+	 nop
+
+.Ldone:
+	jr	$ra
+	 nop
@@ -71,6 +71,12 @@ u32 gNumVblanks        = 0;
 s8  gResetTimer        = 0;
 s8  gNmiResetBarsTimer = 0;
 s8  gDebugLevelSelect  = FALSE;
+#ifdef PIPELINED_GFX
+// With three gfx pools, two frames can be waiting behind the one the RCP is drawing.
+static struct SPTask *sQueuedDisplaySPTask = NULL;
+static void *sPendingFramebuffer = NULL;
+static u32   sLastSwapVblank     = 0;
+#endif
 
 #ifdef VANILLA_DEBUG
 s8 gShowDebugText = FALSE;
@@ -114,6 +120,9 @@ void alloc_pool(void) {
 
     main_pool_init(start, end);
     gEffectsMemoryPool = mem_pool_init(EFFECTS_MEMORY_POOL, MEMORY_POOL_LEFT);
+#ifdef GENERAL_HEAP
+    gGeneralHeap = heap_pool_init(GENERAL_HEAP_SIZE, MEMORY_POOL_LEFT);
+#endif
 }
 
 void create_thread(OSThread *thread, OSId id, void (*entry)(void *), void *arg, void *sp, OSPri pri) {
@@ -159,7 +168,12 @@ void receive_new_tasks(void) {
 
     if (sCurrentDisplaySPTask == NULL && sNextDisplaySPTask != NULL) {
         sCurrentDisplaySPTask = sNextDisplaySPTask;
+#ifdef PIPELINED_GFX
+        sNextDisplaySPTask = sQueuedDisplaySPTask;
+        sQueuedDisplaySPTask = NULL;
+#else
         sNextDisplaySPTask = NULL;
+#endif
     }
 }
 
@@ -175,6 +189,39 @@ void start_sptask(s32 taskType) {
     gActiveSPTask->state = SPTASK_STATE_RUNNING;
 }
 
+#ifdef PIPELINED_GFX
+/**
+ * Shows a finished framebuffer, or holds onto it until the last one has been on screen for a full frame.
+ */
+static void present_framebuffer(void *framebuffer) {
+#ifndef UNLOCK_FPS
+    if (gNumVblanks - sLastSwapVblank < 2) {
+        sPendingFramebuffer = framebuffer;
+        return;
+    }
+#endif
+    osViSwapBuffer(framebuffer);
+    sPendingFramebuffer = NULL;
+    sLastSwapVblank = gNumVblanks;
+}
+#endif
+
+/**
+ * With PIPELINED_GFX, a gfx task can be queued before the framebuffer it draws into has left the screen.
+ * Hold it back until the VI is no longer showing, or about to show, that framebuffer.
+ * Also hold it back while a finished frame still waits to be presented, so it can't be replaced and dropped.
+ */
+static s32 gfx_sptask_can_start(struct SPTask *spTask) {
+#ifdef PIPELINED_GFX
+    if (spTask->state == SPTASK_STATE_NOT_STARTED) {
+        return (sPendingFramebuffer == NULL
+             && spTask->framebuffer != osViGetCurrentFramebuffer()
+             && spTask->framebuffer != osViGetNextFramebuffer());
+    }
+#endif
+    return TRUE;
+}
+
 void interrupt_gfx_sptask(void) {
     if (gActiveSPTask->task.t.type == M_GFXTASK) {
         gActiveSPTask->state = SPTASK_STATE_INTERRUPTED;
@@ -185,7 +232,8 @@ void interrupt_gfx_sptask(void) {
 void start_gfx_sptask(void) {
     if (gActiveSPTask == NULL
      && sCurrentDisplaySPTask != NULL
-     && sCurrentDisplaySPTask->state == SPTASK_STATE_NOT_STARTED) {
+     && sCurrentDisplaySPTask->state == SPTASK_STATE_NOT_STARTED
+     && gfx_sptask_can_start(sCurrentDisplaySPTask)) {
         start_sptask(M_GFXTASK);
         profiler_rsp_started(PROFILER_RSP_GFX);
     }
@@ -204,6 +252,11 @@ void handle_vblank(void) {
     }
 
     receive_new_tasks();
+#ifdef PIPELINED_GFX
+    if (sPendingFramebuffer != NULL) {
+        present_framebuffer(sPendingFramebuffer);
+    }
+#endif
 
     // First try to kick off an audio task. If the gfx task is currently
     // running, we need to asynchronously interrupt it -- handle_sp_complete
@@ -224,7 +277,8 @@ void handle_vblank(void) {
     } else {
         if (gActiveSPTask == NULL
          && sCurrentDisplaySPTask != NULL
-         && sCurrentDisplaySPTask->state != SPTASK_STATE_FINISHED) {
+         && sCurrentDisplaySPTask->state != SPTASK_STATE_FINISHED
+         && gfx_sptask_can_start(sCurrentDisplaySPTask)) {
             start_sptask(M_GFXTASK);
             profiler_rsp_started(PROFILER_RSP_GFX);
         }
@@ -269,7 +323,8 @@ void handle_sp_complete(void) {
             profiler_rsp_completed(PROFILER_RSP_AUDIO);
             // After audio tasks come gfx tasks.
             if ((sCurrentDisplaySPTask != NULL)
-             && (sCurrentDisplaySPTask->state != SPTASK_STATE_FINISHED)) {
+             && (sCurrentDisplaySPTask->state != SPTASK_STATE_FINISHED)
+             && gfx_sptask_can_start(sCurrentDisplaySPTask)) {
                 if (sCurrentDisplaySPTask->state == SPTASK_STATE_INTERRUPTED) {
                     profiler_rsp_resumed();
                 } else {
@@ -296,7 +351,18 @@ void handle_dp_complete(void) {
         osSendMesg(sCurrentDisplaySPTask->msgqueue, sCurrentDisplaySPTask->msg, OS_MESG_NOBLOCK);
     }
     sCurrentDisplaySPTask->state = SPTASK_STATE_FINISHED_DP;
+#ifdef PIPELINED_GFX
+    present_framebuffer(sCurrentDisplaySPTask->framebuffer);
+    // Start the frame queued behind this one right away, rather than at the next vblank.
+    sCurrentDisplaySPTask = sNextDisplaySPTask;
+    sNextDisplaySPTask = sQueuedDisplaySPTask;
+    sQueuedDisplaySPTask = NULL;
+    if (sCurrentDisplaySPTask != NULL) {
+        osSendMesg(&gIntrMesgQueue, (OSMesg) MESG_START_GFX_SPTASK, OS_MESG_NOBLOCK);
+    }
+#else
     sCurrentDisplaySPTask = NULL;
+#endif
 }
 
 OSTimerEx RCPHangTimer;
@@ -464,6 +530,22 @@ void exec_display_list(struct SPTask *spTask) {
     if (spTask != NULL) {
         osWritebackDCacheAll();
         spTask->state = SPTASK_STATE_NOT_STARTED;
+#ifdef PIPELINED_GFX
+        // handle_dp_complete moves the queue up on the scheduler thread, so don't let it run halfway through this.
+        u32 saved = __osDisableInt();
+        s32 startNow = (sCurrentDisplaySPTask == NULL);
+        if (startNow) {
+            sCurrentDisplaySPTask = spTask;
+        } else if (sNextDisplaySPTask == NULL) {
+            sNextDisplaySPTask = spTask;
+        } else {
+            sQueuedDisplaySPTask = spTask;
+        }
+        __osRestoreInt(saved);
+        if (startNow) {
+            osSendMesg(&gIntrMesgQueue, (OSMesg) MESG_START_GFX_SPTASK, OS_MESG_NOBLOCK);
+        }
+#else
         if (sCurrentDisplaySPTask == NULL) {
             sCurrentDisplaySPTask = spTask;
             sNextDisplaySPTask = NULL;
@@ -471,6 +553,7 @@ void exec_display_list(struct SPTask *spTask) {
         } else {
             sNextDisplaySPTask = spTask;
         }
+#endif
     }
 }
 
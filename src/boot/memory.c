@@ -4,15 +4,16 @@
 
 #include "buffers/buffers.h"
 #include "slidec.h"
+#include "game/debug.h"
 #include "game/game_init.h"
 #include "game/main.h"
 #include "game/memory.h"
 #include "segment_symbols.h"
 #include "segments.h"
-#ifdef GZIP
+#if defined(GZIP) || defined(COMPRESS_AUTO)
 #include <gzip.h>
 #endif
-#if defined(RNC1) || defined(RNC2)
+#if defined(RNC1) || defined(RNC2) || defined(COMPRESS_AUTO)
 #include <rnc.h>
 #endif
 #ifdef UNF
@@ -45,6 +46,34 @@ struct MemoryPool {
     struct MemoryBlock freeList;
 };
 
+#define HEAP_ALIGN_LOG2  4 // Blocks are 16 byte aligned, same as the main pool.
+#define HEAP_SL_LOG2     4 // Each power of two size class is split into 16 free lists.
+#define HEAP_SL_COUNT    (1 << HEAP_SL_LOG2)
+#define HEAP_SMALL_BLOCK (1 << (HEAP_SL_LOG2 + HEAP_ALIGN_LOG2))
+#define HEAP_FL_COUNT    (32 - (HEAP_SL_LOG2 + HEAP_ALIGN_LOG2) + 1)
+#define HEAP_BLOCK_FREE  (1 << 0)
+#define HEAP_BLOCK_SIZE(block) ((block)->size & ~0xF)
+#define HEAP_NEXT_BLOCK(block) ((struct HeapBlock *) ((u8 *) (block) + HEAP_BLOCK_SIZE(block)))
+
+struct HeapBlock {
+    struct HeapBlock *prevPhys; // The block right before this one in memory.
+    u32 size;                   // Includes this header. The lowest bits hold the HEAP_BLOCK flags.
+    // Only used while the block is free.
+    struct HeapBlock *nextFree;
+    struct HeapBlock *prevFree;
+};
+
+#define HEAP_MIN_BLOCK (sizeof(struct HeapBlock) + (1 << HEAP_ALIGN_LOG2))
+
+struct HeapPool {
+    u32 totalSpace;
+    u32 usedSpace;
+    u32 flBitmap;
+    u32 slBitmap[HEAP_FL_COUNT];
+    struct HeapBlock *freeLists[HEAP_FL_COUNT][HEAP_SL_COUNT];
+    struct HeapBlock *firstBlock;
+};
+
 extern uintptr_t sSegmentTable[32];
 extern u32 sPoolFreeSpace;
 extern u8 *sPoolStart;
@@ -59,6 +88,14 @@ extern struct MainPoolBlock *sPoolListHeadR;
  */
 struct MemoryPool *gEffectsMemoryPool;
 
+#ifdef GENERAL_HEAP
+/**
+ * General purpose heap that supports freeing blocks in any order.
+ * Meant for streaming loaders, caches and anything else that outlives a main pool push/pop.
+ */
+struct HeapPool *gGeneralHeap;
+#endif
+
 
 uintptr_t sSegmentTable[32];
 u32 sPoolFreeSpace;
@@ -367,6 +404,56 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
     return dest;
 }
 
+#ifdef COMPRESS_AUTO
+// Format tags at the start of a COMPRESS=auto segment, see tools/compress_auto.py.
+#define COMPRESS_TAG_YAY0 0x59617930 // "Yay0"
+#define COMPRESS_TAG_MIO0 0x4D494F30 // "MIO0"
+#define COMPRESS_TAG_LZ4  0x4C5A3453 // "LZ4S"
+#define COMPRESS_TAG_RNC1 0x524E4301 // "RNC\1"
+#define COMPRESS_TAG_RNC2 0x524E4302 // "RNC\2"
+#define COMPRESS_TAG_GZIP 0x475A4950 // "GZIP", followed by decoded size and deflate stream size
+#define COMPRESS_TAG_RAW  0x52415730 // "RAW0", followed by decoded size
+
+/**
+ * Decompress a segment from a COMPRESS=auto build. Every segment was encoded in whichever
+ * format suited it best, so pick the decoder from the tag at the start of the data.
+ */
+static void decompress_auto(u8 *compressed, u8 *dest) {
+    u32 *header = (u32 *) compressed;
+
+    switch (header[0]) {
+        case COMPRESS_TAG_YAY0:
+            slidstart(compressed, dest);
+            break;
+        case COMPRESS_TAG_MIO0:
+            decompress(compressed, dest);
+            break;
+        case COMPRESS_TAG_LZ4:
+            lz4_decompress(compressed, dest);
+            break;
+        case COMPRESS_TAG_RNC1:
+            Propack_UnpackM1(compressed, dest);
+            break;
+        case COMPRESS_TAG_RNC2:
+            Propack_UnpackM2(compressed, dest);
+            break;
+        case COMPRESS_TAG_GZIP:
+            expand_gzip(compressed + 16, dest, header[2], header[1]);
+            break;
+        case COMPRESS_TAG_RAW:
+            bcopy(compressed + 16, dest, header[1]);
+            break;
+        default: {
+            // Leaving the segment unfilled would only crash somewhere less obvious later on.
+            char errorMsg[48];
+            sprintf(errorMsg, "Unknown compression tag: 0x%08X", header[0]);
+            error(errorMsg);
+            break;
+        }
+    }
+}
+#endif
+
 /**
  * Decompress the block of ROM data from srcStart to srcEnd and return a
  * pointer to an allocated buffer holding the decompressed data. Set the
@@ -385,10 +472,14 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
     // Decompressed size from end of gzip
     u32 *size = (u32 *) (compressed + compSize);
 #else
-    // Decompressed size from header (This works for non-mio0 because they also have the size in same place)
+    // Decompressed size from header (This works for non-mio0 because they also have the size in same place,
+    // which includes every format COMPRESS=auto picks from)
     u32 *size = (u32 *) (compressed + 4);
 #endif
     if (compressed != NULL) {
+#ifdef PUPPYPRINT_DEBUG
+        OSTime loadStart = osGetTime();
+#endif
 #ifdef UNCOMPRESSED
         dest = main_pool_alloc(compSize, MEMORY_POOL_LEFT);
         dma_read(dest, srcStart, srcEnd);
@@ -397,6 +488,9 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
         dest = main_pool_alloc(*size, MEMORY_POOL_LEFT);
 #endif
         if (dest != NULL) {
+#ifdef PUPPYPRINT_DEBUG
+            OSTime decompressStart = osGetTime();
+#endif
             osSyncPrintf("start decompress\n");
 #ifdef GZIP
             expand_gzip(compressed, dest, compSize, (u32)size);
@@ -408,8 +502,19 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
             slidstart(compressed, dest);
 #elif MIO0
             decompress(compressed, dest);
+#elif LZ4
+            lz4_decompress(compressed, dest);
+#elif COMPRESS_AUTO
+            decompress_auto(compressed, dest);
 #endif
             osSyncPrintf("end decompress\n");
+#ifdef PUPPYPRINT_DEBUG
+            // Build the same ROM with each COMPRESS option to compare load times.
+            OSTime loadEnd = osGetTime();
+            append_puppyprint_log("Seg %d: %dKB, DMA %dus, decompress %dus.", segment, (s32)(*size >> 10),
+                                  (s32)OS_CYCLES_TO_USEC(decompressStart - loadStart),
+                                  (s32)OS_CYCLES_TO_USEC(loadEnd - decompressStart));
+#endif
             set_segment_base_addr(segment, dest);
             main_pool_free(compressed);
         }
@@ -586,6 +691,208 @@ void mem_pool_free(struct MemoryPool *pool, void *addr) {
     }
 }
 
+/**
+ * Find which free list a block of this size belongs in.
+ */
+static void heap_get_list_index(u32 size, s32 *fl, s32 *sl) {
+    if (size < HEAP_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = size >> HEAP_ALIGN_LOG2;
+    } else {
+        s32 bit = 31 - __builtin_clz(size);
+        *fl = bit - (HEAP_SL_LOG2 + HEAP_ALIGN_LOG2) + 1;
+        *sl = (size >> (bit - HEAP_SL_LOG2)) ^ HEAP_SL_COUNT;
+    }
+}
+
+static void heap_insert_free_block(struct HeapPool *pool, struct HeapBlock *block) {
+    s32 fl, sl;
+
+    heap_get_list_index(HEAP_BLOCK_SIZE(block), &fl, &sl);
+    block->size |= HEAP_BLOCK_FREE;
+    block->prevFree = NULL;
+    block->nextFree = pool->freeLists[fl][sl];
+    if (block->nextFree != NULL) {
+        block->nextFree->prevFree = block;
+    }
+    pool->freeLists[fl][sl] = block;
+    pool->flBitmap |= (1 << fl);
+    pool->slBitmap[fl] |= (1 << sl);
+}
+
+static void heap_remove_free_block(struct HeapPool *pool, struct HeapBlock *block) {
+    s32 fl, sl;
+
+    heap_get_list_index(HEAP_BLOCK_SIZE(block), &fl, &sl);
+    block->size &= ~HEAP_BLOCK_FREE;
+    if (block->nextFree != NULL) {
+        block->nextFree->prevFree = block->prevFree;
+    }
+    if (block->prevFree != NULL) {
+        block->prevFree->nextFree = block->nextFree;
+    } else {
+        pool->freeLists[fl][sl] = block->nextFree;
+        if (block->nextFree == NULL) {
+            pool->slBitmap[fl] &= ~(1 << sl);
+            if (pool->slBitmap[fl] == 0) {
+                pool->flBitmap &= ~(1 << fl);
+            }
+        }
+    }
+}
+
+/**
+ * Find a free block that is at least the given size, using the bitmaps instead of walking any list.
+ * The size is rounded up to the next list first, so that any block in the chosen list is big enough.
+ */
+static struct HeapBlock *heap_find_free_block(struct HeapPool *pool, u32 size) {
+    s32 fl, sl;
+
+    if (size >= HEAP_SMALL_BLOCK) {
+        size += (1 << ((31 - __builtin_clz(size)) - HEAP_SL_LOG2)) - 1;
+    }
+    heap_get_list_index(size, &fl, &sl);
+    if (fl >= HEAP_FL_COUNT) {
+        return NULL;
+    }
+
+    u32 slMap = pool->slBitmap[fl] & (~0U << sl);
+    if (slMap == 0) {
+        u32 flMap = pool->flBitmap & (~0U << (fl + 1));
+        if (flMap == 0) {
+            return NULL;
+        }
+        fl = __builtin_ctz(flMap);
+        slMap = pool->slBitmap[fl];
+    }
+    return pool->freeLists[fl][__builtin_ctz(slMap)];
+}
+
+/**
+ * Allocate a general purpose heap from the main pool. Blocks can be allocated and
+ * freed in any order, and both take constant time.
+ * Return NULL if there is not enough space in the main pool.
+ */
+struct HeapPool *heap_pool_init(u32 size, u32 side) {
+    struct HeapPool *pool = NULL;
+    u32 headerSize = ALIGN16(sizeof(struct HeapPool));
+
+    size = ALIGN16(size);
+    // The extra header at the end marks the last block, so it never gets merged past the end of the heap.
+    void *addr = main_pool_alloc(headerSize + size + sizeof(struct HeapBlock), side);
+    if (addr != NULL) {
+        pool = (struct HeapPool *) addr;
+        bzero(pool, sizeof(struct HeapPool));
+        pool->totalSpace = size;
+        pool->firstBlock = (struct HeapBlock *) ((u8 *) addr + headerSize);
+
+        struct HeapBlock *block = pool->firstBlock;
+        block->prevPhys = NULL;
+        block->size = size;
+
+        struct HeapBlock *end = HEAP_NEXT_BLOCK(block);
+        end->prevPhys = block;
+        end->size = 0;
+
+        heap_insert_free_block(pool, block);
+    }
+#ifdef PUPPYPRINT_DEBUG
+    gPoolMem += headerSize + size + sizeof(struct HeapBlock) + 16;
+#endif
+    return pool;
+}
+
+/**
+ * Allocate a 16 byte aligned block from a heap. Return NULL if there is no free block large enough.
+ */
+void *heap_pool_alloc(struct HeapPool *pool, u32 size) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    size = ALIGN16(size) + sizeof(struct HeapBlock);
+    struct HeapBlock *block = heap_find_free_block(pool, size);
+    if (block == NULL) {
+        return NULL;
+    }
+    heap_remove_free_block(pool, block);
+
+    // Split off whatever is left over, if it is big enough to be used.
+    u32 remaining = HEAP_BLOCK_SIZE(block) - size;
+    if (remaining >= HEAP_MIN_BLOCK) {
+        struct HeapBlock *rest = (struct HeapBlock *) ((u8 *) block + size);
+        rest->prevPhys = block;
+        rest->size = remaining;
+        HEAP_NEXT_BLOCK(rest)->prevPhys = rest;
+        block->size = size;
+        heap_insert_free_block(pool, rest);
+    }
+
+    pool->usedSpace += HEAP_BLOCK_SIZE(block);
+    return (u8 *) block + sizeof(struct HeapBlock);
+}
+
+/**
+ * Free a block that was allocated using heap_pool_alloc, merging it with any free neighbours.
+ */
+void heap_pool_free(struct HeapPool *pool, void *addr) {
+    if (addr == NULL) {
+        return;
+    }
+
+    struct HeapBlock *block = (struct HeapBlock *) ((u8 *) addr - sizeof(struct HeapBlock));
+    struct HeapBlock *next = HEAP_NEXT_BLOCK(block);
+    struct HeapBlock *prev = block->prevPhys;
+
+    pool->usedSpace -= HEAP_BLOCK_SIZE(block);
+
+    if (next->size & HEAP_BLOCK_FREE) {
+        heap_remove_free_block(pool, next);
+        block->size += HEAP_BLOCK_SIZE(next);
+        HEAP_NEXT_BLOCK(block)->prevPhys = block;
+    }
+    if (prev != NULL && (prev->size & HEAP_BLOCK_FREE)) {
+        heap_remove_free_block(pool, prev);
+        prev->size += HEAP_BLOCK_SIZE(block);
+        HEAP_NEXT_BLOCK(prev)->prevPhys = prev;
+        block = prev;
+    }
+    heap_insert_free_block(pool, block);
+}
+
+/**
+ * Walk every block of a heap in memory order. This is not constant time, so only use it for debugging.
+ */
+void heap_pool_walk(struct HeapPool *pool, void (*func)(u32 offset, u32 size, s32 isFree)) {
+    struct HeapBlock *block = pool->firstBlock;
+
+    while (HEAP_BLOCK_SIZE(block) != 0) {
+        func(((u8 *) block - (u8 *) pool->firstBlock), HEAP_BLOCK_SIZE(block), (block->size & HEAP_BLOCK_FREE));
+        block = HEAP_NEXT_BLOCK(block);
+    }
+}
+
+/**
+ * Fill out the usage and fragmentation of a heap. Walks every block, so only use it for debugging.
+ */
+void heap_pool_get_stats(struct HeapPool *pool, struct HeapStats *stats) {
+    struct HeapBlock *block = pool->firstBlock;
+
+    bzero(stats, sizeof(struct HeapStats));
+    stats->totalSpace = pool->totalSpace;
+    stats->usedSpace = pool->usedSpace;
+    while (HEAP_BLOCK_SIZE(block) != 0) {
+        if (block->size & HEAP_BLOCK_FREE) {
+            stats->freeSpace += HEAP_BLOCK_SIZE(block);
+            stats->largestFree = MAX(stats->largestFree, HEAP_BLOCK_SIZE(block));
+            stats->numFreeBlocks++;
+        } else {
+            stats->numUsedBlocks++;
+        }
+        block = HEAP_NEXT_BLOCK(block);
+    }
+}
+
 void *alloc_display_list(u32 size) {
     void *ptr = NULL;
 
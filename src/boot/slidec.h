@@ -5,4 +5,6 @@ void slidstart(unsigned char *compress, unsigned char *decompress);
 
 void decompress(void *mio0, void *dest);
 
+void lz4_decompress(unsigned char *compress, unsigned char *decompress);
+
 #endif // SLIDEC_H
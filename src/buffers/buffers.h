@@ -26,7 +26,13 @@ extern struct SaveBuffer gSaveBuffer;
 
 extern u8 gGfxSPTaskStack[];
 
-extern struct GfxPool gGfxPools[2];
+#ifdef PIPELINED_GFX
+#define GFX_NUM_POOLS 3
+#else
+#define GFX_NUM_POOLS 2
+#endif
+
+extern struct GfxPool gGfxPools[GFX_NUM_POOLS];
 
 extern u8 adpcmbuf[];		/* Buffer for audio records ADPCM) */
 
@@ -884,3 +884,361 @@ UNUSED struct GraphNodeRoot *geo_find_root(struct GraphNode *graphNode) {
 
     return resGraphNode;
 }
+
+#ifdef STATIC_GEO_FLATTENING
+// How deep display lists called by a static display list are followed when measuring its bounds
+#define STATIC_LIST_MAX_DL_DEPTH 8
+
+struct StaticListBounds {
+    Vec3f min;
+    Vec3f max;
+    s32 numVertices;
+    s32 unbounded;
+};
+
+/**
+ * Whether the node and all of its children only draw display lists with fixed
+ * transformations, so that their matrices only need to be computed once.
+ */
+static s32 geo_node_is_static(struct GraphNode *graphNode) {
+    struct GraphNode *child = graphNode->children;
+
+    switch (graphNode->type) {
+        case GRAPH_NODE_TYPE_START:
+        case GRAPH_NODE_TYPE_DISPLAY_LIST:
+        case GRAPH_NODE_TYPE_TRANSLATION_ROTATION:
+        case GRAPH_NODE_TYPE_TRANSLATION:
+        case GRAPH_NODE_TYPE_ROTATION:
+        case GRAPH_NODE_TYPE_SCALE:
+            break;
+        default:
+            return FALSE;
+    }
+
+    if ((graphNode->flags & (GRAPH_RENDER_ACTIVE | GRAPH_RENDER_CHILDREN_FIRST)) != GRAPH_RENDER_ACTIVE) {
+        return FALSE;
+    }
+
+    if (child != NULL) {
+        do {
+            if (!geo_node_is_static(child)) {
+                return FALSE;
+            }
+        } while ((child = child->next) != graphNode->children);
+    }
+
+    return TRUE;
+}
+
+/**
+ * Counts the display lists and matrices a static node and its children flatten into.
+ */
+static void geo_count_static_lists(struct GraphNode *graphNode, s32 *numLists, s32 *numMatrices) {
+    struct GraphNode *child = graphNode->children;
+
+    if (graphNode->type != GRAPH_NODE_TYPE_START) {
+        if (graphNode->type != GRAPH_NODE_TYPE_DISPLAY_LIST) {
+            (*numMatrices)++;
+        }
+        if (((struct GraphNodeDisplayList *) graphNode)->displayList != NULL) {
+            (*numLists)++;
+        }
+    }
+
+    if (child != NULL) {
+        do {
+            geo_count_static_lists(child, numLists, numMatrices);
+        } while ((child = child->next) != graphNode->children);
+    }
+}
+
+#ifdef F3DEX_GBI_2
+/**
+ * Converts an address used by a display list, or returns NULL if it is in a segment that
+ * isn't loaded yet (for example one set by a generated list while rendering).
+ */
+static void *geo_static_list_address(uintptr_t addr) {
+#ifndef NO_SEGMENTED_MEMORY
+    s32 segment = (addr >> 24);
+
+    if (segment < 32) {
+        if (segment != 0 && get_segment_base_addr(segment) == (void *) 0x80000000) {
+            return NULL;
+        }
+        return segmented_to_virtual((void *) addr);
+    }
+#endif
+    return (void *) addr;
+}
+
+/**
+ * Adds the vertices loaded by a display list and the lists it calls to the bounds.
+ */
+static void geo_add_static_list_bounds(struct StaticListBounds *bounds, Gfx *dl, Mat4 mtx, s32 depth) {
+    Vtx *vtx;
+    Vec3f pos;
+    s32 i, j, n;
+
+    dl = geo_static_list_address((uintptr_t) dl);
+    if (dl == NULL || depth > STATIC_LIST_MAX_DL_DEPTH) {
+        bounds->unbounded = TRUE;
+        return;
+    }
+
+    while (!bounds->unbounded) {
+        switch (dl->words.w0 >> 24) {
+            case G_VTX:
+                vtx = geo_static_list_address(dl->words.w1);
+                if (vtx == NULL) {
+                    bounds->unbounded = TRUE;
+                    return;
+                }
+                n = (dl->words.w0 >> 12) & 0xFF;
+                for (i = 0; i < n; i++) {
+                    linear_mtxf_mul_vec3f_and_translate(mtx, pos, vtx[i].v.ob);
+                    if (bounds->numVertices++ == 0) {
+                        vec3f_copy(bounds->min, pos);
+                        vec3f_copy(bounds->max, pos);
+                    }
+                    for (j = 0; j < 3; j++) {
+                        bounds->min[j] = MIN(bounds->min[j], pos[j]);
+                        bounds->max[j] = MAX(bounds->max[j], pos[j]);
+                    }
+                }
+                break;
+            case G_DL:
+                geo_add_static_list_bounds(bounds, (Gfx *) dl->words.w1, mtx, depth + 1);
+                if (((dl->words.w0 >> 16) & 0xFF) == G_DL_NOPUSH) {
+                    return;
+                }
+                break;
+            case G_ENDDL:
+                return;
+        }
+        dl++;
+    }
+}
+#endif
+
+/**
+ * Measures the bounding sphere of a static display list in world space.
+ */
+static void geo_measure_static_list(struct StaticDisplayList *list, Mat4 mtx) {
+    list->radius = -1.0f;
+#ifdef F3DEX_GBI_2
+    struct StaticListBounds bounds;
+    s32 i;
+
+    bounds.numVertices = 0;
+    bounds.unbounded = FALSE;
+    geo_add_static_list_bounds(&bounds, list->displayList, mtx, 0);
+
+    if (!bounds.unbounded && bounds.numVertices != 0) {
+        for (i = 0; i < 3; i++) {
+            list->center[i] = (bounds.min[i] + bounds.max[i]) * 0.5f;
+        }
+        vec3f_get_dist(list->center, bounds.max, &list->radius);
+    }
+#endif
+}
+
+/**
+ * Flattens a static node and its children into the lists of a GraphNodeStaticList,
+ * doing the matrix math the renderer would do for them.
+ */
+static void geo_flatten_static_node(struct GraphNodeStaticList *staticList, struct GraphNode *graphNode,
+                                    Mat4 parentMtx, Mtx *parentFixed, Mtx **nextFixed) {
+    struct GraphNode *child = graphNode->children;
+    struct StaticDisplayList *list;
+    Mtx *fixed = parentFixed;
+    Vec3f translation;
+    Vec3f scale;
+    Mat4 mtx;
+
+    switch (graphNode->type) {
+        case GRAPH_NODE_TYPE_TRANSLATION_ROTATION:
+            vec3s_to_vec3f(translation, ((struct GraphNodeTranslationRotation *) graphNode)->translation);
+            mtxf_rotate_zxy_and_translate_and_mul(((struct GraphNodeTranslationRotation *) graphNode)->rotation,
+                                                  translation, mtx, parentMtx);
+            break;
+        case GRAPH_NODE_TYPE_TRANSLATION:
+            vec3s_to_vec3f(translation, ((struct GraphNodeTranslation *) graphNode)->translation);
+            mtxf_rotate_zxy_and_translate_and_mul(gVec3sZero, translation, mtx, parentMtx);
+            break;
+        case GRAPH_NODE_TYPE_ROTATION:
+            mtxf_rotate_zxy_and_translate_and_mul(((struct GraphNodeRotation *) graphNode)->rotation, gVec3fZero,
+                                                  mtx, parentMtx);
+            break;
+        case GRAPH_NODE_TYPE_SCALE:
+            vec3_same(scale, ((struct GraphNodeScale *) graphNode)->scale);
+            mtxf_scale_vec3f(mtx, parentMtx, scale);
+            break;
+        default:
+            mtxf_copy(mtx, parentMtx);
+            break;
+    }
+
+    if (graphNode->type != GRAPH_NODE_TYPE_START && graphNode->type != GRAPH_NODE_TYPE_DISPLAY_LIST) {
+        fixed = (*nextFixed)++;
+        mtxf_to_mtx(fixed, mtx);
+    }
+
+    if (graphNode->type != GRAPH_NODE_TYPE_START && ((struct GraphNodeDisplayList *) graphNode)->displayList != NULL) {
+        list = &staticList->lists[staticList->numLists++];
+        list->transform = fixed;
+        list->displayList = ((struct GraphNodeDisplayList *) graphNode)->displayList;
+        list->layer = GET_GRAPH_NODE_LAYER(graphNode->flags);
+        geo_measure_static_list(list, mtx);
+    }
+
+    if (child != NULL) {
+        do {
+            geo_flatten_static_node(staticList, child, mtx, fixed, nextFixed);
+        } while ((child = child->next) != graphNode->children);
+    }
+}
+
+/**
+ * Replaces 'numNodes' static sibling nodes starting at 'firstNode' with a GraphNodeStaticList
+ * that draws their flattened display lists. The replaced nodes become its children.
+ */
+static void geo_make_static_list(struct AllocOnlyPool *pool, struct GraphNode *firstNode, s32 numNodes) {
+    struct GraphNode *parent = firstNode->parent;
+    struct GraphNode *lastNode = firstNode;
+    struct GraphNode *node = firstNode;
+    struct GraphNodeStaticList *staticList;
+    Mtx *matrices = NULL;
+    s32 numLists = 0;
+    s32 numMatrices = 0;
+    Mat4 identity;
+    s32 i;
+
+    for (i = 0; i < numNodes; i++, node = node->next) {
+        geo_count_static_lists(node, &numLists, &numMatrices);
+        lastNode = node;
+    }
+    if (numLists == 0) {
+        return;
+    }
+
+    staticList = alloc_only_pool_alloc(pool, sizeof(struct GraphNodeStaticList));
+    if (staticList == NULL) {
+        return;
+    }
+    staticList->lists = alloc_only_pool_alloc(pool, numLists * sizeof(struct StaticDisplayList));
+    if (numMatrices != 0) {
+        // The pool is only 4 byte aligned, but the RSP loads matrices 8 bytes at a time
+        matrices = alloc_only_pool_alloc(pool, numMatrices * sizeof(Mtx) + 4);
+        if (matrices == NULL) {
+            return;
+        }
+        matrices = (Mtx *) ALIGN8((uintptr_t) matrices);
+    }
+    if (staticList->lists == NULL) {
+        return;
+    }
+
+    init_scene_graph_node_links(&staticList->node, GRAPH_NODE_TYPE_STATIC_LIST);
+    staticList->numLists = 0;
+    mtxf_identity(identity);
+
+    node = firstNode;
+    for (i = 0; i < numNodes; i++, node = node->next) {
+        geo_flatten_static_node(staticList, node, identity, NULL, &matrices);
+    }
+
+    // Put the static list where the nodes were and move them under it
+    staticList->node.parent = parent;
+    if (lastNode->next == firstNode) {
+        parent->children = &staticList->node;
+    } else {
+        staticList->node.prev = firstNode->prev;
+        staticList->node.next = lastNode->next;
+        firstNode->prev->next = &staticList->node;
+        lastNode->next->prev = &staticList->node;
+        if (parent->children == firstNode) {
+            parent->children = &staticList->node;
+        }
+    }
+
+    firstNode->prev = lastNode;
+    lastNode->next = firstNode;
+    staticList->node.children = firstNode;
+    node = firstNode;
+    do {
+        node->parent = &staticList->node;
+    } while ((node = node->next) != firstNode);
+}
+
+/**
+ * Flattens the runs of static nodes among the children of the given node, and looks for
+ * more in children that don't change the matrix stack.
+ */
+static void geo_flatten_static_children(struct AllocOnlyPool *pool, struct GraphNode *parent) {
+    struct GraphNode *node = parent->children;
+    struct GraphNode *next;
+    struct GraphNode *runStart = NULL;
+    s32 runLength = 0;
+    s32 numChildren = 0;
+    // A switch node picks its children by index, so each of them gets its own list
+    s32 separateChildren = (parent->type == GRAPH_NODE_TYPE_SWITCH_CASE);
+    s32 i;
+
+    if (node == NULL) {
+        return;
+    }
+    do {
+        numChildren++;
+    } while ((node = node->next) != parent->children);
+
+    node = parent->children;
+    for (i = 0; i < numChildren; i++, node = next) {
+        next = node->next;
+
+        if (geo_node_is_static(node)) {
+            if (runStart != NULL && separateChildren) {
+                geo_make_static_list(pool, runStart, runLength);
+                runStart = NULL;
+            }
+            if (runStart == NULL) {
+                runStart = node;
+                runLength = 0;
+            }
+            runLength++;
+            continue;
+        }
+
+        if (runStart != NULL) {
+            geo_make_static_list(pool, runStart, runLength);
+            runStart = NULL;
+        }
+
+        switch (node->type) {
+            case GRAPH_NODE_TYPE_ROOT:
+            case GRAPH_NODE_TYPE_ORTHO_PROJECTION:
+            case GRAPH_NODE_TYPE_PERSPECTIVE:
+            case GRAPH_NODE_TYPE_MASTER_LIST:
+            case GRAPH_NODE_TYPE_CAMERA:
+            case GRAPH_NODE_TYPE_START:
+            case GRAPH_NODE_TYPE_LEVEL_OF_DETAIL:
+            case GRAPH_NODE_TYPE_SWITCH_CASE:
+                geo_flatten_static_children(pool, node);
+                break;
+        }
+    }
+
+    if (runStart != NULL) {
+        geo_make_static_list(pool, runStart, runLength);
+    }
+}
+
+/**
+ * Called when an area is loaded. Flattens the parts of its scene graph that only draw display
+ * lists with fixed transformations (normally the level geometry) into GraphNodeStaticLists, so the
+ * renderer doesn't walk those nodes and rebuild their matrices every frame. Only nodes that no
+ * parent transforms are flattened, since their matrices don't depend on anything drawn before them.
+ */
+void geo_flatten_static_nodes(struct AllocOnlyPool *pool, struct GraphNode *graphNode) {
+    geo_flatten_static_children(pool, graphNode);
+}
+#endif
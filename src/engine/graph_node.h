@@ -65,6 +65,9 @@ enum GraphNodeTypes {
     GRAPH_NODE_TYPE_CULLING_RADIUS,
     GRAPH_NODE_TYPE_ROOT,
     GRAPH_NODE_TYPE_START,
+#ifdef STATIC_GEO_FLATTENING
+    GRAPH_NODE_TYPE_STATIC_LIST,
+#endif
 };
 
 // Passed as first argument to a GraphNodeFunc to give information about in
@@ -347,6 +350,30 @@ struct GraphNodeCullingRadius {
     // u8 filler[2];
 };
 
+#ifdef STATIC_GEO_FLATTENING
+/** A display list of a GraphNodeStaticList, with the matrix it is drawn with and a
+ *  bounding sphere in world space. A NULL transform means the parent's matrix is used,
+ *  a negative radius means the list is never culled.
+ */
+struct StaticDisplayList {
+    Mtx *transform;
+    void *displayList;
+    Vec3f center;
+    f32 radius;
+    s32 layer;
+};
+
+/** GraphNode made when an area loads out of a run of sibling nodes that only draw display
+ *  lists with fixed transformations, such as the level geometry. The original nodes become
+ *  its children but aren't processed, the renderer draws the flattened lists instead.
+ */
+struct GraphNodeStaticList {
+    /*0x00*/ struct GraphNode node;
+    /*0x14*/ s32 numLists;
+    /*0x18*/ struct StaticDisplayList *lists;
+};
+#endif
+
 extern struct GraphNodeMasterList  *gCurGraphNodeMasterList;
 extern struct GraphNodePerspective *gCurGraphNodeCamFrustum;
 extern struct GraphNodeCamera      *gCurGraphNodeCamera;
@@ -401,6 +428,9 @@ s32  geo_update_animation_frame(struct AnimInfo *obj, s32 *accelAssist);
 void geo_retreive_animation_translation(struct GraphNodeObject *obj, Vec3f position);
 
 struct GraphNodeRoot *geo_find_root(struct GraphNode *graphNode);
+#ifdef STATIC_GEO_FLATTENING
+void geo_flatten_static_nodes(struct AllocOnlyPool *pool, struct GraphNode *graphNode);
+#endif
 
 // graph_node_manager
 s16 *read_vec3s_to_vec3f(Vec3f dst, s16 *src);
@@ -410,6 +410,9 @@ static void level_cmd_begin_area(void) {
         sCurrAreaIndex = areaIndex;
         screenArea->areaIndex = areaIndex;
         gAreas[areaIndex].graphNode = screenArea;
+#ifdef STATIC_GEO_FLATTENING
+        geo_flatten_static_nodes(sLevelPool, &screenArea->node);
+#endif
 
         if (node != NULL) {
             gAreas[areaIndex].camera = (struct Camera *) node->config.camera;
@@ -916,21 +916,28 @@ void find_surface_on_ray_list(struct SurfaceNode *list, Vec3f orig, Vec3f dir, f
     profiler_collision_update(first);
 }
 
-void find_surface_on_ray_cell(s32 cellX, s32 cellZ, Vec3f orig, Vec3f normalized_dir, f32 dir_length, struct Surface **hit_surface, Vec3f hit_pos, f32 *max_length, s32 flags) {
+// The list of a cell a ray walks, the collision probe's one if the whole ray is inside it
+#ifdef COLLISION_PROBE
+#define RAY_CELL_LIST(partition, dynamic) collision_probe_get_cell_list(useProbe, cellX, cellZ, partition, dynamic)
+#else
+#define RAY_CELL_LIST(partition, dynamic) ((dynamic) ? gDynamicSurfacePartition : gStaticSurfacePartition)[cellZ][cellX][partition]
+#endif
+
+void find_surface_on_ray_cell(s32 cellX, s32 cellZ, Vec3f orig, Vec3f normalized_dir, f32 dir_length, struct Surface **hit_surface, Vec3f hit_pos, f32 *max_length, s32 flags, UNUSED s32 useProbe) {
     // Skip if OOB
     if ((cellX >= 0) && (cellX <= (NUM_CELLS - 1)) && (cellZ >= 0) && (cellZ <= (NUM_CELLS - 1))) {
         // Iterate through each surface in this partition
         if ((normalized_dir[1] > -NEAR_ONE) && (flags & RAYCAST_FIND_CEIL)) {
-            find_surface_on_ray_list( gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
-            find_surface_on_ray_list(gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
+            find_surface_on_ray_list(RAY_CELL_LIST(SPATIAL_PARTITION_CEILS,  FALSE), orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
+            find_surface_on_ray_list(RAY_CELL_LIST(SPATIAL_PARTITION_CEILS,  TRUE ), orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
         }
         if ((normalized_dir[1] <  NEAR_ONE) && (flags & RAYCAST_FIND_FLOOR)) {
-            find_surface_on_ray_list( gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
-            find_surface_on_ray_list(gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
+            find_surface_on_ray_list(RAY_CELL_LIST(SPATIAL_PARTITION_FLOORS, FALSE), orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
+            find_surface_on_ray_list(RAY_CELL_LIST(SPATIAL_PARTITION_FLOORS, TRUE ), orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
         }
         if (flags & RAYCAST_FIND_WALL) {
-            find_surface_on_ray_list( gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
-            find_surface_on_ray_list(gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
+            find_surface_on_ray_list(RAY_CELL_LIST(SPATIAL_PARTITION_WALLS,  FALSE), orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
+            find_surface_on_ray_list(RAY_CELL_LIST(SPATIAL_PARTITION_WALLS,  TRUE ), orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
         }
         if (flags & RAYCAST_FIND_WATER) {
             find_surface_on_ray_list( gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ], orig, normalized_dir, dir_length, hit_surface, hit_pos, max_length);
@@ -959,10 +966,18 @@ f32 find_surface_on_ray(Vec3f orig, Vec3f dir, struct Surface **hit_surface, Vec
     f32 start_cell_coord_z = (orig[2] + LEVEL_BOUNDARY_MAX) * invcell;
     f32 end_cell_coord_x   = (orig[0] + dir[0] + LEVEL_BOUNDARY_MAX) * invcell;
     f32 end_cell_coord_z   = (orig[2] + dir[2] + LEVEL_BOUNDARY_MAX) * invcell;
+#ifdef COLLISION_PROBE
+    s32 useProbe = collision_probe_has_ray(orig, dir);
+#else
+    s32 useProbe = FALSE;
+#endif
 
     // Don't do grid traversal if straight down
     if ((normalized_dir[1] >= NEAR_ONE) || (normalized_dir[1] <= -NEAR_ONE)) {
-        find_surface_on_ray_cell((s32)start_cell_coord_x, (s32)start_cell_coord_z, orig, normalized_dir, dir_length, hit_surface, hit_pos, &max_length, flags);
+        find_surface_on_ray_cell((s32)start_cell_coord_x, (s32)start_cell_coord_z, orig, normalized_dir, dir_length, hit_surface, hit_pos, &max_length, flags, useProbe);
+#ifdef COLLISION_TRACE
+        collision_trace_record(COL_TRACE_RAY, flags, orig, dir, max_length, *hit_surface);
+#endif
         return max_length;
     }
 
@@ -982,7 +997,7 @@ f32 find_surface_on_ray(Vec3f orig, Vec3f dir, struct Surface **hit_surface, Vec
     f32 t_max_z = ABS((p_z + MAX(stp_z, 0.0f) - start_cell_coord_z) * rdinv_z);
 
     while (TRUE) {
-        find_surface_on_ray_cell((s32)p_x, (s32)p_z, orig, normalized_dir, dir_length, hit_surface, hit_pos, &max_length, flags);
+        find_surface_on_ray_cell((s32)p_x, (s32)p_z, orig, normalized_dir, dir_length, hit_surface, hit_pos, &max_length, flags, useProbe);
         f32 t_next = MIN(t_max_x, t_max_z);
         if (t_next > 1.0f) {
             break;
@@ -997,6 +1012,9 @@ f32 find_surface_on_ray(Vec3f orig, Vec3f dir, struct Surface **hit_surface, Vec
             p_z += stp_z;
         }
     }
+#ifdef COLLISION_TRACE
+    collision_trace_record(COL_TRACE_RAY, flags, orig, dir, max_length, *hit_surface);
+#endif
     return max_length;
 }
 
@@ -1078,3 +1096,15 @@ OPTIMIZE_OS void mtxf_to_mtx_fast(s16* dst, float* src) {
     //  to set the top half.
     dst[15] = 1;
 }
+
+// Converts only the translation row of a floating point matrix to fixed point.
+// The rest of dst has to already hold the fixed point rotation and scale of src.
+OPTIMIZE_OS void mtxf_to_mtx_translation_fast(s16* dst, float* src) {
+    float scale = construct_float(65536.0f / WORLD_SCALE);
+
+    for (int i = 12; i < 15; i++) {
+        s32 a_int = (s32)(src[i] * scale);
+        dst[i +  0] = (s16)(a_int >> 16);
+        dst[i + 16] = (s16)(a_int >>  0);
+    }
+}
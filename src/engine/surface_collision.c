@@ -9,6 +9,294 @@
 #include "surface_collision.h"
 #include "surface_load.h"
 #include "game/puppyprint.h"
+#ifdef COLLISION_TRACE
+#include "game/game_init.h"
+#ifdef UNF
+#include "usb/usb.h"
+#endif
+#endif
+
+/**************************************************
+ *                 COLLISION PROBE                *
+ **************************************************/
+
+#ifdef COLLISION_PROBE
+/**
+ * The surfaces near a moving object, gathered once so that the queries of all its steps walk short,
+ * contiguous lists instead of the full partition lists. Surfaces are only left out where every query
+ * inside the probe's box would skip them anyway, and each list keeps the order of its partition list,
+ * so the queries return exactly what they would without the probe.
+ */
+struct CollisionProbe {
+    /// Whether the gathered lists are complete, see collision_probe_gather
+    u8 active;
+    /// Only gather static surfaces and read dynamic ones from the partitions, for probes kept across frames
+    u8 staticOnly;
+    /// Whether a box was gathered at all, whether or not it fit, for probes kept across frames
+    u8 gathered;
+    s32 minCellX, minCellZ;
+    s32 maxCellX, maxCellZ;
+    /// Floor and ceiling queries have to be within this x and z range
+    s32 minX, maxX;
+    s32 minZ, maxZ;
+    /// Floor queries have to be at or below floorMaxY, ceiling queries at or above ceilMinY
+    s32 floorMaxY;
+    s32 ceilMinY;
+    /// The range of heights walls are tested at
+    f32 wallMinY, wallMaxY;
+    /// The gathered dynamic and static lists of each cell for floors, ceilings and walls
+    struct SurfaceNode *(*lists)[SPATIAL_PARTITION_WATER][2];
+    struct SurfaceNode *nodes;
+    s32 maxCells;
+    s32 maxNodes;
+    s32 numNodes;
+    /// gStaticSurfaceLoads when the static lists were gathered
+    u32 staticLoads;
+};
+
+static struct SurfaceNode *sStepProbeLists[COLLISION_PROBE_MAX_CELLS][SPATIAL_PARTITION_WATER][2];
+static struct SurfaceNode sStepProbeNodes[COLLISION_PROBE_MAX_SURFACES];
+static struct CollisionProbe sStepProbe = {
+    .lists = sStepProbeLists,
+    .nodes = sStepProbeNodes,
+    .maxCells = COLLISION_PROBE_MAX_CELLS,
+    .maxNodes = COLLISION_PROBE_MAX_SURFACES,
+};
+
+#ifdef COLLISION_PROBE_CAMERA
+static struct SurfaceNode *sCameraProbeLists[COLLISION_PROBE_CAMERA_MAX_CELLS][SPATIAL_PARTITION_WATER][2];
+static struct SurfaceNode sCameraProbeNodes[COLLISION_PROBE_CAMERA_MAX_SURFACES];
+static struct CollisionProbe sCameraProbe = {
+    .staticOnly = TRUE,
+    .lists = sCameraProbeLists,
+    .nodes = sCameraProbeNodes,
+    .maxCells = COLLISION_PROBE_CAMERA_MAX_CELLS,
+    .maxNodes = COLLISION_PROBE_CAMERA_MAX_SURFACES,
+};
+#endif
+
+/// The probe queries currently use, or NULL
+static struct CollisionProbe *sActiveProbe = NULL;
+
+/**
+ * Whether the surface can be hit by a floor or ceiling query inside the probe's x and z range.
+ */
+static s32 collision_probe_overlaps_xz(struct CollisionProbe *probe, struct Surface *surf) {
+    if (MAX(MAX(surf->vertex1[0], surf->vertex2[0]), surf->vertex3[0]) < probe->minX) return FALSE;
+    if (MIN(MIN(surf->vertex1[0], surf->vertex2[0]), surf->vertex3[0]) > probe->maxX) return FALSE;
+    if (MAX(MAX(surf->vertex1[2], surf->vertex2[2]), surf->vertex3[2]) < probe->minZ) return FALSE;
+    if (MIN(MIN(surf->vertex1[2], surf->vertex2[2]), surf->vertex3[2]) > probe->maxZ) return FALSE;
+    return TRUE;
+}
+
+/**
+ * Copy the surfaces of a partition list that a query inside the probe could hit. Returns the head of
+ * the copy, or sets the probe inactive if it ran out of nodes.
+ */
+static struct SurfaceNode *collision_probe_gather_list(struct CollisionProbe *probe, struct SurfaceNode *list, s32 partition) {
+    struct SurfaceNode *head = NULL;
+    struct SurfaceNode *tail = NULL;
+    struct Surface *surf;
+
+    for (; list != NULL; list = list->next) {
+        surf = list->surface;
+
+        // The same early outs as the queries, for the whole box
+        if (partition == SPATIAL_PARTITION_FLOORS) {
+            if (probe->floorMaxY + FIND_FLOOR_BUFFER < surf->lowerY) continue;
+            if (!collision_probe_overlaps_xz(probe, surf)) continue;
+        } else if (partition == SPATIAL_PARTITION_CEILS) {
+            if (probe->ceilMinY > surf->upperY) continue;
+            if (!collision_probe_overlaps_xz(probe, surf)) continue;
+        } else {
+            // Walls push the position around while they're tested, so only their height is checked.
+            if (probe->wallMaxY < surf->lowerY || probe->wallMinY > surf->upperY) continue;
+        }
+
+        if (probe->numNodes >= probe->maxNodes) {
+            probe->active = FALSE;
+            return NULL;
+        }
+
+        struct SurfaceNode *node = &probe->nodes[probe->numNodes++];
+        node->surface = surf;
+        node->next = NULL;
+        if (tail != NULL) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+    }
+
+    return head;
+}
+
+/**
+ * Gather the floors, ceilings and walls that floor and ceiling queries at positions in [min, max] and
+ * wall queries tested at heights in [min[1], max[1]] could hit into the probe. Returns whether the
+ * probe is usable, it isn't if the box covers too many cells or the surfaces didn't fit.
+ */
+static s32 collision_probe_gather(struct CollisionProbe *probe, Vec3f min, Vec3f max) {
+    const s32 bound = LEVEL_BOUNDARY_MAX - 1;
+
+    probe->active = FALSE;
+    probe->numNodes = 0;
+
+    probe->minX = CLAMP((s32) min[0], -bound, bound);
+    probe->maxX = CLAMP((s32) max[0], -bound, bound);
+    probe->minZ = CLAMP((s32) min[2], -bound, bound);
+    probe->maxZ = CLAMP((s32) max[2], -bound, bound);
+    probe->floorMaxY = max[1];
+    probe->ceilMinY = min[1];
+    probe->wallMinY = min[1];
+    probe->wallMaxY = max[1];
+
+    probe->minCellX = GET_CELL_COORD(probe->minX);
+    probe->maxCellX = GET_CELL_COORD(probe->maxX);
+    probe->minCellZ = GET_CELL_COORD(probe->minZ);
+    probe->maxCellZ = GET_CELL_COORD(probe->maxZ);
+
+    if ((probe->maxCellX - probe->minCellX + 1) * (probe->maxCellZ - probe->minCellZ + 1) > probe->maxCells) {
+        return FALSE;
+    }
+
+    probe->active = TRUE;
+
+    s32 cell = 0;
+    for (s32 cellX = probe->minCellX; cellX <= probe->maxCellX; cellX++) {
+        for (s32 cellZ = probe->minCellZ; cellZ <= probe->maxCellZ; cellZ++) {
+            for (s32 partition = 0; partition < SPATIAL_PARTITION_WATER; partition++) {
+                if (!probe->staticOnly) {
+                    probe->lists[cell][partition][TRUE] =
+                        collision_probe_gather_list(probe, gDynamicSurfacePartition[cellZ][cellX][partition], partition);
+                }
+                probe->lists[cell][partition][FALSE] =
+                    collision_probe_gather_list(probe, gStaticSurfacePartition[cellZ][cellX][partition], partition);
+            }
+            cell++;
+        }
+    }
+
+    return probe->active;
+}
+
+/**
+ * Gather the surfaces in [min, max] for the steps of a moving object, see collision_probe_gather.
+ * Until collision_probe_end, queries that fit in the box walk the gathered lists, anything else falls
+ * back to the partitions.
+ *
+ * Only use this while surfaces can't change, like within a single step of Mario.
+ */
+void collision_probe_begin(Vec3f min, Vec3f max) {
+    collision_probe_gather(&sStepProbe, min, max);
+    sActiveProbe = &sStepProbe;
+}
+
+#ifdef COLLISION_PROBE_CAMERA
+/**
+ * Like collision_probe_begin, for the queries of one camera update. The camera only gathers static
+ * surfaces and keeps them across frames: while [min, max] stays inside the box gathered on an earlier
+ * frame and no static surfaces were loaded since, the lists are used as they are. Otherwise they're
+ * gathered again for a box grown by COLLISION_PROBE_CAMERA_SLACK, so that a smoothly moving camera can
+ * keep them for a while. Dynamic surfaces are always read from the partitions.
+ * If the grown box doesn't fit, the queries use the partitions until the camera leaves that box, rather
+ * than gathering again every frame.
+ */
+void collision_probe_camera_begin(Vec3f min, Vec3f max) {
+    PUPPYPRINT_GET_SNAPSHOT();
+    struct CollisionProbe *probe = &sCameraProbe;
+    Vec3f gatherMin, gatherMax;
+
+    if (!probe->gathered || probe->staticLoads != gStaticSurfaceLoads
+        || min[0] < probe->minX || max[0] > probe->maxX
+        || min[2] < probe->minZ || max[2] > probe->maxZ
+        || min[1] < probe->ceilMinY || max[1] > probe->floorMaxY) {
+        for (s32 i = 0; i < 3; i++) {
+            gatherMin[i] = min[i] - COLLISION_PROBE_CAMERA_SLACK;
+            gatherMax[i] = max[i] + COLLISION_PROBE_CAMERA_SLACK;
+        }
+        collision_probe_gather(probe, gatherMin, gatherMax);
+        probe->gathered = TRUE;
+        probe->staticLoads = gStaticSurfaceLoads;
+    }
+
+    sActiveProbe = probe;
+    profiler_collision_update(first);
+}
+#endif
+
+/**
+ * Stop using the gathered lists.
+ */
+void collision_probe_end(void) {
+    sActiveProbe = NULL;
+}
+
+/**
+ * Whether the active probe has the lists of every cell from (minCellX, minCellZ) to (maxCellX, maxCellZ).
+ */
+static s32 collision_probe_has_cells(s32 minCellX, s32 minCellZ, s32 maxCellX, s32 maxCellZ) {
+    struct CollisionProbe *probe = sActiveProbe;
+
+    return probe != NULL && probe->active
+        && minCellX >= probe->minCellX && maxCellX <= probe->maxCellX
+        && minCellZ >= probe->minCellZ && maxCellZ <= probe->maxCellZ;
+}
+
+/**
+ * Whether a floor or ceiling query at x, z can use the active probe.
+ */
+static s32 collision_probe_has_point(s32 x, s32 z) {
+    struct CollisionProbe *probe = sActiveProbe;
+
+    return probe != NULL && probe->active
+        && x >= probe->minX && x <= probe->maxX
+        && z >= probe->minZ && z <= probe->maxZ;
+}
+
+/**
+ * The gathered list of a cell inside the active probe.
+ */
+static struct SurfaceNode *collision_probe_get_list(s32 cellX, s32 cellZ, s32 partition, s32 dynamic) {
+    struct CollisionProbe *probe = sActiveProbe;
+    s32 cell = (cellX - probe->minCellX) * (probe->maxCellZ - probe->minCellZ + 1) + (cellZ - probe->minCellZ);
+
+    if (dynamic && probe->staticOnly) {
+        return gDynamicSurfacePartition[cellZ][cellX][partition];
+    }
+    return probe->lists[cell][partition][dynamic];
+}
+
+/**
+ * Whether a ray from 'orig' along 'dir' stays inside the active probe's box. Anything such a ray can
+ * hit was gathered, so it can walk the gathered lists with collision_probe_get_cell_list.
+ */
+s32 collision_probe_has_ray(Vec3f orig, Vec3f dir) {
+    struct CollisionProbe *probe = sActiveProbe;
+    Vec3f end;
+
+    if (probe == NULL || !probe->active) {
+        return FALSE;
+    }
+    vec3f_sum(end, orig, dir);
+
+    return MIN(orig[0], end[0]) >= probe->minX && MAX(orig[0], end[0]) <= probe->maxX
+        && MIN(orig[2], end[2]) >= probe->minZ && MAX(orig[2], end[2]) <= probe->maxZ
+        && MIN(orig[1], end[1]) >= probe->ceilMinY && MAX(orig[1], end[1]) <= probe->floorMaxY;
+}
+
+/**
+ * The list of a cell to walk: the active probe's gathered list if 'useProbe' is set and the probe has
+ * it, the partition list otherwise. Water isn't gathered.
+ */
+struct SurfaceNode *collision_probe_get_cell_list(s32 useProbe, s32 cellX, s32 cellZ, s32 partition, s32 dynamic) {
+    if (useProbe && partition < SPATIAL_PARTITION_WATER && collision_probe_has_cells(cellX, cellZ, cellX, cellZ)) {
+        return collision_probe_get_list(cellX, cellZ, partition, dynamic);
+    }
+    return dynamic ? gDynamicSurfacePartition[cellZ][cellX][partition] : gStaticSurfacePartition[cellZ][cellX][partition];
+}
+#endif
 
 /**************************************************
  *                      WALLS                     *
@@ -50,7 +338,7 @@ s32 check_wall_edge(Vec3f vert, Vec3f v2, f32 *d00, f32 *d01, f32 *invDenom, f32
  * Iterate through the list of walls until all walls are checked and
  * have given their wall push.
  */
-static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struct WallCollisionData *data) {
+static s32 find_wall_collisions_from_list(const struct CollisionQuery *query, struct SurfaceNode *surfaceNode, struct WallCollisionData *data) {
     const f32 corner_threshold = -0.9f;
     struct Surface *surf;
     f32 offset;
@@ -74,8 +362,10 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
         // Exclude a large number of walls immediately to optimize.
         if (pos[1] < surf->lowerY || pos[1] > surf->upperY) continue;
 
+        if (query->ignoreObject != NULL && surf->object == query->ignoreObject) continue;
+
         // Determine if checking for the camera or not.
-        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+        if (query->flags & COLLISION_FLAG_CAMERA) {
             if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) continue;
         } else {
             // Ignore camera only surfaces.
@@ -158,7 +448,7 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
         }
         numCols++;
 
-        if (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST) {
+        if (query->flags & COLLISION_FLAG_RETURN_FIRST) {
             break;
         }
     }
@@ -193,19 +483,36 @@ s32 f32_find_wall_collision(f32 *xPtr, f32 *yPtr, f32 *zPtr, f32 offsetY, f32 ra
 }
 
 /**
- * Find wall collisions and receive their push.
+ * Find wall collisions and receive their push, with the flags in gCollisionFlags.
  */
 s32 find_wall_collisions(struct WallCollisionData *colData) {
+    struct CollisionQuery query = { .flags = gCollisionFlags, .ignoreObject = NULL };
+
+    // To prevent accidentally leaving the floor tangible, stop checking for it.
+    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
+
+    return find_wall_collisions_query(&query, colData);
+}
+
+/**
+ * Find wall collisions and receive their push.
+ */
+s32 find_wall_collisions_query(const struct CollisionQuery *query, struct WallCollisionData *colData) {
     struct SurfaceNode *node;
     s32 numCollisions = 0;
     s32 x = colData->x;
     s32 z = colData->z;
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_wall);
     PUPPYPRINT_GET_SNAPSHOT();
+    COLLISION_TRACE_GET_QUERY_FLAGS(query);
+#ifdef COLLISION_TRACE
+    Vec3f tracePos = { colData->x, colData->y, colData->z };
+#endif
 
     colData->numWalls = 0;
 
     if (is_outside_level_bounds(x, z)) {
+        COLLISION_TRACE_RECORD(COL_TRACE_WALL, tracePos, ((Vec3f){ colData->offsetY, colData->radius, 0.0f }), 0, NULL);
         profiler_collision_update(first);
         return numCollisions;
     }
@@ -216,26 +523,39 @@ s32 find_wall_collisions(struct WallCollisionData *colData) {
     s32 maxCellX = GET_CELL_COORD(x + colData->radius);
     s32 maxCellZ = GET_CELL_COORD(z + colData->radius);
 
+#ifdef COLLISION_PROBE
+    f32 wallY = colData->y + colData->offsetY;
+    s32 useProbe = collision_probe_has_cells(minCellX, minCellZ, maxCellX, maxCellZ)
+                   && wallY >= sActiveProbe->wallMinY && wallY <= sActiveProbe->wallMaxY;
+#endif
+
     for (s32 cellX = minCellX; cellX <= maxCellX; cellX++) {
         for (s32 cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
-            if (!(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC)) {
+            if (!(query->flags & COLLISION_FLAG_EXCLUDE_DYNAMIC)) {
                 // Check for surfaces belonging to objects.
                 node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS];
-                numCollisions += find_wall_collisions_from_list(node, colData);
+#ifdef COLLISION_PROBE
+                if (useProbe) node = collision_probe_get_list(cellX, cellZ, SPATIAL_PARTITION_WALLS, TRUE);
+#endif
+                numCollisions += find_wall_collisions_from_list(query, node, colData);
             }
 
             // Check for surfaces that are a part of level geometry.
             node = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS];
-            numCollisions += find_wall_collisions_from_list(node, colData);
+#ifdef COLLISION_PROBE
+            if (useProbe) node = collision_probe_get_list(cellX, cellZ, SPATIAL_PARTITION_WALLS, FALSE);
+#endif
+            numCollisions += find_wall_collisions_from_list(query, node, colData);
         }
     }
 
-    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
 #ifdef VANILLA_DEBUG
     // Increment the debug tracker.
     gNumCalls.wall++;
 #endif
 
+    COLLISION_TRACE_RECORD(COL_TRACE_WALL, tracePos, ((Vec3f){ colData->offsetY, colData->radius, 0.0f }), numCollisions,
+                           ((colData->numWalls > 0) ? colData->walls[0] : NULL));
     profiler_collision_update(first);
     return numCollisions;
 }
@@ -295,32 +615,36 @@ static s32 check_within_ceil_triangle_bounds(s32 x, s32 z, struct Surface *surf,
     return TRUE;
 }
 
+/**
+ * Whether a ceiling query skips a ceiling wherever it is.
+ */
+static ALWAYS_INLINE s32 ceil_query_skips_surface(const struct CollisionQuery *query, struct Surface *surf) {
+    if (query->ignoreObject != NULL && surf->object == query->ignoreObject) return TRUE;
+
+    // Determine if checking for the camera or not
+    if (query->flags & COLLISION_FLAG_CAMERA) {
+        return (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION);
+    }
+    // Ignore camera only surfaces
+    return (surf->type == SURFACE_CAMERA_BOUNDARY);
+}
+
 /**
  * Iterate through the list of ceilings and find the first ceiling over a given point.
  */
-static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+static struct Surface *find_ceil_from_list(const struct CollisionQuery *query, struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
     register struct Surface *surf, *ceil = NULL;
     register f32 height;
-    SurfaceType type = SURFACE_DEFAULT;
     *pheight = CELL_HEIGHT_LIMIT;
     // Stay in this loop until out of ceilings.
     while (surfaceNode != NULL) {
         surf = surfaceNode->surface;
         surfaceNode = surfaceNode->next;
-        type = surf->type;
 
         // Exclude all ceilings below the point
         if (y > surf->upperY) continue;
 
-        // Determine if checking for the camera or not
-        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
-            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) {
-                continue;
-            }
-        } else if (type == SURFACE_CAMERA_BOUNDARY) {
-            // Ignore camera only surfaces
-            continue;
-        }
+        if (ceil_query_skips_surface(query, surf)) continue;
 
         // Check that the point is within the triangle bounds
         if (!check_within_ceil_triangle_bounds(x, z, surf, 1.5f)) continue;
@@ -341,25 +665,39 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
 
         // Exit the loop if it's not possible for another ceiling to be closer
         // to the original point, or if COLLISION_FLAG_RETURN_FIRST.
-        if (height == y || (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST)) break;
+        if (height == y || (query->flags & COLLISION_FLAG_RETURN_FIRST)) break;
     }
     return ceil;
 }
 
 /**
- * Find the lowest ceiling above a given position and return the height.
+ * Find the lowest ceiling above a given position and return the height, with the flags in gCollisionFlags.
  */
 f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
+    struct CollisionQuery query = { .flags = gCollisionFlags, .ignoreObject = NULL };
+
+    // To prevent accidentally leaving the floor tangible, stop checking for it.
+    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
+
+    return find_ceil_query(&query, posX, posY, posZ, pceil);
+}
+
+/**
+ * Find the lowest ceiling above a given position and return the height.
+ */
+f32 find_ceil_query(const struct CollisionQuery *query, f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
     f32 height        = CELL_HEIGHT_LIMIT;
     f32 dynamicHeight = CELL_HEIGHT_LIMIT;
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_ceil);
     PUPPYPRINT_GET_SNAPSHOT();
+    COLLISION_TRACE_GET_QUERY_FLAGS(query);
     s32 x = posX;
     s32 y = posY;
     s32 z = posZ;
     *pceil = NULL;
 
     if (is_outside_level_bounds(x, z)) {
+        COLLISION_TRACE_RECORD(COL_TRACE_CEIL, ((Vec3f){ posX, posY, posZ }), gVec3fZero, height, NULL);
         profiler_collision_update(first);
         return height;
     }
@@ -372,12 +710,18 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
     struct Surface *ceil = NULL;
     struct Surface *dynamicCeil = NULL;
 
-    s32 includeDynamic = !(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+    s32 includeDynamic = !(query->flags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+#ifdef COLLISION_PROBE
+    s32 useProbe = collision_probe_has_point(x, z) && y >= sActiveProbe->ceilMinY;
+#endif
 
     if (includeDynamic) {
         // Check for surfaces belonging to objects.
         surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS];
-        dynamicCeil = find_ceil_from_list(surfaceList, x, y, z, &dynamicHeight);
+#ifdef COLLISION_PROBE
+        if (useProbe) surfaceList = collision_probe_get_list(cellX, cellZ, SPATIAL_PARTITION_CEILS, TRUE);
+#endif
+        dynamicCeil = find_ceil_from_list(query, surfaceList, x, y, z, &dynamicHeight);
 
         // In the next check, only check for ceilings lower than the previous check.
         height = dynamicHeight;
@@ -385,7 +729,10 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
 
     // Check for surfaces that are a part of level geometry.
     surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS];
-    ceil = find_ceil_from_list(surfaceList, x, y, z, &height);
+#ifdef COLLISION_PROBE
+    if (useProbe) surfaceList = collision_probe_get_list(cellX, cellZ, SPATIAL_PARTITION_CEILS, FALSE);
+#endif
+    ceil = find_ceil_from_list(query, surfaceList, x, y, z, &height);
 
     // Use the lower ceiling.
     if (includeDynamic && height >= dynamicHeight) {
@@ -393,9 +740,6 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
         height = dynamicHeight;
     }
 
-    // To prevent accidentally leaving the floor tangible, stop checking for it.
-    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
-
     // Return the ceiling.
     *pceil = ceil;
 #ifdef VANILLA_DEBUG
@@ -403,6 +747,7 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
     gNumCalls.ceil++;
 #endif
 
+    COLLISION_TRACE_RECORD(COL_TRACE_CEIL, ((Vec3f){ posX, posY, posZ }), gVec3fZero, height, ceil);
     profiler_collision_update(first);
     return height;
 }
@@ -411,7 +756,7 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
  *                     FLOORS                     *
  **************************************************/
 
-static s32 check_within_floor_triangle_bounds(s32 x, s32 z, struct Surface *surf) {
+s32 check_within_floor_triangle_bounds(s32 x, s32 z, struct Surface *surf) {
     Vec3i vx, vz;
     vx[0] = surf->vertex1[0];
     vz[0] = surf->vertex1[2];
@@ -428,12 +773,32 @@ static s32 check_within_floor_triangle_bounds(s32 x, s32 z, struct Surface *surf
     return TRUE;
 }
 
+/**
+ * Whether a floor query skips a floor wherever it is.
+ */
+static ALWAYS_INLINE s32 floor_query_skips_surface(const struct CollisionQuery *query, struct Surface *surf) {
+    if (query->ignoreObject != NULL && surf->object == query->ignoreObject) return TRUE;
+
+    // To prevent the Merry-Go-Round room from loading when Mario passes above the hole that leads
+    // there, SURFACE_INTANGIBLE is used. This prevent the wrong room from loading, but can also allow
+    // Mario to pass through.
+    if (!(query->flags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && (surf->type == SURFACE_INTANGIBLE)) {
+        return TRUE;
+    }
+
+    // Determine if we are checking for the camera or not.
+    if (query->flags & COLLISION_FLAG_CAMERA) {
+        return (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION);
+    }
+    // If we are not checking for the camera, ignore camera only floors.
+    return (surf->type == SURFACE_CAMERA_BOUNDARY);
+}
+
 /**
  * Iterate through the list of floors and find the first floor under a given point.
  */
-static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+static struct Surface *find_floor_from_list(const struct CollisionQuery *query, struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
     register struct Surface *surf, *floor = NULL;
-    register SurfaceType type = SURFACE_DEFAULT;
     register f32 height;
     register s32 bufferY = y + FIND_FLOOR_BUFFER;
 
@@ -441,23 +806,8 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
     while (surfaceNode != NULL) {
         surf = surfaceNode->surface;
         surfaceNode = surfaceNode->next;
-        type        = surf->type;
 
-        // To prevent the Merry-Go-Round room from loading when Mario passes above the hole that leads
-        // there, SURFACE_INTANGIBLE is used. This prevent the wrong room from loading, but can also allow
-        // Mario to pass through.
-        if (!(gCollisionFlags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && (type == SURFACE_INTANGIBLE)) {
-            continue;
-        }
-
-        // Determine if we are checking for the camera or not.
-        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
-            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) {
-                continue;
-            }
-        } else if (type == SURFACE_CAMERA_BOUNDARY) {
-            continue; // If we are not checking for the camera, ignore camera only floors.
-        }
+        if (floor_query_skips_surface(query, surf)) continue;
 
         // Exclude all floors above the point.
         if (bufferY < surf->lowerY) continue;
@@ -479,7 +829,7 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
 
         // Exit the loop if it's not possible for another floor to be closer
         // to the original point, or if COLLISION_FLAG_RETURN_FIRST.
-        if ((height == bufferY) || (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST)) break;
+        if ((height == bufferY) || (query->flags & COLLISION_FLAG_RETURN_FIRST)) break;
     }
     return floor;
 }
@@ -574,18 +924,32 @@ f32 unused_find_dynamic_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfl
     s32 cellZ = GET_CELL_COORD(z);
 
     struct SurfaceNode *surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS];
+    struct CollisionQuery query = { .flags = gCollisionFlags, .ignoreObject = NULL };
 
-    *pfloor = find_floor_from_list(surfaceList, x, y, z, &floorHeight);
+    *pfloor = find_floor_from_list(&query, surfaceList, x, y, z, &floorHeight);
 
     return floorHeight;
 }
 
 /**
- * Find the highest floor under a given position and return the height.
+ * Find the highest floor under a given position and return the height, with the flags in gCollisionFlags.
  */
 f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
+    struct CollisionQuery query = { .flags = gCollisionFlags, .ignoreObject = NULL };
+
+    // To prevent accidentally leaving the floor tangible, stop checking for it.
+    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
+
+    return find_floor_query(&query, xPos, yPos, zPos, pfloor);
+}
+
+/**
+ * Find the highest floor under a given position and return the height.
+ */
+f32 find_floor_query(const struct CollisionQuery *query, f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_floor);
     PUPPYPRINT_GET_SNAPSHOT();
+    COLLISION_TRACE_GET_QUERY_FLAGS(query);
 
     f32 height        = FLOOR_LOWER_LIMIT;
     f32 dynamicHeight = FLOOR_LOWER_LIMIT;
@@ -600,6 +964,7 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     *pfloor = NULL;
 
     if (is_outside_level_bounds(x, z)) {
+        COLLISION_TRACE_RECORD(COL_TRACE_FLOOR, ((Vec3f){ xPos, yPos, zPos }), gVec3fZero, height, NULL);
         profiler_collision_update(first);
         return height;
     }
@@ -611,12 +976,18 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     struct Surface *floor = NULL;
     struct Surface *dynamicFloor = NULL;
 
-    s32 includeDynamic = !(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+    s32 includeDynamic = !(query->flags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+#ifdef COLLISION_PROBE
+    s32 useProbe = collision_probe_has_point(x, z) && y <= sActiveProbe->floorMaxY;
+#endif
 
     if (includeDynamic) {
         // Check for surfaces belonging to objects.
         surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS];
-        dynamicFloor = find_floor_from_list(surfaceList, x, y, z, &dynamicHeight);
+#ifdef COLLISION_PROBE
+        if (useProbe) surfaceList = collision_probe_get_list(cellX, cellZ, SPATIAL_PARTITION_FLOORS, TRUE);
+#endif
+        dynamicFloor = find_floor_from_list(query, surfaceList, x, y, z, &dynamicHeight);
 
         // In the next check, only check for floors higher than the previous check.
         height = dynamicHeight;
@@ -624,16 +995,16 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
 
     // Check for surfaces that are a part of level geometry.
     surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS];
-    floor = find_floor_from_list(surfaceList, x, y, z, &height);
+#ifdef COLLISION_PROBE
+    if (useProbe) surfaceList = collision_probe_get_list(cellX, cellZ, SPATIAL_PARTITION_FLOORS, FALSE);
+#endif
+    floor = find_floor_from_list(query, surfaceList, x, y, z, &height);
 
     // Use the higher floor.
     if (includeDynamic && height <= dynamicHeight) {
         floor  = dynamicFloor;
         height = dynamicHeight;
     }
-
-    // To prevent accidentally leaving the floor tangible, stop checking for it.
-    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
     // If a floor was missed, increment the debug counter.
     if (floor == NULL) {
         gNumFindFloorMisses++;
@@ -646,6 +1017,7 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     gNumCalls.floor++;
 #endif
 
+    COLLISION_TRACE_RECORD(COL_TRACE_FLOOR, ((Vec3f){ xPos, yPos, zPos }), gVec3fZero, height, floor);
     profiler_collision_update(first);
     return height;
 }
@@ -705,6 +1077,285 @@ f32 find_water_floor(s32 xPos, s32 yPos, s32 zPos, struct Surface **pfloor) {
     return height;
 }
 
+/**************************************************
+ *                     BATCHES                    *
+ **************************************************/
+
+// How many positions a batch handles at once, the rest are done in further rounds.
+#define COLLISION_BATCH_SIZE 32
+
+// The cell key of positions outside of the level bounds, sorted after every cell.
+#define COLLISION_BATCH_OUT_OF_BOUNDS 0xFFFF
+
+/**
+ * Truncate the positions of a batch like the single queries do and sort their indices by cell, so the
+ * positions in the same cell follow each other and its lists only have to be walked once for all of them.
+ */
+static void collision_batch_sort(Vec3f *positions, s32 count, Vec3i *points, u16 *cells, u8 *order) {
+    s32 i, j;
+
+    for (i = 0; i < count; i++) {
+        points[i][0] = positions[i][0];
+        points[i][1] = positions[i][1];
+        points[i][2] = positions[i][2];
+
+        if (is_outside_level_bounds(points[i][0], points[i][2])) {
+            cells[i] = COLLISION_BATCH_OUT_OF_BOUNDS;
+        } else {
+            cells[i] = (GET_CELL_COORD(points[i][2]) * NUM_CELLS) + GET_CELL_COORD(points[i][0]);
+        }
+
+        // Insertion sort, batches are small
+        for (j = i; j > 0 && cells[order[j - 1]] > cells[i]; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+}
+
+/**
+ * find_floor_from_list for several positions in the same cell. The list is walked once, and each position
+ * sees the surfaces in the same order as find_floor_from_list would, so the results are the same.
+ */
+static void find_floors_from_list_batch(const struct CollisionQuery *query, struct SurfaceNode *surfaceNode,
+                                        Vec3i *points, u8 *order, s32 count, f32 *heights, struct Surface **floors) {
+    struct Surface *surf;
+    f32 height;
+    s32 bufferY;
+    s32 i, k;
+    u32 done = 0;
+    u32 allDone = (count < 32) ? ((1U << count) - 1) : 0xFFFFFFFF;
+
+    for (; surfaceNode != NULL && done != allDone; surfaceNode = surfaceNode->next) {
+        surf = surfaceNode->surface;
+
+        if (floor_query_skips_surface(query, surf)) continue;
+
+        for (k = 0; k < count; k++) {
+            if (done & (1U << k)) continue;
+            i = order[k];
+            bufferY = points[i][1] + FIND_FLOOR_BUFFER;
+
+            if (bufferY < surf->lowerY) continue;
+            if (!check_within_floor_triangle_bounds(points[i][0], points[i][2], surf)) continue;
+
+            height = get_surface_height_at_location(points[i][0], points[i][2], surf);
+
+            if (height <= heights[i]) continue;
+            if (bufferY < height) continue;
+
+            heights[i] = height;
+            floors[i] = surf;
+
+            if ((height == bufferY) || (query->flags & COLLISION_FLAG_RETURN_FIRST)) done |= (1U << k);
+        }
+    }
+}
+
+/**
+ * find_ceil_from_list for several positions in the same cell, see find_floors_from_list_batch.
+ */
+static void find_ceils_from_list_batch(const struct CollisionQuery *query, struct SurfaceNode *surfaceNode,
+                                       Vec3i *points, u8 *order, s32 count, f32 *heights, struct Surface **ceils) {
+    struct Surface *surf;
+    f32 height;
+    s32 i, k;
+    u32 done = 0;
+    u32 allDone = (count < 32) ? ((1U << count) - 1) : 0xFFFFFFFF;
+
+    for (k = 0; k < count; k++) {
+        heights[order[k]] = CELL_HEIGHT_LIMIT;
+    }
+
+    for (; surfaceNode != NULL && done != allDone; surfaceNode = surfaceNode->next) {
+        surf = surfaceNode->surface;
+
+        if (ceil_query_skips_surface(query, surf)) continue;
+
+        for (k = 0; k < count; k++) {
+            if (done & (1U << k)) continue;
+            i = order[k];
+
+            if (points[i][1] > surf->upperY) continue;
+            if (!check_within_ceil_triangle_bounds(points[i][0], points[i][2], surf, 1.5f)) continue;
+
+            height = get_surface_height_at_location(points[i][0], points[i][2], surf);
+
+            if (height > heights[i]) continue;
+            if (points[i][1] > height) continue;
+
+            heights[i] = height;
+            ceils[i] = surf;
+
+            if ((height == points[i][1]) || (query->flags & COLLISION_FLAG_RETURN_FIRST)) done |= (1U << k);
+        }
+    }
+}
+
+/**
+ * Up to COLLISION_BATCH_SIZE positions of find_floors_batch.
+ */
+static void find_floors_batch_round(const struct CollisionQuery *query, Vec3f *positions, s32 count, f32 *heights, struct Surface **floors) {
+    Vec3i points[COLLISION_BATCH_SIZE];
+    u16 cells[COLLISION_BATCH_SIZE];
+    u8 order[COLLISION_BATCH_SIZE];
+    f32 dynamicHeights[COLLISION_BATCH_SIZE];
+    struct Surface *dynamicFloors[COLLISION_BATCH_SIZE];
+    s32 includeDynamic = !(query->flags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+    s32 start, end, i, k;
+    COLLISION_TRACE_GET_QUERY_FLAGS(query);
+
+    collision_batch_sort(positions, count, points, cells, order);
+
+    for (i = 0; i < count; i++) {
+        heights[i] = FLOOR_LOWER_LIMIT;
+        floors[i] = NULL;
+        dynamicHeights[i] = FLOOR_LOWER_LIMIT;
+        dynamicFloors[i] = NULL;
+    }
+
+    for (start = 0; start < count && cells[order[start]] != COLLISION_BATCH_OUT_OF_BOUNDS; start = end) {
+        u16 cell = cells[order[start]];
+        s32 cellX = cell % NUM_CELLS;
+        s32 cellZ = cell / NUM_CELLS;
+
+        for (end = start + 1; end < count && cells[order[end]] == cell; end++);
+
+        if (includeDynamic) {
+            // Check for surfaces belonging to objects.
+            find_floors_from_list_batch(query, gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS],
+                                        points, &order[start], end - start, dynamicHeights, dynamicFloors);
+
+            // In the next check, only check for floors higher than the previous check.
+            for (k = start; k < end; k++) {
+                heights[order[k]] = dynamicHeights[order[k]];
+            }
+        }
+
+        // Check for surfaces that are a part of level geometry.
+        find_floors_from_list_batch(query, gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS],
+                                    points, &order[start], end - start, heights, floors);
+
+        // Use the higher floor.
+        for (k = start; k < end; k++) {
+            i = order[k];
+            if (includeDynamic && heights[i] <= dynamicHeights[i]) {
+                floors[i]  = dynamicFloors[i];
+                heights[i] = dynamicHeights[i];
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_floor);
+        // If a floor was missed, increment the debug counter.
+        if (floors[i] == NULL && cells[i] != COLLISION_BATCH_OUT_OF_BOUNDS) {
+            gNumFindFloorMisses++;
+        }
+#ifdef VANILLA_DEBUG
+        // Increment the debug tracker.
+        gNumCalls.floor++;
+#endif
+        COLLISION_TRACE_RECORD(COL_TRACE_FLOOR, positions[i], gVec3fZero, heights[i], floors[i]);
+    }
+}
+
+/**
+ * find_floor_query for 'count' positions, writing the height of each one's floor to 'heights' and the floor
+ * itself to 'floors', which can be NULL. The positions are grouped by cell, so that each cell's lists are
+ * walked once per batch instead of once per position, which makes this cheaper than a loop of find_floor
+ * calls when the positions are near each other, like those of an object's parts or a formation of coins.
+ *
+ * Batches don't use the collision probe.
+ */
+void find_floors_batch(const struct CollisionQuery *query, Vec3f *positions, s32 count, f32 *heights, struct Surface **floors) {
+    struct Surface *floorBuffer[COLLISION_BATCH_SIZE];
+    s32 i, num;
+    PUPPYPRINT_GET_SNAPSHOT();
+
+    for (i = 0; i < count; i += num) {
+        num = MIN(count - i, COLLISION_BATCH_SIZE);
+        find_floors_batch_round(query, &positions[i], num, &heights[i], (floors != NULL) ? &floors[i] : floorBuffer);
+    }
+
+    profiler_collision_update(first);
+}
+
+/**
+ * Up to COLLISION_BATCH_SIZE positions of find_ceils_batch.
+ */
+static void find_ceils_batch_round(const struct CollisionQuery *query, Vec3f *positions, s32 count, f32 *heights, struct Surface **ceils) {
+    Vec3i points[COLLISION_BATCH_SIZE];
+    u16 cells[COLLISION_BATCH_SIZE];
+    u8 order[COLLISION_BATCH_SIZE];
+    f32 dynamicHeights[COLLISION_BATCH_SIZE];
+    struct Surface *dynamicCeils[COLLISION_BATCH_SIZE];
+    s32 includeDynamic = !(query->flags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+    s32 start, end, i, k;
+    COLLISION_TRACE_GET_QUERY_FLAGS(query);
+
+    collision_batch_sort(positions, count, points, cells, order);
+
+    for (i = 0; i < count; i++) {
+        heights[i] = CELL_HEIGHT_LIMIT;
+        ceils[i] = NULL;
+        dynamicHeights[i] = CELL_HEIGHT_LIMIT;
+        dynamicCeils[i] = NULL;
+    }
+
+    for (start = 0; start < count && cells[order[start]] != COLLISION_BATCH_OUT_OF_BOUNDS; start = end) {
+        u16 cell = cells[order[start]];
+        s32 cellX = cell % NUM_CELLS;
+        s32 cellZ = cell / NUM_CELLS;
+
+        for (end = start + 1; end < count && cells[order[end]] == cell; end++);
+
+        if (includeDynamic) {
+            // Check for surfaces belonging to objects.
+            find_ceils_from_list_batch(query, gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS],
+                                       points, &order[start], end - start, dynamicHeights, dynamicCeils);
+        }
+
+        // Check for surfaces that are a part of level geometry.
+        find_ceils_from_list_batch(query, gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS],
+                                   points, &order[start], end - start, heights, ceils);
+
+        // Use the lower ceiling.
+        for (k = start; k < end; k++) {
+            i = order[k];
+            if (includeDynamic && heights[i] >= dynamicHeights[i]) {
+                ceils[i]   = dynamicCeils[i];
+                heights[i] = dynamicHeights[i];
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_ceil);
+#ifdef VANILLA_DEBUG
+        // Increment the debug tracker.
+        gNumCalls.ceil++;
+#endif
+        COLLISION_TRACE_RECORD(COL_TRACE_CEIL, positions[i], gVec3fZero, heights[i], ceils[i]);
+    }
+}
+
+/**
+ * find_ceil_query for 'count' positions, see find_floors_batch.
+ */
+void find_ceils_batch(const struct CollisionQuery *query, Vec3f *positions, s32 count, f32 *heights, struct Surface **ceils) {
+    struct Surface *ceilBuffer[COLLISION_BATCH_SIZE];
+    s32 i, num;
+    PUPPYPRINT_GET_SNAPSHOT();
+
+    for (i = 0; i < count; i += num) {
+        num = MIN(count - i, COLLISION_BATCH_SIZE);
+        find_ceils_batch_round(query, &positions[i], num, &heights[i], (ceils != NULL) ? &ceils[i] : ceilBuffer);
+    }
+
+    profiler_collision_update(first);
+}
+
 /**************************************************
  *               ENVIRONMENTAL BOXES              *
  **************************************************/
@@ -719,6 +1370,7 @@ s32 find_water_level_and_floor(s32 x, s32 y, s32 z, struct Surface **pfloor) {
     struct Surface *floor = NULL;
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_water);
     PUPPYPRINT_GET_SNAPSHOT();
+    COLLISION_TRACE_GET_FLAGS();
     s32 waterLevel = find_water_floor(x, y, z, &floor);
 
     if (p != NULL && waterLevel == FLOOR_LOWER_LIMIT) {
@@ -744,6 +1396,7 @@ s32 find_water_level_and_floor(s32 x, s32 y, s32 z, struct Surface **pfloor) {
         *pfloor = floor;
     }
 
+    COLLISION_TRACE_RECORD(COL_TRACE_WATER, ((Vec3f){ x, y, z }), gVec3fZero, waterLevel, floor);
     profiler_collision_update(first);
     return waterLevel;
 }
@@ -758,7 +1411,9 @@ s32 find_water_level(s32 x, s32 z) { // TODO: Allow y pos
     struct Surface *floor = NULL;
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_water);
     PUPPYPRINT_GET_SNAPSHOT();
-    s32 waterLevel = find_water_floor(x, ((gCollisionFlags & COLLISION_FLAG_CAMERA) ? gLakituState.pos[1] : gMarioState->pos[1]), z, &floor);
+    COLLISION_TRACE_GET_FLAGS();
+    s32 y = ((gCollisionFlags & COLLISION_FLAG_CAMERA) ? gLakituState.pos[1] : gMarioState->pos[1]);
+    s32 waterLevel = find_water_floor(x, y, z, &floor);
 
     if ((p != NULL) && (waterLevel == FLOOR_LOWER_LIMIT)) {
         s32 numRegions = *p++;
@@ -781,6 +1436,7 @@ s32 find_water_level(s32 x, s32 z) { // TODO: Allow y pos
         }
     }
 
+    COLLISION_TRACE_RECORD(COL_TRACE_WATER, ((Vec3f){ x, y, z }), gVec3fZero, waterLevel, floor);
     profiler_collision_update(first);
 
     return waterLevel;
@@ -826,6 +1482,87 @@ s32 find_poison_gas_level(s32 x, s32 z) {
     return gasLevel;
 }
 
+/**************************************************
+ *                      TRACE                     *
+ **************************************************/
+
+#ifdef COLLISION_TRACE
+struct CollisionTraceEntry gCollisionTrace[COLLISION_TRACE_BUFFER_SIZE];
+u32 gCollisionTraceCount = 0;
+static u32 sCollisionTraceFlushed = 0;
+
+/**
+ * Adds a query to the collision trace ring buffer.
+ * The caller is classified from the flags the query started with and the current object.
+ */
+void collision_trace_record(u32 type, u32 flags, Vec3f pos, Vec3f aux, f32 height, struct Surface *surf) {
+    struct CollisionTraceEntry *entry = &gCollisionTrace[gCollisionTraceCount++ % COLLISION_TRACE_BUFFER_SIZE];
+
+    entry->type  = type;
+    entry->flags = flags;
+
+    if (type != COL_TRACE_RAY && (flags & COLLISION_FLAG_CAMERA)) {
+        entry->caller = COL_TRACE_CALLER_CAMERA;
+    } else if (o == NULL) {
+        entry->caller = COL_TRACE_CALLER_NONE;
+    } else if (o == gMarioObject) {
+        entry->caller = COL_TRACE_CALLER_MARIO;
+    } else {
+        entry->caller = COL_TRACE_CALLER_OBJECT;
+    }
+
+    if (surf == NULL) {
+        entry->result      = COL_TRACE_RESULT_NONE;
+        entry->surfaceType = SURFACE_DEFAULT;
+    } else {
+        entry->result      = (surf->flags & SURFACE_FLAG_DYNAMIC) ? COL_TRACE_RESULT_DYNAMIC : COL_TRACE_RESULT_STATIC;
+        entry->surfaceType = surf->type;
+    }
+
+    vec3f_copy(entry->pos, pos);
+    vec3f_copy(entry->aux, aux);
+    entry->height = height;
+}
+
+/**
+ * Closes the current frame with a marker entry and, with UNF, sends every entry
+ * recorded since the last flush over USB. Entries that were overwritten before they
+ * could be sent are counted in the marker.
+ */
+void collision_trace_flush(void) {
+    u32 dropped = 0;
+
+    if (gCollisionTraceCount - sCollisionTraceFlushed >= COLLISION_TRACE_BUFFER_SIZE) {
+        dropped = (gCollisionTraceCount - sCollisionTraceFlushed) - (COLLISION_TRACE_BUFFER_SIZE - 1);
+        sCollisionTraceFlushed = gCollisionTraceCount - (COLLISION_TRACE_BUFFER_SIZE - 1);
+    }
+
+    struct CollisionTraceEntry *marker = &gCollisionTrace[gCollisionTraceCount++ % COLLISION_TRACE_BUFFER_SIZE];
+    bzero(marker, sizeof(struct CollisionTraceEntry));
+    marker->type        = COL_TRACE_FRAME;
+    marker->flags       = gCurrAreaIndex;
+    marker->surfaceType = gCurrLevelNum;
+    marker->aux[0]      = dropped;
+    marker->height      = gGlobalTimer;
+
+#ifdef UNF
+    u32 start = (sCollisionTraceFlushed % COLLISION_TRACE_BUFFER_SIZE);
+    u32 end   = (gCollisionTraceCount   % COLLISION_TRACE_BUFFER_SIZE);
+
+    if (end > start) {
+        usb_write(DATATYPE_RAWBINARY, &gCollisionTrace[start], (end - start) * sizeof(struct CollisionTraceEntry));
+    } else {
+        usb_write(DATATYPE_RAWBINARY, &gCollisionTrace[start], (COLLISION_TRACE_BUFFER_SIZE - start) * sizeof(struct CollisionTraceEntry));
+        if (end > 0) {
+            usb_write(DATATYPE_RAWBINARY, &gCollisionTrace[0], end * sizeof(struct CollisionTraceEntry));
+        }
+    }
+#endif
+
+    sCollisionTraceFlushed = gCollisionTraceCount;
+}
+#endif
+
 /**************************************************
  *                      DEBUG                     *
  **************************************************/
@@ -42,18 +42,98 @@ struct WallCollisionData {
     /*0x18*/ struct Surface *walls[MAX_REFERENCED_WALLS];
 };
 
+/**
+ * The settings of a collision query, for the *_query and *_batch functions. Those only read it, unlike the
+ * functions without a query that take their flags from gCollisionFlags and reset them, so a query can be
+ * set up once and used for any number of positions.
+ */
+struct CollisionQuery {
+    /// COLLISION_FLAG_* from object_list_processor.h
+    s16 flags;
+    /// If not NULL, surfaces belonging to this object are skipped
+    struct Object *ignoreObject;
+};
+
+#ifdef COLLISION_TRACE
+// The number of queries kept in the ring buffer. Anything beyond this in a single frame is dropped.
+#define COLLISION_TRACE_BUFFER_SIZE 2048
+
+enum CollisionTraceTypes {
+    COL_TRACE_FRAME, // Frame marker: surfaceType = level, flags = area, aux[0] = dropped entries, height = global timer.
+    COL_TRACE_FLOOR,
+    COL_TRACE_CEIL,
+    COL_TRACE_WALL,  // aux = { offsetY, radius, 0 }, height = number of walls collided with.
+    COL_TRACE_WATER,
+    COL_TRACE_RAY,   // aux = ray direction, flags = RaycastFlags, height = hit distance.
+};
+
+enum CollisionTraceCallers {
+    COL_TRACE_CALLER_NONE,
+    COL_TRACE_CALLER_MARIO,
+    COL_TRACE_CALLER_OBJECT,
+    COL_TRACE_CALLER_CAMERA,
+};
+
+enum CollisionTraceResults {
+    COL_TRACE_RESULT_NONE,
+    COL_TRACE_RESULT_STATIC,
+    COL_TRACE_RESULT_DYNAMIC,
+};
+
+struct CollisionTraceEntry {
+    /*0x00*/ u8 type;
+    /*0x01*/ u8 caller;
+    /*0x02*/ u8 flags;
+    /*0x03*/ u8 result;
+    /*0x04*/ s16 surfaceType;
+    /*0x06*/ u8 filler[2];
+    /*0x08*/ Vec3f pos;
+    /*0x14*/ Vec3f aux;
+    /*0x20*/ f32 height;
+}; /*0x24*/
+
+extern struct CollisionTraceEntry gCollisionTrace[COLLISION_TRACE_BUFFER_SIZE];
+extern u32 gCollisionTraceCount;
+
+void collision_trace_record(u32 type, u32 flags, Vec3f pos, Vec3f aux, f32 height, struct Surface *surf);
+void collision_trace_flush(void);
+#define COLLISION_TRACE_GET_FLAGS() u32 traceFlags = gCollisionFlags
+#define COLLISION_TRACE_GET_QUERY_FLAGS(query) u32 traceFlags = (query)->flags
+#define COLLISION_TRACE_RECORD(type, pos, aux, height, surf) collision_trace_record(type, traceFlags, pos, aux, height, surf)
+#else
+#define collision_trace_flush()
+#define COLLISION_TRACE_GET_FLAGS()
+#define COLLISION_TRACE_GET_QUERY_FLAGS(query)
+#define COLLISION_TRACE_RECORD(type, pos, aux, height, surf)
+#endif
+
+#ifdef COLLISION_PROBE
+void collision_probe_begin(Vec3f min, Vec3f max);
+#ifdef COLLISION_PROBE_CAMERA
+void collision_probe_camera_begin(Vec3f min, Vec3f max);
+#endif
+void collision_probe_end(void);
+s32 collision_probe_has_ray(Vec3f orig, Vec3f dir);
+struct SurfaceNode *collision_probe_get_cell_list(s32 useProbe, s32 cellX, s32 cellZ, s32 partition, s32 dynamic);
+#endif
 s32 f32_find_wall_collision(f32 *xPtr, f32 *yPtr, f32 *zPtr, f32 offsetY, f32 radius);
 s32 find_wall_collisions(struct WallCollisionData *colData);
+s32 find_wall_collisions_query(const struct CollisionQuery *query, struct WallCollisionData *colData);
 void resolve_and_return_wall_collisions(Vec3f pos, f32 offset, f32 radius, struct WallCollisionData *collisionData);
 f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil);
+f32 find_ceil_query(const struct CollisionQuery *query, f32 posX, f32 posY, f32 posZ, struct Surface **pceil);
+void find_ceils_batch(const struct CollisionQuery *query, Vec3f *positions, s32 count, f32 *heights, struct Surface **ceils);
 
 // Finds the ceiling from a vec3f and a minimum height (with 3 unit vertical buffer).
 ALWAYS_INLINE f32 find_mario_ceil(Vec3f pos, f32 height, struct Surface **ceil) {
     return find_ceil(pos[0], MAX(height, pos[1]) + 3.0f, pos[2], ceil);
 }
 
+s32 check_within_floor_triangle_bounds(s32 x, s32 z, struct Surface *surf);
 f32 find_floor_height(f32 x, f32 y, f32 z);
 f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor);
+f32 find_floor_query(const struct CollisionQuery *query, f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor);
+void find_floors_batch(const struct CollisionQuery *query, Vec3f *positions, s32 count, f32 *heights, struct Surface **floors);
 f32 find_room_floor(f32 x, f32 y, f32 z, struct Surface **pfloor);
 s32 get_room_at_pos(f32 x, f32 y, f32 z);
 s32 find_water_level_and_floor(s32 x, s32 y, s32 z, struct Surface **pfloor);
@@ -52,6 +52,11 @@ void *gDynamicSurfacePoolEnd;
  */
 u32 gTotalStaticSurfaceData;
 
+/**
+ * Counts the times static surfaces were loaded, so anything keeping static surfaces can tell its copy is stale.
+ */
+u32 gStaticSurfaceLoads;
+
 /**
  * Allocate the part of the surface node pool to contain a surface node.
  */
@@ -538,6 +543,7 @@ void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16
 
     gNumStaticSurfaceNodes = gSurfaceNodesAllocated;
     gNumStaticSurfaces = gSurfacesAllocated;
+    gStaticSurfaceLoads++;
     profiler_collision_update(first);
 }
 
@@ -758,5 +764,6 @@ void load_object_static_model(void) {
 
     gNumStaticSurfaceNodes = gSurfaceNodesAllocated;
     gNumStaticSurfaces = gSurfacesAllocated;
+    gStaticSurfaceLoads++;
     profiler_collision_update(first);
 }
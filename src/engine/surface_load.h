@@ -38,6 +38,7 @@ extern void *gDynamicSurfacePool;
 extern void *gCurrStaticSurfacePoolEnd;
 extern void *gDynamicSurfacePoolEnd;
 extern u32 gTotalStaticSurfaceData;
+extern u32 gStaticSurfaceLoads;
 
 void alloc_surface_pools(void);
 #ifdef NO_SEGMENTED_MEMORY
@@ -163,7 +163,9 @@ void bhv_coin_formation_spawned_coin_loop(void) {
         obj_set_hitbox(o, &sYellowCoinHitbox);
         if (o->oCoinSnapToGround) {
             o->oPosY += 300.0f;
-            cur_obj_update_floor_height();
+            if (!o->oCoinFloorFound) {
+                cur_obj_update_floor_height();
+            }
 
             if (o->oPosY + FIND_FLOOR_BUFFER < o->oFloorHeight || o->oFloorHeight < FLOOR_LOWER_LIMIT_MISC) {
                 obj_mark_for_deletion(o);
@@ -171,7 +173,9 @@ void bhv_coin_formation_spawned_coin_loop(void) {
                 o->oPosY = o->oFloorHeight;
             }
         } else {
-            cur_obj_update_floor_height();
+            if (!o->oCoinFloorFound) {
+                cur_obj_update_floor_height();
+            }
 
             if (absf(o->oPosY - o->oFloorHeight) > 250.0f) {
                 cur_obj_set_model(MODEL_YELLOW_COIN_NO_SHADOW);
@@ -188,7 +192,8 @@ void bhv_coin_formation_spawned_coin_loop(void) {
     }
 }
 
-void spawn_coin_in_formation(s32 index, s32 shape) {
+struct Object *spawn_coin_in_formation(s32 index, s32 shape) {
+    struct Object *newCoin = NULL;
     Vec3i pos = { 0, 0, 0 };
     s32 spawnCoin    = TRUE;
     s32 snapToGround = TRUE;
@@ -223,10 +228,37 @@ void spawn_coin_in_formation(s32 index, s32 shape) {
     }
 
     if (spawnCoin) {
-        struct Object *newCoin =
-            spawn_object_relative(index, pos[0], pos[1], pos[2], o,
-                                  MODEL_YELLOW_COIN, bhvCoinFormationSpawnedCoin);
+        newCoin = spawn_object_relative(index, pos[0], pos[1], pos[2], o,
+                                        MODEL_YELLOW_COIN, bhvCoinFormationSpawnedCoin);
         newCoin->oCoinSnapToGround = snapToGround;
+        newCoin->oCoinFloorFound = FALSE;
+    }
+
+    return newCoin;
+}
+
+/**
+ * Finds the floors under all coins of a formation in one batch, so they are walked
+ * cell by cell instead of once per coin on its first frame.
+ */
+static void coin_formation_find_floors(struct Object **coins, s32 numCoins) {
+    struct CollisionQuery query = { .flags = COLLISION_FLAGS_NONE, .ignoreObject = NULL };
+    Vec3f positions[8];
+    f32 heights[8];
+    s32 i;
+
+    for (i = 0; i < numCoins; i++) {
+        vec3f_copy(positions[i], &coins[i]->oPosVec);
+        if (coins[i]->oCoinSnapToGround) {
+            positions[i][1] += 300.0f;
+        }
+    }
+
+    find_floors_batch(&query, positions, numCoins, heights, NULL);
+
+    for (i = 0; i < numCoins; i++) {
+        coins[i]->oFloorHeight = heights[i];
+        coins[i]->oCoinFloorFound = TRUE;
     }
 }
 
@@ -235,6 +267,8 @@ void bhv_coin_formation_init(void) {
 }
 
 void bhv_coin_formation_loop(void) {
+    struct Object *coins[8];
+    s32 numCoins = 0;
     s32 bitIndex;
 
     switch (o->oAction) {
@@ -242,9 +276,13 @@ void bhv_coin_formation_loop(void) {
             if (o->oDistanceToMario < COIN_FORMATION_DISTANCE) {
                 for (bitIndex = 0; bitIndex < 8; bitIndex++) {
                     if (!(o->oCoinRespawnBits & (1 << bitIndex))) {
-                        spawn_coin_in_formation(bitIndex, o->oBehParams2ndByte);
+                        struct Object *coin = spawn_coin_in_formation(bitIndex, o->oBehParams2ndByte);
+                        if (coin != NULL) {
+                            coins[numCoins++] = coin;
+                        }
                     }
                 }
+                coin_formation_find_floors(coins, numCoins);
                 o->oAction = COIN_FORMATION_ACT_ACTIVE;
             }
             break;
@@ -2866,6 +2866,44 @@ void update_lakitu(struct Camera *c) {
     gLakituState.defMode = c->defMode;
 }
 
+#ifdef COLLISION_PROBE_CAMERA
+/**
+ * Start the camera's collision probe, see collision_probe_camera_begin. The box covers Mario and where
+ * the camera and Lakitu are and are going, plus room for the floor checks above and the ceiling checks
+ * below those points. Checks outside of it still work, they just don't use the probe.
+ */
+static void camera_begin_collision_probe(struct Camera *c) {
+    f32 *points[] = {
+        c->pos, c->focus,
+        gLakituState.pos, gLakituState.focus,
+        gLakituState.goalPos, gLakituState.goalFocus,
+#ifdef PUPPYCAM
+        gPuppyCam.pos, gPuppyCam.focus,
+#endif
+    };
+    Vec3f min, max;
+    s32 i, j;
+
+    vec3f_copy(min, sMarioCamState->pos);
+    vec3f_copy(max, sMarioCamState->pos);
+    for (i = 0; i < ARRAY_COUNT(points); i++) {
+        for (j = 0; j < 3; j++) {
+            min[j] = MIN(min[j], points[i][j]);
+            max[j] = MAX(max[j], points[i][j]);
+        }
+    }
+
+    min[0] -= 300.f;
+    min[1] -= 300.f;
+    min[2] -= 300.f;
+    max[0] += 300.f;
+    max[1] += 600.f;
+    max[2] += 300.f;
+
+    collision_probe_camera_begin(min, max);
+}
+#endif
+
 /**
  * The main camera update function.
  * Gets controller input, checks for cutscenes, handles mode changes, and moves the camera
@@ -2873,6 +2911,9 @@ void update_lakitu(struct Camera *c) {
 void update_camera(struct Camera *c) {
     PROFILER_GET_SNAPSHOT_TYPE(PROFILER_DELTA_COLLISION);
     gCamera = c;
+#ifdef COLLISION_PROBE_CAMERA
+    camera_begin_collision_probe(c);
+#endif
     update_camera_hud_status(c);
     if (c->cutscene == CUTSCENE_NONE
 #ifdef PUPPYCAM
@@ -3114,6 +3155,9 @@ void update_camera(struct Camera *c) {
     }
 #endif
     gLakituState.lastFrameAction = sMarioCamState->action;
+#ifdef COLLISION_PROBE_CAMERA
+    collision_probe_end();
+#endif
     profiler_update(PROFILER_TIME_CAMERA, profiler_get_delta(PROFILER_DELTA_COLLISION) - first);
 }
 
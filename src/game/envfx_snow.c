@@ -38,6 +38,23 @@ Vec3i gSnowCylinderLastPos;
 s16 gSnowParticleCount;
 s16 gSnowParticleMaxCount;
 
+// Snowflake positions. Each coordinate has its own array, so the update loops
+// and the vertex buffer fill only stream through the data they use.
+static s32 *sSnowFlakeX;
+static s32 *sSnowFlakeY;
+static s32 *sSnowFlakeZ;
+
+// Snowflakes drawn per vertex load, with 3 vertices each. F3DEX and later
+// microcodes have room for 32 vertices, Fast3D only for 16.
+// Fast3D has no G_TRI2 either, so gSP2Triangles writes one command per flake there.
+#ifdef F3DEX_GBI_SHARED
+#define SNOWFLAKES_PER_VTX_LOAD 10
+#define SNOWFLAKE_TRI_CMDS_PER_VTX_LOAD ((SNOWFLAKES_PER_VTX_LOAD + 1) / 2)
+#else
+#define SNOWFLAKES_PER_VTX_LOAD 5
+#define SNOWFLAKE_TRI_CMDS_PER_VTX_LOAD SNOWFLAKES_PER_VTX_LOAD
+#endif
+
 /* DATA */
 s8 gEnvFxMode = ENVFX_MODE_NONE;
 
@@ -80,13 +97,14 @@ s32 envfx_init_snow(s32 mode) {
             break;
     }
 
-    gEnvFxBuffer = mem_pool_alloc(gEffectsMemoryPool,
-                                  gSnowParticleMaxCount * sizeof(struct EnvFxParticle));
-    if (gEnvFxBuffer == NULL) {
+    sSnowFlakeX = mem_pool_alloc(gEffectsMemoryPool, 3 * gSnowParticleMaxCount * sizeof(s32));
+    if (sSnowFlakeX == NULL) {
         return FALSE;
     }
 
-    bzero(gEnvFxBuffer, gSnowParticleMaxCount * sizeof(struct EnvFxParticle));
+    bzero(sSnowFlakeX, 3 * gSnowParticleMaxCount * sizeof(s32));
+    sSnowFlakeY = sSnowFlakeX + gSnowParticleMaxCount;
+    sSnowFlakeZ = sSnowFlakeY + gSnowParticleMaxCount;
 
     gEnvFxMode = mode;
     return TRUE;
@@ -174,10 +192,10 @@ void pos_from_orbit(Vec3s origin, Vec3s result, s16 radius, s16 pitch, s16 yaw)
  * 'view' is a cylinder of radius 300 and height 400 centered at the input
  * x, y and z.
  */
-s32 envfx_is_snowflake_alive(s32 index, s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
-    s32 x = (gEnvFxBuffer + index)->xPos;
-    s32 y = (gEnvFxBuffer + index)->yPos;
-    s32 z = (gEnvFxBuffer + index)->zPos;
+static ALWAYS_INLINE s32 envfx_is_snowflake_alive(s32 index, s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
+    s32 x = sSnowFlakeX[index];
+    s32 y = sSnowFlakeY[index];
+    s32 z = sSnowFlakeZ[index];
 
     if (sqr(x - snowCylinderX) + sqr(z - snowCylinderZ) > sqr(300)) {
         return FALSE;
@@ -209,21 +227,22 @@ void envfx_update_snow_normal(s32 snowCylinderX, s32 snowCylinderY, s32 snowCyli
     s32 deltaX = snowCylinderX - gSnowCylinderLastPos[0];
     s32 deltaY = snowCylinderY - gSnowCylinderLastPos[1];
     s32 deltaZ = snowCylinderZ - gSnowCylinderLastPos[2];
+    // Where respawned flakes go and how far living ones move, the same for every flake
+    f32 spawnX = snowCylinderX + (s16)(deltaX * 2) - 200.0f;
+    f32 spawnZ = snowCylinderZ + (s16)(deltaZ * 2) - 200.0f;
+    f32 moveX = (s16)(deltaX / 1.2) - 1.0f;
+    s32 moveY = 2 - (s16)(deltaY * 0.8);
+    f32 moveZ = (s16)(deltaZ / 1.2) - 1.0f;
 
     for (i = 0; i < gSnowParticleCount; i++) {
-        (gEnvFxBuffer + i)->isAlive =
-            envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ);
-        if (!(gEnvFxBuffer + i)->isAlive) {
-            (gEnvFxBuffer + i)->xPos =
-                400.0f * random_float() - 200.0f + snowCylinderX + (s16)(deltaX * 2);
-            (gEnvFxBuffer + i)->zPos =
-                400.0f * random_float() - 200.0f + snowCylinderZ + (s16)(deltaZ * 2);
-            (gEnvFxBuffer + i)->yPos = 200.0f * random_float() + snowCylinderY;
-            (gEnvFxBuffer + i)->isAlive = TRUE;
+        if (!envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ)) {
+            sSnowFlakeX[i] = 400.0f * random_float() + spawnX;
+            sSnowFlakeZ[i] = 400.0f * random_float() + spawnZ;
+            sSnowFlakeY[i] = 200.0f * random_float() + snowCylinderY;
         } else {
-            (gEnvFxBuffer + i)->xPos += random_float() * 2 - 1.0f + (s16)(deltaX / 1.2);
-            (gEnvFxBuffer + i)->yPos -= 2 -(s16)(deltaY * 0.8);
-            (gEnvFxBuffer + i)->zPos += random_float() * 2 - 1.0f + (s16)(deltaZ / 1.2);
+            sSnowFlakeX[i] += random_float() * 2 + moveX;
+            sSnowFlakeY[i] -= moveY;
+            sSnowFlakeZ[i] += random_float() * 2 + moveZ;
         }
     }
 
@@ -243,21 +262,23 @@ void envfx_update_snow_blizzard(s32 snowCylinderX, s32 snowCylinderY, s32 snowCy
     s32 deltaX = snowCylinderX - gSnowCylinderLastPos[0];
     s32 deltaY = snowCylinderY - gSnowCylinderLastPos[1];
     s32 deltaZ = snowCylinderZ - gSnowCylinderLastPos[2];
+    // Where respawned flakes go and how far living ones move, the same for every flake
+    f32 spawnX = snowCylinderX + (s16)(deltaX * 2) - 200.0f;
+    f32 spawnY = snowCylinderY - 200.0f;
+    f32 spawnZ = snowCylinderZ + (s16)(deltaZ * 2) - 200.0f;
+    f32 moveX = (s16)(deltaX / 1.2) + 20.0f - 1.0f;
+    s32 moveY = 5 - (s16)(deltaY * 0.8);
+    f32 moveZ = (s16)(deltaZ / 1.2) - 1.0f;
 
     for (i = 0; i < gSnowParticleCount; i++) {
-        (gEnvFxBuffer + i)->isAlive =
-            envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ);
-        if (!(gEnvFxBuffer + i)->isAlive) {
-            (gEnvFxBuffer + i)->xPos =
-                400.0f * random_float() - 200.0f + snowCylinderX + (s16)(deltaX * 2);
-            (gEnvFxBuffer + i)->zPos =
-                400.0f * random_float() - 200.0f + snowCylinderZ + (s16)(deltaZ * 2);
-            (gEnvFxBuffer + i)->yPos = 400.0f * random_float() - 200.0f + snowCylinderY;
-            (gEnvFxBuffer + i)->isAlive = TRUE;
+        if (!envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ)) {
+            sSnowFlakeX[i] = 400.0f * random_float() + spawnX;
+            sSnowFlakeZ[i] = 400.0f * random_float() + spawnZ;
+            sSnowFlakeY[i] = 400.0f * random_float() + spawnY;
         } else {
-            (gEnvFxBuffer + i)->xPos += random_float() * 2 - 1.0f + (s16)(deltaX / 1.2) + 20.0f;
-            (gEnvFxBuffer + i)->yPos -= 5 -(s16)(deltaY * 0.8);
-            (gEnvFxBuffer + i)->zPos += random_float() * 2 - 1.0f + (s16)(deltaZ / 1.2);
+            sSnowFlakeX[i] += random_float() * 2 + moveX;
+            sSnowFlakeY[i] -= moveY;
+            sSnowFlakeZ[i] += random_float() * 2 + moveZ;
         }
     }
 
@@ -288,15 +309,15 @@ UNUSED static s32 is_in_mystery_snow_area(s32 x, UNUSED s32 y, s32 z) {
  */
 void envfx_update_snow_water(s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
     s32 i;
+    f32 spawnX = snowCylinderX - 200.0f;
+    f32 spawnY = snowCylinderY - 200.0f;
+    f32 spawnZ = snowCylinderZ - 200.0f;
 
     for (i = 0; i < gSnowParticleCount; i++) {
-        (gEnvFxBuffer + i)->isAlive =
-            envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ);
-        if (!(gEnvFxBuffer + i)->isAlive) {
-            (gEnvFxBuffer + i)->xPos = 400.0f * random_float() - 200.0f + snowCylinderX;
-            (gEnvFxBuffer + i)->zPos = 400.0f * random_float() - 200.0f + snowCylinderZ;
-            (gEnvFxBuffer + i)->yPos = 400.0f * random_float() - 200.0f + snowCylinderY;
-            (gEnvFxBuffer + i)->isAlive = TRUE;
+        if (!envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ)) {
+            sSnowFlakeX[i] = 400.0f * random_float() + spawnX;
+            sSnowFlakeZ[i] = 400.0f * random_float() + spawnZ;
+            sSnowFlakeY[i] = 400.0f * random_float() + spawnY;
         }
     }
 }
@@ -339,37 +360,37 @@ void rotate_triangle_vertices(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, s16 p
 }
 
 /**
- * Append 15 vertices to 'gfx', which is enough for 5 snowflakes starting at
- * 'index' in the buffer. The 3 input vertices represent the rotated triangle
- * around (0,0,0) that will be translated to snowflake positions to draw the
- * snowflake image.
+ * Fill a vertex buffer with 3 vertices for every snowflake. The 3 input vertices
+ * represent the rotated triangle around (0,0,0) that will be translated to
+ * snowflake positions to draw the snowflake image.
  */
-void append_snowflake_vertex_buffer(Gfx *gfx, s32 index, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3) {
-    s32 i = 0;
-    Vtx *vertBuf = (Vtx *) alloc_display_list(15 * sizeof(Vtx));
+Vtx *make_snowflake_vertex_buffer(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3) {
+    Vtx *vertBuf = (Vtx *) alloc_display_list(gSnowParticleCount * 3 * sizeof(Vtx));
+    Vtx *vtx = vertBuf;
+    s32 i;
 
     if (vertBuf == NULL) {
-        return;
+        return NULL;
     }
 
-    for (i = 0; i < 15; i += 3) {
-        vertBuf[i] = gSnowTempVtx[0];
-        (vertBuf + i)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex1[0];
-        (vertBuf + i)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex1[1];
-        (vertBuf + i)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex1[2];
-
-        vertBuf[i + 1] = gSnowTempVtx[1];
-        (vertBuf + i + 1)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex2[0];
-        (vertBuf + i + 1)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex2[1];
-        (vertBuf + i + 1)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex2[2];
-
-        vertBuf[i + 2] = gSnowTempVtx[2];
-        (vertBuf + i + 2)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex3[0];
-        (vertBuf + i + 2)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex3[1];
-        (vertBuf + i + 2)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex3[2];
+    for (i = 0; i < gSnowParticleCount; i++, vtx += 3) {
+        vtx[0] = gSnowTempVtx[0];
+        vtx[0].v.ob[0] = sSnowFlakeX[i] + vertex1[0];
+        vtx[0].v.ob[1] = sSnowFlakeY[i] + vertex1[1];
+        vtx[0].v.ob[2] = sSnowFlakeZ[i] + vertex1[2];
+
+        vtx[1] = gSnowTempVtx[1];
+        vtx[1].v.ob[0] = sSnowFlakeX[i] + vertex2[0];
+        vtx[1].v.ob[1] = sSnowFlakeY[i] + vertex2[1];
+        vtx[1].v.ob[2] = sSnowFlakeZ[i] + vertex2[2];
+
+        vtx[2] = gSnowTempVtx[2];
+        vtx[2].v.ob[0] = sSnowFlakeX[i] + vertex3[0];
+        vtx[2].v.ob[1] = sSnowFlakeY[i] + vertex3[1];
+        vtx[2].v.ob[2] = sSnowFlakeZ[i] + vertex3[2];
     }
 
-    gSPVertex(gfx, VIRTUAL_TO_PHYSICAL(vertBuf), 15, 0);
+    return vertBuf;
 }
 
 /**
@@ -383,20 +404,25 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
     struct SnowFlakeVertex vertex1, vertex2, vertex3;
     Gfx *gfxStart;
     Gfx *gfx;
+    Vtx *vertBuf;
+    s32 numFlakes, tri;
 
     vertex1 = gSnowFlakeVertex1;
     vertex2 = gSnowFlakeVertex2;
     vertex3 = gSnowFlakeVertex3;
 
-    gfxStart = (Gfx *) alloc_display_list((gSnowParticleCount * 6 + 3) * sizeof(Gfx));
+    envfx_update_snowflake_count(snowMode, marioPos);
+
+    // One vertex load and the triangle commands per batch, plus the setup and end
+    gfxStart = (Gfx *) alloc_display_list(
+        (((gSnowParticleCount + SNOWFLAKES_PER_VTX_LOAD - 1) / SNOWFLAKES_PER_VTX_LOAD)
+         * (1 + SNOWFLAKE_TRI_CMDS_PER_VTX_LOAD) + 3) * sizeof(Gfx));
     gfx = gfxStart;
 
     if (gfxStart == NULL) {
         return NULL;
     }
 
-    envfx_update_snowflake_count(snowMode, marioPos);
-
     // Note: to and from are inverted here, so the resulting vector goes towards the camera
     orbit_from_positions(camTo, camFrom, &radius, &pitch, &yaw);
 
@@ -444,14 +470,18 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
         gSPDisplayList(gfx++, &tiny_bubble_dl_0B006CD8); // snowflake with blue edge
     }
 
-    for (i = 0; i < gSnowParticleCount; i += 5) {
-        append_snowflake_vertex_buffer(gfx++, i, (s16 *) &vertex1, (s16 *) &vertex2, (s16 *) &vertex3);
+    vertBuf = make_snowflake_vertex_buffer((s16 *) &vertex1, (s16 *) &vertex2, (s16 *) &vertex3);
+
+    for (i = 0; vertBuf != NULL && i < gSnowParticleCount; i += SNOWFLAKES_PER_VTX_LOAD) {
+        numFlakes = MIN(gSnowParticleCount - i, SNOWFLAKES_PER_VTX_LOAD);
+        gSPVertex(gfx++, VIRTUAL_TO_PHYSICAL(vertBuf + i * 3), numFlakes * 3, 0);
 
-        gSP1Triangle(gfx++, 0, 1, 2, 0);
-        gSP1Triangle(gfx++, 3, 4, 5, 0);
-        gSP1Triangle(gfx++, 6, 7, 8, 0);
-        gSP1Triangle(gfx++, 9, 10, 11, 0);
-        gSP1Triangle(gfx++, 12, 13, 14, 0);
+        for (tri = 0; tri + 1 < numFlakes; tri += 2) {
+            gSP2Triangles(gfx++, tri * 3, tri * 3 + 1, tri * 3 + 2, 0, tri * 3 + 3, tri * 3 + 4, tri * 3 + 5, 0);
+        }
+        if (tri < numFlakes) {
+            gSP1Triangle(gfx++, tri * 3, tri * 3 + 1, tri * 3 + 2, 0);
+        }
     }
 
     gSPDisplayList(gfx++, &tiny_bubble_dl_0B006AB0) gSPEndDisplayList(gfx++);
@@ -485,7 +515,12 @@ Gfx *envfx_update_particles(s32 mode, Vec3s marioPos, Vec3s camTo, Vec3s camFrom
 
     switch (mode) {
         case ENVFX_MODE_NONE:
-            envfx_cleanup_snow(gEnvFxBuffer);
+            // Bubbles keep their particles in gEnvFxBuffer, snow in the flake arrays
+            if (gEnvFxMode >= ENVFX_BUBBLE_START) {
+                envfx_cleanup_snow(gEnvFxBuffer);
+            } else {
+                envfx_cleanup_snow(sSnowFlakeX);
+            }
             return NULL;
 
         case ENVFX_SNOW_NORMAL:
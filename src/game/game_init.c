@@ -9,6 +9,7 @@
 #include "buffers/zbuffer.h"
 #include "engine/level_script.h"
 #include "engine/math_util.h"
+#include "engine/surface_collision.h"
 #include "game_init.h"
 #include "main.h"
 #include "memory.h"
@@ -30,6 +31,7 @@
 #include "debug_box.h"
 #include "vc_ultra.h"
 #include "profiling.h"
+#include "lag_recorder.h"
 #include "emutest.h"
 
 // Emulators that the Instant Input patch should not be applied to
@@ -348,6 +350,9 @@ void create_gfx_task_structure(void) {
     gGfxSPTask->task.t.data_size = entries * sizeof(Gfx);
     gGfxSPTask->task.t.yield_data_ptr = (u64 *) gGfxSPTaskYieldBuffer;
     gGfxSPTask->task.t.yield_data_size = OS_YIELD_DATA_SIZE;
+#ifdef PIPELINED_GFX
+    gGfxSPTask->framebuffer = (void *) PHYSICAL_TO_VIRTUAL(gPhysicalFramebuffers[sRenderingFramebuffer]);
+#endif
 }
 
 /**
@@ -410,6 +415,11 @@ void draw_reset_bars(void) {
 void render_init(void) {
 #ifdef DEBUG_FORCE_CRASH_ON_BOOT
     FORCE_CRASH
+#endif
+#ifdef PIPELINED_GFX
+    for (s32 i = 0; i < ARRAY_COUNT(gGfxPools); i++) {
+        gGfxPools[i].spTask.state = SPTASK_STATE_FINISHED_DP;
+    }
 #endif
     gGfxPool = &gGfxPools[0];
     set_segment_base_addr(SEGMENT_RENDER, gGfxPool->buffer);
@@ -424,9 +434,14 @@ void render_init(void) {
     // Skip incrementing the initial framebuffer index on emulators so that they display immediately as the Gfx task finishes
     // VC probably emulates osViSwapBuffer accurately so instant patch breaks VC compatibility
     // Currently, Ares and Simple64 have issues with single buffering so disable it there as well.
+    // Pipelined rendering always needs a framebuffer to draw into that isn't being shown.
+#ifdef PIPELINED_GFX
+    sRenderingFramebuffer++;
+#else
     if (gEmulator & INSTANT_INPUT_BLACKLIST) {
         sRenderingFramebuffer++;
     }
+#endif
     gGlobalTimer++;
 }
 
@@ -435,6 +450,12 @@ void render_init(void) {
  */
 void select_gfx_pool(void) {
     gGfxPool = &gGfxPools[gGlobalTimer % ARRAY_COUNT(gGfxPools)];
+#ifdef PIPELINED_GFX
+    // The RCP may still be drawing the last frame that was built in this pool.
+    while (gGfxPool->spTask.state != SPTASK_STATE_FINISHED_DP) {
+        osRecvMesg(&gGfxVblankQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
+    }
+#endif
     set_segment_base_addr(SEGMENT_RENDER, gGfxPool->buffer);
     gGfxSPTask = &gGfxPool->spTask;
     gDisplayListHead = gGfxPool->buffer;
@@ -447,8 +468,26 @@ void select_gfx_pool(void) {
  * - Tells the VI which color framebuffer to be displayed.
  * - Yields to the VI framerate twice, locking the game at 30 FPS.
  * - Selects which framebuffer will be rendered and displayed to next time.
+ * With PIPELINED_GFX, it queues the display list without waiting for the RDP and moves on to the next framebuffer,
+ * but still yields twice. The scheduler presents the frame once the RDP is done, and select_gfx_pool waits for a free pool.
  */
 void display_and_vsync(void) {
+#ifdef PIPELINED_GFX
+    if (gGoddardVblankCallback != NULL) {
+        gGoddardVblankCallback();
+        gGoddardVblankCallback = NULL;
+    }
+    exec_display_list(&gGfxPool->spTask);
+    sRenderedFramebuffer = sRenderingFramebuffer;
+    if (++sRenderingFramebuffer == 3) {
+        sRenderingFramebuffer = 0;
+    }
+#ifndef UNLOCK_FPS
+    // Keep the game logic at 30 FPS, the scheduler only paces presenting the frames.
+    osRecvMesg(&gGameVblankQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
+    osRecvMesg(&gGameVblankQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
+#endif
+#else
     osRecvMesg(&gGfxVblankQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
     if (gGoddardVblankCallback != NULL) {
         gGoddardVblankCallback();
@@ -471,6 +510,8 @@ void display_and_vsync(void) {
             sRenderingFramebuffer = 0;
         }
     }
+#endif
+    lag_recorder_update();
     gGlobalTimer++;
 }
 
@@ -816,6 +857,7 @@ void thread5_game_loop(UNUSED void *arg) {
         profiler_collision_reset();
         addr = level_script_execute(addr);
         profiler_collision_completed();
+        collision_trace_flush();
 #if !defined(PUPPYPRINT_DEBUG) && defined(VISUAL_DEBUG)
         debug_box_input();
 #endif
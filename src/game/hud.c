@@ -17,6 +17,7 @@
 #include "engine/math_util.h"
 #include "puppycam2.h"
 #include "puppyprint.h"
+#include "buffers/buffers.h"
 
 #include "config.h"
 
@@ -113,6 +114,24 @@ s32 sBreathMeterVisibleTimer = 0;
 
 static struct CameraHUD sCameraHUD = { CAM_STATUS_NONE };
 
+#ifdef HUD_DL_CACHE
+/**
+ * The power meter's display list, kept across frames and rebuilt only when the meter moves or its
+ * health changes. There is one per gfx pool, since the RCP may still be drawing the frame built with
+ * the previous one.
+ */
+struct PowerMeterCache {
+    Gfx dl[16];
+    Mtx mtx;
+    s16 x;
+    s16 y;
+    s16 numHealthWedges;
+    u8 valid;
+};
+
+static struct PowerMeterCache sPowerMeterCache[GFX_NUM_POOLS];
+#endif
+
 /**
  * Renders a rgba16 16x16 glyph texture from a table list.
  */
@@ -153,9 +172,9 @@ void render_hud_small_tex_lut(s32 x, s32 y, Texture *texture) {
 /**
  * Renders power meter health segment texture using a table list.
  */
-void render_power_meter_health_segment(s16 numHealthWedges) {
+void render_power_meter_health_segment(Gfx **dlist, s16 numHealthWedges) {
     Texture *(*healthLUT)[] = segmented_to_virtual(&power_meter_health_segments_lut);
-    Gfx *tempGfxHead = gDisplayListHead;
+    Gfx *tempGfxHead = *dlist;
 
     gDPPipeSync(tempGfxHead++);
     gDPSetTextureImage(tempGfxHead++, G_IM_FMT_RGBA, G_IM_SIZ_16b, 1,
@@ -165,35 +184,66 @@ void render_power_meter_health_segment(s16 numHealthWedges) {
     gSP1Triangle(tempGfxHead++, 0, 1, 2, 0);
     gSP1Triangle(tempGfxHead++, 0, 2, 3, 0);
 
-    gDisplayListHead = tempGfxHead;
+    *dlist = tempGfxHead;
 }
 
 /**
- * Renders power meter display lists.
+ * Writes the power meter's display list, with mtx as its position.
  * That includes the "POWER" base and the colored health segment textures.
  */
-void render_dl_power_meter(s16 numHealthWedges) {
-    Mtx *mtx = alloc_display_list(sizeof(Mtx));
-
-    if (mtx == NULL) {
-        return;
-    }
-
+static void build_power_meter_display_list(Gfx **dlist, Mtx *mtx, s16 numHealthWedges) {
     guTranslate(mtx, (f32) sPowerMeterHUD.x, (f32) sPowerMeterHUD.y, 0);
 
-    gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(mtx++),
+    gSPMatrix((*dlist)++, VIRTUAL_TO_PHYSICAL(mtx),
               G_MTX_MODELVIEW | G_MTX_MUL | G_MTX_PUSH);
-    gSPDisplayList(gDisplayListHead++, &dl_power_meter_base);
+    gSPDisplayList((*dlist)++, &dl_power_meter_base);
 
     if (numHealthWedges != 0) {
-        gSPDisplayList(gDisplayListHead++, &dl_power_meter_health_segments_begin);
-        render_power_meter_health_segment(numHealthWedges);
-        gSPDisplayList(gDisplayListHead++, &dl_power_meter_health_segments_end);
+        gSPDisplayList((*dlist)++, &dl_power_meter_health_segments_begin);
+        render_power_meter_health_segment(dlist, numHealthWedges);
+        gSPDisplayList((*dlist)++, &dl_power_meter_health_segments_end);
     }
 
-    gSPPopMatrix(gDisplayListHead++, G_MTX_MODELVIEW);
+    gSPPopMatrix((*dlist)++, G_MTX_MODELVIEW);
 }
 
+#ifdef HUD_DL_CACHE
+/**
+ * Renders this gfx pool's cached power meter, rebuilding it if the meter moved or its health changed.
+ */
+void render_dl_power_meter(s16 numHealthWedges) {
+    struct PowerMeterCache *cache = &sPowerMeterCache[gGfxPool - gGfxPools];
+    Gfx *dlHead;
+
+    if (!cache->valid || cache->x != sPowerMeterHUD.x || cache->y != sPowerMeterHUD.y
+        || cache->numHealthWedges != numHealthWedges) {
+        dlHead = cache->dl;
+        build_power_meter_display_list(&dlHead, &cache->mtx, numHealthWedges);
+        gSPEndDisplayList(dlHead++);
+
+        cache->x = sPowerMeterHUD.x;
+        cache->y = sPowerMeterHUD.y;
+        cache->numHealthWedges = numHealthWedges;
+        cache->valid = TRUE;
+    }
+
+    gSPDisplayList(gDisplayListHead++, cache->dl);
+}
+#else
+/**
+ * Renders power meter display lists.
+ */
+void render_dl_power_meter(s16 numHealthWedges) {
+    Mtx *mtx = alloc_display_list(sizeof(Mtx));
+
+    if (mtx == NULL) {
+        return;
+    }
+
+    build_power_meter_display_list(&gDisplayListHead, mtx, numHealthWedges);
+}
+#endif
+
 /**
  * Power meter animation called when there's less than 8 health segments
  * Checks its timer to later change into deemphasizing mode.
@@ -279,18 +279,11 @@ void render_generic_char(u8 c) {
 }
 #endif
 
-Texture32 *alloc_ia4_tex_from_i1(Texture *in, s16 width, s16 height) {
-    u32 size = (u32) width * (u32) height;
+static void unpack_ia4_tex_from_i1(Texture *out, Texture *in, s16 width, s16 height) {
     s32 inPos;
     s16 outPos = 0;
     u8 bitMask;
 
-    Texture *out = (Texture *) alloc_display_list(size);
-
-    if (out == NULL) {
-        return NULL;
-    }
-
     for (inPos = 0; inPos < (width * height) / 4; inPos++) {
         bitMask = 0x80;
 
@@ -302,6 +295,66 @@ Texture32 *alloc_ia4_tex_from_i1(Texture *in, s16 width, s16 height) {
             outPos++;
         }
     }
+}
+
+#if MULTILANG && defined(FONT_GLYPH_ATLAS)
+#define FONT_ATLAS_GLYPH_SIZE  ((16 * 8) / 2)
+#define FONT_ATLAS_PAGE_GLYPHS (4096 / FONT_ATLAS_GLYPH_SIZE)
+
+// The dialog font unpacked to IA4. A page of FONT_ATLAS_PAGE_GLYPHS glyphs fills TMEM.
+ALIGNED8 static Texture sFontAtlas[256][FONT_ATLAS_GLYPH_SIZE];
+static u8 sFontAtlasBuilt = FALSE;
+// The atlas page currently in TMEM, or -1 if something else may have been loaded since
+static s8 sFontAtlasPage = -1;
+
+static void build_font_atlas(void) {
+    void **fontLUT = segmented_to_virtual(main_font_lut);
+    s32 c;
+
+    for (c = 0; c < 256; c++) {
+        if (fontLUT[c] != NULL) {
+            unpack_ia4_tex_from_i1(sFontAtlas[c], segmented_to_virtual(fontLUT[c]), 8, 8);
+        }
+    }
+
+    sFontAtlasBuilt = TRUE;
+}
+
+void render_generic_char(u8 c) {
+    s32 page = c / FONT_ATLAS_PAGE_GLYPHS;
+
+    if (!sFontAtlasBuilt) {
+        build_font_atlas();
+    }
+
+    gDPPipeSync(gDisplayListHead++);
+
+    if (page != sFontAtlasPage) {
+        sFontAtlasPage = page;
+        gDPSetTextureImage(gDisplayListHead++, G_IM_FMT_IA, G_IM_SIZ_16b, 1,
+                           VIRTUAL_TO_PHYSICAL(sFontAtlas[page * FONT_ATLAS_PAGE_GLYPHS]));
+        gDPSetTile(gDisplayListHead++, G_IM_FMT_IA, G_IM_SIZ_16b, 0, 0, G_TX_LOADTILE, 0,
+                   G_TX_WRAP | G_TX_NOMIRROR, 3, G_TX_NOLOD, G_TX_WRAP | G_TX_NOMIRROR, 4, G_TX_NOLOD);
+        gDPLoadSync(gDisplayListHead++);
+        gDPLoadBlock(gDisplayListHead++, G_TX_LOADTILE, 0, 0, ((FONT_ATLAS_PAGE_GLYPHS * FONT_ATLAS_GLYPH_SIZE) / 2) - 1,
+                     CALC_DXT(16, G_IM_SIZ_4b_BYTES));
+        gDPSetTileSize(gDisplayListHead++, G_TX_RENDERTILE, 0, 0, (16 - 1) << G_TEXTURE_IMAGE_FRAC, (8 - 1) << G_TEXTURE_IMAGE_FRAC);
+    }
+
+    // Point the render tile at the glyph, each one takes up 8 TMEM words
+    gDPSetTile(gDisplayListHead++, G_IM_FMT_IA, G_IM_SIZ_4b, 1, (c % FONT_ATLAS_PAGE_GLYPHS) * (FONT_ATLAS_GLYPH_SIZE / 8),
+               G_TX_RENDERTILE, 0, G_TX_WRAP | G_TX_NOMIRROR, 3, G_TX_NOLOD, G_TX_WRAP | G_TX_NOMIRROR, 4, G_TX_NOLOD);
+    gSPDisplayList(gDisplayListHead++, dl_ia_text_atlas_char);
+}
+#else
+Texture32 *alloc_ia4_tex_from_i1(Texture *in, s16 width, s16 height) {
+    Texture *out = (Texture *) alloc_display_list((u32) width * (u32) height);
+
+    if (out == NULL) {
+        return NULL;
+    }
+
+    unpack_ia4_tex_from_i1(out, in, width, height);
 
     return (Texture32 *)out;
 }
@@ -321,7 +374,7 @@ void render_generic_char(u8 c) {
 
     gSPDisplayList(gDisplayListHead++, dl_ia_text_tex_settings);
 }
-
+#endif
 
 struct MultiTextEntry {
     u8 length;
@@ -369,6 +422,9 @@ void print_generic_string(s16 x, s16 y, const u8 *str) {
     u8 customColor = 0;
     u8 diffTmp     = 0;
 
+#if MULTILANG && defined(FONT_GLYPH_ATLAS)
+    sFontAtlasPage = -1;
+#endif
     create_dl_translation_matrix(MENU_MTX_PUSH, x, y, 0.0f);
 
     while (str[strPos] != DIALOG_CHAR_TERMINATOR) {
@@ -898,6 +954,9 @@ void handle_dialog_text_and_pages(s8 colorMode, struct DialogEntry *dialog, s8 l
     }
 
     gSPDisplayList(gDisplayListHead++, dl_ia_text_begin);
+#if MULTILANG && defined(FONT_GLYPH_ATLAS)
+    sFontAtlasPage = -1;
+#endif
     strIdx = gDialogTextPos;
 
     if (gDialogBoxState == DIALOG_STATE_HORIZONTAL) {
@@ -0,0 +1,269 @@
+/**
+ * Lag frame recorder.
+ * Keeps a rolling history of what every frame cost, and whenever a frame misses its vblank,
+ * freezes the frames leading up to and following it into a snapshot. Snapshots can be browsed
+ * on the "Lag Frames" Puppyprint page, and are printed over USB when UNF is enabled, so hitches
+ * that happen during long playtests can be looked at afterwards.
+ */
+
+#include <ultra64.h>
+
+#include "sm64.h"
+#include "area.h"
+#include "game_init.h"
+#include "main.h"
+#include "object_list_processor.h"
+#include "lag_recorder.h"
+#include "puppyprint.h"
+#include "printf.h"
+#include "audio/load.h"
+#include "audio/internal.h"
+#ifdef UNF
+#include "usb/usb.h"
+#include "usb/debug.h"
+#endif
+
+#ifdef LAG_FRAME_RECORDER
+
+#define LAG_RDP_CYCLES_TO_USEC(x) ((10 * (x)) / 625)
+
+struct LagSnapshot gLagSnapshots[LAG_RECORDER_NUM_SNAPSHOTS];
+u32 gLagSnapshotCount = 0;
+
+static struct LagFrameRecord sLagHistory[LAG_RECORDER_HISTORY];
+static u32 sLagHistoryIndex = 0;
+static u32 sLagLastVblank = 0;
+static u32 sLagPostFrames = 0;
+
+static u32 lag_frame_cpu_usec(struct LagFrameRecord *frame) {
+    // Audio runs at 60Hz, so it counts twice per frame, same as the profiler.
+    return OS_CYCLES_TO_USEC(frame->times[PROFILER_TIME_TOTAL]) + (OS_CYCLES_TO_USEC(frame->times[PROFILER_TIME_AUDIO]) * 2);
+}
+
+static u32 lag_frame_rsp_usec(struct LagFrameRecord *frame) {
+    return OS_CYCLES_TO_USEC(frame->times[PROFILER_TIME_RSP_GFX]) + (OS_CYCLES_TO_USEC(frame->times[PROFILER_TIME_RSP_AUDIO]) * 2);
+}
+
+static u32 lag_frame_rdp_usec(struct LagFrameRecord *frame) {
+    u32 rdpCycles = MAX(MAX(frame->times[PROFILER_TIME_TMEM], frame->times[PROFILER_TIME_CMD]), frame->times[PROFILER_TIME_PIPE]);
+
+    return LAG_RDP_CYCLES_TO_USEC(rdpCycles);
+}
+
+static void lag_recorder_sample(struct LagFrameRecord *frame, u32 vblanks) {
+    frame->globalTimer = gGlobalTimer;
+    frame->gfxPoolUsed = (GFX_POOL_SIZE * sizeof(Gfx)) - ((u32) gGfxPoolEnd - (u32) gDisplayListHead);
+    frame->dynamicSurfaces = gSurfacesAllocated - gNumStaticSurfaces;
+    frame->levelNum = gCurrLevelNum;
+    frame->areaIndex = gCurrAreaIndex;
+    frame->vblanks = MIN(vblanks, 0xFF);
+    // Notes not sitting in the global free pool are owned by a sequence layer.
+    frame->activeNotes = gMaxSimultaneousNotes - gNoteFreeLists.disabled.u.count;
+
+    for (s32 i = 0; i < NUM_OBJ_LISTS; i++) {
+        struct ObjectNode *listHead = &gObjectLists[i];
+        struct ObjectNode *node = listHead->next;
+        u32 count = 0;
+
+        while (node != listHead) {
+            count++;
+            node = node->next;
+        }
+        frame->objectCounts[i] = MIN(count, 0xFF);
+    }
+
+    profiler_get_latest_times(frame->times);
+}
+
+static void lag_recorder_freeze(void) {
+    struct LagSnapshot *snapshot = &gLagSnapshots[gLagSnapshotCount % LAG_RECORDER_NUM_SNAPSHOTS];
+
+    // sLagHistoryIndex points at the oldest frame, so unroll the ring from there.
+    for (u32 i = 0; i < LAG_RECORDER_HISTORY; i++) {
+        snapshot->frames[i] = sLagHistory[(sLagHistoryIndex + i) % LAG_RECORDER_HISTORY];
+    }
+    snapshot->spikeFrame = LAG_RECORDER_HISTORY - LAG_RECORDER_POST_FRAMES - 1;
+    gLagSnapshotCount++;
+
+    append_puppyprint_log("Lag spike recorded at frame %d.", snapshot->frames[snapshot->spikeFrame].globalTimer);
+#ifdef UNF
+    lag_recorder_dump(snapshot);
+#endif
+}
+
+/**
+ * Called from display_and_vsync once the frame has been presented.
+ */
+void lag_recorder_update(void) {
+    struct LagFrameRecord *frame = &sLagHistory[sLagHistoryIndex];
+    struct LagFrameRecord *prevFrame = &sLagHistory[(sLagHistoryIndex + LAG_RECORDER_HISTORY - 1) % LAG_RECORDER_HISTORY];
+    u32 vblanks = gNumVblanks - sLagLastVblank;
+
+    sLagLastVblank = gNumVblanks;
+    lag_recorder_sample(frame, vblanks);
+    sLagHistoryIndex = (sLagHistoryIndex + 1) % LAG_RECORDER_HISTORY;
+
+    if (sLagPostFrames != 0) {
+        if (--sLagPostFrames == 0) {
+            lag_recorder_freeze();
+        }
+        return;
+    }
+
+    // Loading a new level or area always stalls, so only frames spent in the same area count.
+    if (vblanks > LAG_RECORDER_FRAME_VBLANKS
+     && frame->globalTimer > LAG_RECORDER_HISTORY
+     && frame->levelNum == prevFrame->levelNum
+     && frame->areaIndex == prevFrame->areaIndex) {
+        sLagPostFrames = LAG_RECORDER_POST_FRAMES;
+    }
+}
+
+/**
+ * Prints every frame of a snapshot over the debug channel, one line per frame.
+ */
+void lag_recorder_dump(struct LagSnapshot *snapshot) {
+#ifdef UNF
+    struct LagFrameRecord *spike = &snapshot->frames[snapshot->spikeFrame];
+
+    osSyncPrintf("Lag spike: frame %d, level %d, area %d\n", spike->globalTimer, spike->levelNum, spike->areaIndex);
+    osSyncPrintf("frame vbl cpu rsp rdp | input coll mario behav graph audio cam | gfx dynsurf notes | objects\n");
+    for (u32 i = 0; i < LAG_RECORDER_HISTORY; i++) {
+        struct LagFrameRecord *frame = &snapshot->frames[i];
+        u32 *times = frame->times;
+
+        osSyncPrintf("%c%d %d %d %d %d | %d %d %d %d %d %d %d | %d %d %d |",
+            ((i == snapshot->spikeFrame) ? '*' : ' '), frame->globalTimer, frame->vblanks,
+            lag_frame_cpu_usec(frame), lag_frame_rsp_usec(frame), lag_frame_rdp_usec(frame),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_CONTROLLERS]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_COLLISION]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_MARIO]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_BEHAVIOR_BEFORE_MARIO] + times[PROFILER_TIME_BEHAVIOR_AFTER_MARIO]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_GFX]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_AUDIO]) * 2,
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_CAMERA]),
+            frame->gfxPoolUsed, frame->dynamicSurfaces, frame->activeNotes);
+        for (s32 j = 0; j < NUM_OBJ_LISTS; j++) {
+            osSyncPrintf(" %d", frame->objectCounts[j]);
+        }
+        osSyncPrintf("\n");
+    }
+#endif
+}
+
+#ifdef PUPPYPRINT_DEBUG
+static s32 sLagPageSnapshot = 0;
+static s32 sLagPageFrame = -1;
+
+#define LAG_GRAPH_X      16
+#define LAG_GRAPH_Y      76
+#define LAG_GRAPH_HEIGHT 40
+#define LAG_BAR_WIDTH    ((SCREEN_WIDTH - (LAG_GRAPH_X * 2)) / LAG_RECORDER_HISTORY)
+
+void lag_recorder_render_page(void) {
+    char textBytes[256];
+    u32 numSnapshots = MIN(gLagSnapshotCount, LAG_RECORDER_NUM_SNAPSHOTS);
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 168);
+    finish_blank_box();
+
+    if (numSnapshots == 0) {
+        print_small_text_light(SCREEN_WIDTH / 2, (SCREEN_HEIGHT / 2) - 4, "No lag spikes recorded.", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_DEFAULT);
+        return;
+    }
+
+    // Snapshot 0 on the page is always the newest one.
+    struct LagSnapshot *snapshot = &gLagSnapshots[(gLagSnapshotCount - 1 - sLagPageSnapshot) % LAG_RECORDER_NUM_SNAPSHOTS];
+    if (sLagPageFrame < 0) {
+        sLagPageFrame = snapshot->spikeFrame;
+    }
+    struct LagFrameRecord *frame = &snapshot->frames[sLagPageFrame];
+    u32 *times = frame->times;
+
+    sprintf(textBytes, "Snapshot %d/%d (%d total)\nLevel %d Area %d, spike at frame %d",
+            sLagPageSnapshot + 1, numSnapshots, gLagSnapshotCount,
+            snapshot->frames[snapshot->spikeFrame].levelNum, snapshot->frames[snapshot->spikeFrame].areaIndex,
+            snapshot->frames[snapshot->spikeFrame].globalTimer);
+    print_small_text_light(16, 8, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_DEFAULT);
+
+    // One bar per frame showing its CPU time, where the full height is a 30 FPS frame.
+    prepare_blank_box();
+    render_blank_box(LAG_GRAPH_X, LAG_GRAPH_Y - LAG_GRAPH_HEIGHT, LAG_GRAPH_X + (LAG_BAR_WIDTH * LAG_RECORDER_HISTORY), LAG_GRAPH_Y, 48, 48, 48, 168);
+    for (s32 i = 0; i < LAG_RECORDER_HISTORY; i++) {
+        struct LagFrameRecord *bar = &snapshot->frames[i];
+        s32 height = MIN((lag_frame_cpu_usec(bar) * LAG_GRAPH_HEIGHT) / 33333, LAG_GRAPH_HEIGHT);
+        s32 x = LAG_GRAPH_X + (i * LAG_BAR_WIDTH);
+
+        if (i == sLagPageFrame) {
+            render_blank_box(x, LAG_GRAPH_Y - LAG_GRAPH_HEIGHT, x + LAG_BAR_WIDTH, LAG_GRAPH_Y, 255, 255, 255, 64);
+        }
+        if (bar->vblanks > LAG_RECORDER_FRAME_VBLANKS) {
+            render_blank_box(x + 1, LAG_GRAPH_Y - height, x + LAG_BAR_WIDTH - 1, LAG_GRAPH_Y, 255, 64, 64, 255);
+        } else {
+            render_blank_box(x + 1, LAG_GRAPH_Y - height, x + LAG_BAR_WIDTH - 1, LAG_GRAPH_Y, 64, 255, 64, 255);
+        }
+    }
+    finish_blank_box();
+
+    sprintf(textBytes, "Frame %d (%d from spike)\nVblanks: %d\nCPU: %dus\n Input: %d\n Collision: %d\n Mario: %d\n Behavior: %d\n Graph: %d\n Audio: %d\n Camera: %d\nRSP: %dus\nRDP: %dus",
+            frame->globalTimer, sLagPageFrame - (s32) snapshot->spikeFrame, frame->vblanks,
+            lag_frame_cpu_usec(frame),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_CONTROLLERS]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_COLLISION]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_MARIO]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_BEHAVIOR_BEFORE_MARIO] + times[PROFILER_TIME_BEHAVIOR_AFTER_MARIO]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_GFX]),
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_AUDIO]) * 2,
+            (s32) OS_CYCLES_TO_USEC(times[PROFILER_TIME_CAMERA]),
+            lag_frame_rsp_usec(frame), lag_frame_rdp_usec(frame));
+    print_small_text_light(16, LAG_GRAPH_Y + 6, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_DEFAULT);
+
+    u32 totalObjects = 0;
+    for (s32 i = 0; i < NUM_OBJ_LISTS; i++) {
+        totalObjects += frame->objectCounts[i];
+    }
+    sprintf(textBytes, "Gfx Pool: 0x%X\nDynamic Surfaces: %d\nAudio Notes: %d\nObjects: %d\n Actors: %d\n Pushable: %d\n Level: %d\n Surface: %d\n Polelike: %d\n Spawner: %d\n Unimportant: %d",
+            frame->gfxPoolUsed, frame->dynamicSurfaces, frame->activeNotes, totalObjects,
+            frame->objectCounts[OBJ_LIST_GENACTOR], frame->objectCounts[OBJ_LIST_PUSHABLE],
+            frame->objectCounts[OBJ_LIST_LEVEL], frame->objectCounts[OBJ_LIST_SURFACE],
+            frame->objectCounts[OBJ_LIST_POLELIKE], frame->objectCounts[OBJ_LIST_SPAWNER],
+            frame->objectCounts[OBJ_LIST_UNIMPORTANT]);
+    print_small_text_light(SCREEN_WIDTH - 16, LAG_GRAPH_Y + 6, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_DEFAULT);
+
+#ifdef UNF
+    print_small_text_light(SCREEN_WIDTH - 16, 8, "D-Pad: Browse\nA: Dump over USB", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+#else
+    print_small_text_light(SCREEN_WIDTH - 16, 8, "D-Pad: Browse", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+#endif
+}
+
+/**
+ * Up and down switch between snapshots, left and right step through the frames of the current one.
+ */
+void lag_recorder_page_input(void) {
+    s32 numSnapshots = MIN(gLagSnapshotCount, LAG_RECORDER_NUM_SNAPSHOTS);
+    u16 buttons = gPlayer1Controller->buttonPressed;
+
+    if (numSnapshots == 0) {
+        return;
+    }
+    if (buttons & (U_JPAD | D_JPAD)) {
+        sLagPageSnapshot += ((buttons & D_JPAD) ? 1 : (numSnapshots - 1));
+        sLagPageSnapshot %= numSnapshots;
+        sLagPageFrame = -1;
+    }
+    if (sLagPageFrame >= 0) {
+        if (buttons & R_JPAD) {
+            sLagPageFrame = (sLagPageFrame + 1) % LAG_RECORDER_HISTORY;
+        } else if (buttons & L_JPAD) {
+            sLagPageFrame = (sLagPageFrame + LAG_RECORDER_HISTORY - 1) % LAG_RECORDER_HISTORY;
+        }
+    }
+    if (buttons & A_BUTTON) {
+        lag_recorder_dump(&gLagSnapshots[(gLagSnapshotCount - 1 - sLagPageSnapshot) % LAG_RECORDER_NUM_SNAPSHOTS]);
+    }
+}
+#endif
+
+#endif
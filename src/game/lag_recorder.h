@@ -0,0 +1,51 @@
+#ifndef LAG_RECORDER_H
+#define LAG_RECORDER_H
+
+#include <PR/ultratypes.h>
+
+#include "config.h"
+#include "profiling.h"
+#include "object_list_processor.h"
+
+#ifdef LAG_FRAME_RECORDER
+
+// How many frames are kept in the rolling history, and therefore in each snapshot.
+#define LAG_RECORDER_HISTORY       32
+// How many frames after the spike are recorded before the snapshot is frozen.
+#define LAG_RECORDER_POST_FRAMES   8
+// How many snapshots are kept. Once full, the oldest one is overwritten.
+#define LAG_RECORDER_NUM_SNAPSHOTS 4
+// A frame that takes longer than this many retraces has missed its vblank (30 FPS target).
+#define LAG_RECORDER_FRAME_VBLANKS 2
+
+struct LagFrameRecord {
+    /*0x00*/ u32 globalTimer;
+    /*0x04*/ u32 gfxPoolUsed; // Bytes of the gfx pool used by display lists and alloc_display_list.
+    /*0x08*/ s16 dynamicSurfaces;
+    /*0x0A*/ s16 levelNum;
+    /*0x0C*/ u8 areaIndex;
+    /*0x0D*/ u8 vblanks; // Retraces elapsed since the previous frame was presented.
+    /*0x0E*/ u8 activeNotes;
+    /*0x0F*/ u8 objectCounts[NUM_OBJ_LISTS];
+    /*0x1C*/ u32 times[PROFILER_TIME_COUNT]; // Raw profiler values, in CPU cycles (RDP clocks for the RDP buckets).
+};
+
+struct LagSnapshot {
+    struct LagFrameRecord frames[LAG_RECORDER_HISTORY]; // Oldest frame first.
+    u32 spikeFrame; // Index into frames of the frame that missed its vblank.
+};
+
+extern struct LagSnapshot gLagSnapshots[LAG_RECORDER_NUM_SNAPSHOTS];
+extern u32 gLagSnapshotCount;
+
+void lag_recorder_update(void);
+void lag_recorder_dump(struct LagSnapshot *snapshot);
+#ifdef PUPPYPRINT_DEBUG
+void lag_recorder_render_page(void);
+void lag_recorder_page_input(void);
+#endif
+#else
+#define lag_recorder_update()
+#endif
+
+#endif // LAG_RECORDER_H
@@ -236,6 +236,26 @@ u32 mario_update_windy_ground(struct MarioState *m) {
     return FALSE;
 }
 
+#ifdef COLLISION_PROBE
+/**
+ * Gather the surfaces Mario's four quarter steps can reach, see collision_probe_begin. The box covers
+ * his movement this frame plus room for wall pushes and ledge checks on the sides, stepping down slopes
+ * below, and the highest wall, ceiling and ledge checks above.
+ */
+static void mario_begin_step_probe(struct MarioState *m, f32 velX, f32 velY, f32 velZ) {
+    Vec3f min, max;
+
+    min[0] = m->pos[0] + MIN(velX, 0.0f) - 120.0f;
+    min[1] = m->pos[1] + MIN(velY, 0.0f) - 100.0f;
+    min[2] = m->pos[2] + MIN(velZ, 0.0f) - 120.0f;
+    max[0] = m->pos[0] + MAX(velX, 0.0f) + 120.0f;
+    max[1] = m->pos[1] + MAX(velY, 0.0f) + 160.0f;
+    max[2] = m->pos[2] + MAX(velZ, 0.0f) + 120.0f;
+
+    collision_probe_begin(min, max);
+}
+#endif
+
 void stop_and_set_height_to_floor(struct MarioState *m) {
     struct Object *marioObj = m->marioObj;
 
@@ -352,6 +372,9 @@ s32 perform_ground_step(struct MarioState *m) {
 
     set_mario_wall(m, NULL);
 
+#ifdef COLLISION_PROBE
+    mario_begin_step_probe(m, m->vel[0], 0.0f, m->vel[2]);
+#endif
     for (i = 0; i < 4; i++) {
         intendedPos[0] = m->pos[0] + m->floor->normal.y * (m->vel[0] / numSteps);
         intendedPos[2] = m->pos[2] + m->floor->normal.y * (m->vel[2] / numSteps);
@@ -362,6 +385,9 @@ s32 perform_ground_step(struct MarioState *m) {
             break;
         }
     }
+#ifdef COLLISION_PROBE
+    collision_probe_end();
+#endif
 
     m->terrainSoundAddend = mario_get_terrain_sound_addend(m);
     vec3f_copy(m->marioObj->header.gfx.pos, m->pos);
@@ -687,6 +713,9 @@ s32 perform_air_step(struct MarioState *m, u32 stepArg) {
 
     set_mario_wall(m, NULL);
 
+#ifdef COLLISION_PROBE
+    mario_begin_step_probe(m, m->vel[0], m->vel[1], m->vel[2]);
+#endif
     for (i = 0; i < 4; i++) {
         intendedPos[0] = m->pos[0] + m->vel[0] / numSteps;
         intendedPos[1] = m->pos[1] + m->vel[1] / numSteps;
@@ -704,6 +733,9 @@ s32 perform_air_step(struct MarioState *m, u32 stepArg) {
             break;
         }
     }
+#ifdef COLLISION_PROBE
+    collision_probe_end();
+#endif
 
     if (m->vel[1] >= 0.0f) {
         m->peakHeight = m->pos[1];
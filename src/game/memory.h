@@ -20,6 +20,16 @@ struct AllocOnlyPool {
 };
 
 struct MemoryPool;
+struct HeapPool;
+
+struct HeapStats {
+    u32 totalSpace;
+    u32 usedSpace;     // Includes block headers.
+    u32 freeSpace;
+    u32 largestFree;   // The largest block that could be allocated right now, including its header.
+    u32 numFreeBlocks;
+    u32 numUsedBlocks;
+};
 
 struct OffsetSizePair {
     u32 offset;
@@ -41,6 +51,11 @@ struct DmaHandlerList {
 #define EFFECTS_MEMORY_POOL 0x4000
 
 extern struct MemoryPool *gEffectsMemoryPool;
+#ifdef GENERAL_HEAP
+#define GENERAL_HEAP_SIZE   0x10000
+
+extern struct HeapPool *gGeneralHeap;
+#endif
 
 uintptr_t set_segment_base_addr(s32 segment, void *addr);
 void *get_segment_base_addr(s32 segment);
@@ -76,6 +91,12 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side);
 void *mem_pool_alloc(struct MemoryPool *pool, u32 size);
 void mem_pool_free(struct MemoryPool *pool, void *addr);
 
+struct HeapPool *heap_pool_init(u32 size, u32 side);
+void *heap_pool_alloc(struct HeapPool *pool, u32 size);
+void heap_pool_free(struct HeapPool *pool, void *addr);
+void heap_pool_walk(struct HeapPool *pool, void (*func)(u32 offset, u32 size, s32 isFree));
+void heap_pool_get_stats(struct HeapPool *pool, struct HeapStats *stats);
+
 void *alloc_display_list(u32 size);
 void setup_dma_table_list(struct DmaHandlerList *list, void *srcAddr, void *buffer);
 s32 load_patchable_table(struct DmaHandlerList *list, s32 index);
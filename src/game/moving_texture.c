@@ -13,6 +13,8 @@
 #include "geo_misc.h"
 #include "rendering_graph_node.h"
 #include "object_list_processor.h"
+#include "game_init.h"
+#include "buffers/buffers.h"
 
 /**
  * This file contains functions for generating display lists with moving textures
@@ -345,10 +347,18 @@ struct MovtexQuad {
 /// Variable for a little optimization: only set the texture when it differs from the previous texture
 s16 gMovetexLastTextureId;
 
+// Fast3D has no G_TRI2, so gSP2Triangles writes a gSP1Triangle for each triangle there.
+#ifdef F3DEX_GBI_SHARED
+#define MOVTEX_QUAD_TRI_CMDS 1
+#else
+#define MOVTEX_QUAD_TRI_CMDS 2
+#endif
+
 /**
- * Generates and returns a display list for a single MovtexQuad at height y.
+ * Appends to 'gfx' the commands drawing a single MovtexQuad at height y, writing
+ * its vertices to 'verts'.
  */
-Gfx *movtex_gen_from_quad(s16 y, struct MovtexQuad *quad) {
+void movtex_append_quad(Gfx **gfx, Vtx *verts, s16 y, struct MovtexQuad *quad) {
     s16 rot;
     s16 rotspeed = quad->rotspeed;
     s16 scale = quad->scale;
@@ -363,20 +373,7 @@ Gfx *movtex_gen_from_quad(s16 y, struct MovtexQuad *quad) {
     s16 rotDir = quad->rotDir;
     s16 alpha = quad->alpha;
     s16 textureId = quad->textureId;
-    Vtx *verts = alloc_display_list(4 * sizeof(*verts));
-    Gfx *gfxHead;
-    Gfx *gfx;
-
-    if (textureId == gMovetexLastTextureId) {
-        gfxHead = alloc_display_list(3 * sizeof(*gfxHead));
-    } else {
-        gfxHead = alloc_display_list(8 * sizeof(*gfxHead));
-    }
 
-    if (gfxHead == NULL || verts == NULL) {
-        return NULL;
-    }
-    gfx = gfxHead;
     if (gMovtexCounter != gMovtexCounterPrev) {
         quad->rot += rotspeed;
     }
@@ -397,64 +394,34 @@ Gfx *movtex_gen_from_quad(s16 y, struct MovtexQuad *quad) {
     if (textureId != gMovetexLastTextureId) {
         switch (textureId) {
             case TEXTURE_MIST: // an ia16 texture
-                gLoadBlockTexture(gfx++, 32, 32, G_IM_FMT_IA, gMovtexIdToTexture[textureId]);
+                gLoadBlockTexture((*gfx)++, 32, 32, G_IM_FMT_IA, gMovtexIdToTexture[textureId]);
                 break;
             default: // any rgba16 texture
-                gLoadBlockTexture(gfx++, 32, 32, G_IM_FMT_RGBA, gMovtexIdToTexture[textureId]);
+                gLoadBlockTexture((*gfx)++, 32, 32, G_IM_FMT_RGBA, gMovtexIdToTexture[textureId]);
                 break;
         }
         gMovetexLastTextureId = textureId;
     }
-    gSPVertex(gfx++, VIRTUAL_TO_PHYSICAL2(verts), 4, 0);
-    gSPDisplayList(gfx++, dl_draw_quad_verts_0123);
-    gSPEndDisplayList(gfx);
-    return gfxHead;
-}
-
-/**
- * Generate a display list drawing an array of MoxtexQuad at height 'y'.
- * y: y position of the quads
- * quadArrSegmented: a segmented address to an array of s16. The first number
- * is the number of entries, followed by that number of MovtexQuad structs.
- */
-Gfx *movtex_gen_from_quad_array(s16 y, void *quadArrSegmented) {
-    s16 *quadArr = segmented_to_virtual(quadArrSegmented);
-    s16 numLists = quadArr[0];
-    Gfx *gfxHead = alloc_display_list((numLists + 1) * sizeof(*gfxHead));
-    Gfx *gfx = gfxHead;
-    Gfx *subList;
-    s32 i;
-
-    if (gfxHead == NULL) {
-        return NULL;
-    }
-    for (i = 0; i < numLists; i++) {
-        // quadArr is an array of s16, so sizeof(MovtexQuad) gets divided by 2
-        subList = movtex_gen_from_quad(
-            y, (struct MovtexQuad *) (&quadArr[i * (sizeof(struct MovtexQuad) / 2) + 1]));
-        if (subList != NULL) {
-            gSPDisplayList(gfx++, VIRTUAL_TO_PHYSICAL(subList));
-        }
-    }
-    gSPEndDisplayList(gfx);
-    return gfxHead;
+    gSPVertex((*gfx)++, VIRTUAL_TO_PHYSICAL2(verts), 4, 0);
+    // Same as dl_draw_quad_verts_0123, without the display list call
+    gSP2Triangles((*gfx)++, 0, 1, 2, 0x0, 0, 2, 3, 0x0);
 }
 
 /**
- * Generate the display list for a list of quads by searching through a collection
- * for a given id.
- * id: id of quad array to generate a list for
- * y: height at which the quads are drawn
+ * Find the array of quads with the given id in a collection.
+ * id: id of quad array to find
  * movetexQuadsSegmented: segmented address to the MovtexQuadCollection array
  * that will be searched.
+ * Returns a pointer to an array of s16. The first number is the number of entries,
+ * followed by that number of MovtexQuad structs.
  */
-Gfx *movtex_gen_quads_id(s16 id, s16 y, void *movetexQuadsSegmented) {
+s16 *movtex_find_quad_array(s16 id, void *movetexQuadsSegmented) {
     struct MovtexQuadCollection *collection = segmented_to_virtual(movetexQuadsSegmented);
     s32 i = 0;
 
     while (collection[i].id != -1) {
         if (collection[i].id == id) {
-            return movtex_gen_from_quad_array(y, collection[i].quadArraySegmented);
+            return segmented_to_virtual(collection[i].quadArraySegmented);
         }
         i++;
     }
@@ -573,13 +540,14 @@ void movtex_change_texture_format(u32 quadCollectionId, Gfx **gfx) {
 Gfx *geo_movtex_draw_water_regions(s32 callContext, struct GraphNode *node, UNUSED Mat4 mtx) {
     Gfx *gfxHead = NULL;
     Gfx *gfx = NULL;
-    Gfx *subList;
+    Vtx *verts;
     void *quadCollection;
     struct GraphNodeGenerated *asGenerated;
+    s16 *quadArr;
     s16 numWaterBoxes;
-    s16 waterId;
     s16 waterY;
-    s32 i;
+    s32 numQuads;
+    s32 i, j;
 
     if (callContext == GEO_CONTEXT_RENDER) {
         gMovtexVtxColor = MOVTEX_VTX_COLOR_DEFAULT;
@@ -587,12 +555,6 @@ Gfx *geo_movtex_draw_water_regions(s32 callContext, struct GraphNode *node, UNUS
             return NULL;
         }
         numWaterBoxes = gEnvironmentRegions[0];
-        gfxHead = alloc_display_list((numWaterBoxes + 3) * sizeof(*gfxHead));
-        if (gfxHead == NULL) {
-            return NULL;
-        } else {
-            gfx = gfxHead;
-        }
         asGenerated = (struct GraphNodeGenerated *) node;
         if (asGenerated->parameter == JRB_MOVTEX_INITIAL_MIST) {
             if (gLakituState.goalPos[1] < 1024.0f) { // if camera under water
@@ -613,14 +575,40 @@ Gfx *geo_movtex_draw_water_regions(s32 callContext, struct GraphNode *node, UNUS
 
         SET_GRAPH_NODE_LAYER(asGenerated->fnNode.node.flags, LAYER_TRANSPARENT_INTER);
 
+        // Count the quads of all water boxes first, so their vertices and commands
+        // can be written to one buffer each instead of a display list per quad.
+        numQuads = 0;
+        for (i = 0; i < numWaterBoxes; i++) {
+            quadArr = movtex_find_quad_array(gEnvironmentRegions[i * 6 + 1], quadCollection);
+            if (quadArr != NULL) {
+                numQuads += quadArr[0];
+            }
+        }
+        if (numQuads == 0) {
+            return NULL;
+        }
+
+        // A quad is at most a texture load (5 commands), a vertex load and its triangles
+        gfxHead = alloc_display_list((numQuads * (5 + 1 + MOVTEX_QUAD_TRI_CMDS) + 3) * sizeof(*gfxHead));
+        verts = alloc_display_list(numQuads * 4 * sizeof(*verts));
+        if (gfxHead == NULL || verts == NULL) {
+            return NULL;
+        }
+        gfx = gfxHead;
+
         movtex_change_texture_format(asGenerated->parameter, &gfx);
         gMovetexLastTextureId = -1;
         for (i = 0; i < numWaterBoxes; i++) {
-            waterId = gEnvironmentRegions[i * 6 + 1];
+            quadArr = movtex_find_quad_array(gEnvironmentRegions[i * 6 + 1], quadCollection);
+            if (quadArr == NULL) {
+                continue;
+            }
             waterY = gEnvironmentRegions[i * 6 + 6];
-            subList = movtex_gen_quads_id(waterId, waterY, quadCollection);
-            if (subList != NULL)
-                gSPDisplayList(gfx++, VIRTUAL_TO_PHYSICAL(subList));
+            for (j = 0; j < quadArr[0]; j++, verts += 4) {
+                // quadArr is an array of s16, so sizeof(MovtexQuad) gets divided by 2
+                movtex_append_quad(&gfx, verts, waterY,
+                                   (struct MovtexQuad *) (&quadArr[j * (sizeof(struct MovtexQuad) / 2) + 1]));
+            }
         }
         gSPDisplayList(gfx++, dl_waterbox_end);
         gSPEndDisplayList(gfx);
@@ -719,14 +707,130 @@ void movtex_write_vertex_index(Vtx *verts, s32 index, s16 *movtexVerts, struct M
     }
 }
 
+/**
+ * Write the display list drawing a MovtexObject with the given vertices.
+ */
+static void movtex_write_list(Gfx *gfx, Vtx *verts, struct MovtexObject *movtexList) {
+    gSPDisplayList(gfx++, movtexList->beginDl);
+    gLoadBlockTexture(gfx++, 32, 32, G_IM_FMT_RGBA, gMovtexIdToTexture[movtexList->textureId]);
+    gSPVertex(gfx++, VIRTUAL_TO_PHYSICAL2(verts), movtexList->vtx_count, 0);
+    gSPDisplayList(gfx++, movtexList->triDl);
+    gSPDisplayList(gfx++, movtexList->endDl);
+    gSPEndDisplayList(gfx);
+}
+
+#ifdef MOVTEX_VTX_CACHE
+#define MOVTEX_CACHE_SLOTS    8
+// The RSP vertex buffer size the movtex meshes are made for
+#define MOVTEX_CACHE_VERTICES 16
+#define MOVTEX_LIST_GFX       11
+
+/**
+ * The vertices and display list of a MovtexObject, kept across frames for each gfx
+ * pool. Scrolling only changes the texture coordinates, so those are all that gets
+ * rewritten, and only when the scroll offset moved since the pool last drew it.
+ */
+struct MovtexObjectCache {
+    struct MovtexObject *object;
+    s16 *movtexVerts;
+    s16 levelNum;
+    s16 areaIndex;
+    s16 baseS;
+    s16 baseT;
+    Vtx verts[MOVTEX_CACHE_VERTICES];
+    Gfx gfx[MOVTEX_LIST_GFX];
+};
+
+static struct MovtexObjectCache sMovtexObjectCache[GFX_NUM_POOLS][MOVTEX_CACHE_SLOTS];
+
+/**
+ * Rewrite only the texture coordinates of the vertices of a movtex mesh, the same way
+ * movtex_write_vertex_first and movtex_write_vertex_index compute them.
+ */
+static void movtex_write_tex_coords(Vtx *verts, s16 *movtexVerts, s32 vtxCount, s8 attrLayout) {
+    s32 stride = (attrLayout == MOVTEX_LAYOUT_NOCOLOR) ? 5 : 8;
+    s32 attrS = (attrLayout == MOVTEX_LAYOUT_NOCOLOR) ? MOVTEX_ATTR_NOCOLOR_S : MOVTEX_ATTR_COLORED_S;
+    s16 baseS = movtexVerts[attrS];
+    s16 baseT = movtexVerts[attrS + 1];
+    s16 *entry = movtexVerts + stride + attrS;
+    s32 i;
+
+    verts[0].v.tc[0] = baseS;
+    verts[0].v.tc[1] = baseT;
+    for (i = 1; i < vtxCount; i++, entry += stride) {
+        verts[i].v.tc[0] = (s16)(baseS + ((entry[0] * 32) * 32U));
+        verts[i].v.tc[1] = (s16)(baseT + ((entry[1] * 32) * 32U));
+    }
+}
+
+/**
+ * Returns the cached display list for a MovtexObject, building it the first time the
+ * current gfx pool draws it in this area. Returns NULL if it can't be cached.
+ */
+static Gfx *movtex_get_cached_list(s16 *movtexVerts, struct MovtexObject *movtexList, s8 attrLayout) {
+    struct MovtexObjectCache *slots = sMovtexObjectCache[gGfxPool - gGfxPools];
+    struct MovtexObjectCache *slot = NULL;
+    struct MovtexObjectCache *freeSlot = NULL;
+    s32 attrS = (attrLayout == MOVTEX_LAYOUT_NOCOLOR) ? MOVTEX_ATTR_NOCOLOR_S : MOVTEX_ATTR_COLORED_S;
+    s32 i;
+
+    if (movtexList->vtx_count > MOVTEX_CACHE_VERTICES) {
+        return NULL;
+    }
+
+    for (i = 0; i < MOVTEX_CACHE_SLOTS; i++) {
+        // Slots filled in another area may point at data that isn't loaded anymore
+        if (slots[i].object == NULL || slots[i].levelNum != gCurrLevelNum || slots[i].areaIndex != gCurrAreaIndex) {
+            if (freeSlot == NULL) {
+                freeSlot = &slots[i];
+            }
+        } else if (slots[i].object == movtexList && slots[i].movtexVerts == movtexVerts) {
+            slot = &slots[i];
+            break;
+        }
+    }
+
+    if (slot == NULL) {
+        if (freeSlot == NULL) {
+            return NULL;
+        }
+        slot = freeSlot;
+        slot->object = movtexList;
+        slot->movtexVerts = movtexVerts;
+        slot->levelNum = gCurrLevelNum;
+        slot->areaIndex = gCurrAreaIndex;
+        slot->baseS = movtexVerts[attrS];
+        slot->baseT = movtexVerts[attrS + 1];
+
+        movtex_write_vertex_first(slot->verts, movtexVerts, movtexList, attrLayout);
+        for (i = 1; i < movtexList->vtx_count; i++) {
+            movtex_write_vertex_index(slot->verts, i, movtexVerts, movtexList, attrLayout);
+        }
+        movtex_write_list(slot->gfx, slot->verts, movtexList);
+    } else if (slot->baseS != movtexVerts[attrS] || slot->baseT != movtexVerts[attrS + 1]) {
+        slot->baseS = movtexVerts[attrS];
+        slot->baseT = movtexVerts[attrS + 1];
+        movtex_write_tex_coords(slot->verts, movtexVerts, movtexList->vtx_count, attrLayout);
+    }
+
+    return slot->gfx;
+}
+#endif
+
 /**
  * Generate a displaylist for a MovtexObject.
  * 'attrLayout' is one of MOVTEX_LAYOUT_NOCOLOR and MOVTEX_LAYOUT_COLORED.
  */
 Gfx *movtex_gen_list(s16 *movtexVerts, struct MovtexObject *movtexList, s8 attrLayout) {
+#ifdef MOVTEX_VTX_CACHE
+    Gfx *cachedList = movtex_get_cached_list(movtexVerts, movtexList, attrLayout);
+
+    if (cachedList != NULL) {
+        return cachedList;
+    }
+#endif
     Vtx *verts = alloc_display_list(movtexList->vtx_count * sizeof(*verts));
     Gfx *gfxHead = alloc_display_list(11 * sizeof(*gfxHead));
-    Gfx *gfx = gfxHead;
     s32 i;
 
     if (verts == NULL || gfxHead == NULL) {
@@ -738,12 +842,7 @@ Gfx *movtex_gen_list(s16 *movtexVerts, struct MovtexObject *movtexList, s8 attrL
         movtex_write_vertex_index(verts, i, movtexVerts, movtexList, attrLayout);
     }
 
-    gSPDisplayList(gfx++, movtexList->beginDl);
-    gLoadBlockTexture(gfx++, 32, 32, G_IM_FMT_RGBA, gMovtexIdToTexture[movtexList->textureId]);
-    gSPVertex(gfx++, VIRTUAL_TO_PHYSICAL2(verts), movtexList->vtx_count, 0);
-    gSPDisplayList(gfx++, movtexList->triDl);
-    gSPDisplayList(gfx++, movtexList->endDl);
-    gSPEndDisplayList(gfx);
+    movtex_write_list(gfxHead, verts, movtexList);
     return gfxHead;
 }
 
@@ -23,6 +23,7 @@
 #include "obj_behaviors.h"
 #include "object_helpers.h"
 #include "object_list_processor.h"
+#include "particle_system.h"
 #include "rendering_graph_node.h"
 #include "spawn_object.h"
 #include "spawn_sound.h"
@@ -598,13 +599,22 @@ f32 cur_obj_dist_to_nearest_object_with_behavior(const BehaviorScript *behavior)
 
 struct Object *cur_obj_find_nearest_object_with_behavior(const BehaviorScript *behavior, f32 *dist) {
     uintptr_t *behaviorAddr = segmented_to_virtual(behavior);
-    struct ObjectNode *listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
-    struct Object *obj = (struct Object *) listHead->next;
     struct Object *closestObj = NULL;
     f32 minDist = 0x20000;
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    s32 objListIndex = get_object_list_from_behavior(behaviorAddr);
+    struct Object *obj = get_behavior_chain_head(behaviorAddr);
+
+    while (obj != NULL) {
+        if (obj->behavior == behaviorAddr
+            && obj->objListIndex == objListIndex
+#else
+    struct ObjectNode *listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
+    struct Object *obj = (struct Object *) listHead->next;
 
     while (obj != (struct Object *) listHead) {
         if (obj->behavior == behaviorAddr
+#endif
             && obj->activeFlags != ACTIVE_FLAG_DEACTIVATED
             && obj != o
         ) {
@@ -615,7 +625,11 @@ struct Object *cur_obj_find_nearest_object_with_behavior(const BehaviorScript *b
             }
         }
 
+#ifdef OBJECT_BEHAVIOR_CHAINS
+        obj = obj->behaviorChainNext;
+#else
         obj = (struct Object *) obj->header.next;
+#endif
     }
 
     *dist = minDist;
@@ -648,9 +662,21 @@ s32 count_unimportant_objects(void) {
 
 s32 count_objects_with_behavior(const BehaviorScript *behavior) {
     uintptr_t *behaviorAddr = segmented_to_virtual(behavior);
+    s32 count = 0;
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    s32 objListIndex = get_object_list_from_behavior(behaviorAddr);
+    struct Object *obj = get_behavior_chain_head(behaviorAddr);
+
+    while (obj != NULL) {
+        if (obj->behavior == behaviorAddr && obj->objListIndex == objListIndex) {
+            count++;
+        }
+
+        obj = obj->behaviorChainNext;
+    }
+#else
     struct ObjectNode *listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
     struct ObjectNode *obj = listHead->next;
-    s32 count = 0;
 
     while (listHead != obj) {
         if (((struct Object *) obj)->behavior == behaviorAddr) {
@@ -659,19 +685,29 @@ s32 count_objects_with_behavior(const BehaviorScript *behavior) {
 
         obj = obj->next;
     }
+#endif
 
     return count;
 }
 
 struct Object *cur_obj_find_nearby_held_actor(const BehaviorScript *behavior, f32 maxDist) {
     const BehaviorScript *behaviorAddr = segmented_to_virtual(behavior);
+    struct Object *foundObj = NULL;
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    struct Object *obj = get_behavior_chain_head(behaviorAddr);
+
+    while (obj != NULL) {
+        if (
+            obj->behavior == behaviorAddr
+            && obj->objListIndex == OBJ_LIST_GENACTOR
+#else
     struct ObjectNode *listHead = &gObjectLists[OBJ_LIST_GENACTOR];
     struct Object *obj = (struct Object *) listHead->next;
-    struct Object *foundObj = NULL;
 
     while ((struct Object *) listHead != obj) {
         if (
             obj->behavior == behaviorAddr
+#endif
             && obj->activeFlags != ACTIVE_FLAG_DEACTIVATED
             && obj->oHeldState != HELD_FREE
             && dist_between_objects(o, obj) < maxDist
@@ -682,7 +718,11 @@ struct Object *cur_obj_find_nearby_held_actor(const BehaviorScript *behavior, f3
             break;
         }
 
+#ifdef OBJECT_BEHAVIOR_CHAINS
+        obj = obj->behaviorChainNext;
+#else
         obj = (struct Object *) obj->header.next;
+#endif
     }
 
     return foundObj;
@@ -1174,11 +1214,11 @@ s32 obj_check_if_collided_with_object(struct Object *obj1, struct Object *obj2)
 }
 
 void cur_obj_set_behavior(const BehaviorScript *behavior) {
-    o->behavior = segmented_to_virtual(behavior);
+    set_object_behavior(o, segmented_to_virtual(behavior));
 }
 
 void obj_set_behavior(struct Object *obj, const BehaviorScript *behavior) {
-    obj->behavior = segmented_to_virtual(behavior);
+    set_object_behavior(obj, segmented_to_virtual(behavior));
 }
 
 s32 cur_obj_has_behavior(const BehaviorScript *behavior) {
@@ -1653,6 +1693,25 @@ void cur_obj_spawn_particles(struct SpawnParticlesInfo *info) {
     s32 i;
     f32 scale;
     s32 numParticles = info->count;
+#ifdef LIGHTWEIGHT_PARTICLES
+    s32 particleType = particle_type_from_model(info->model);
+
+    // Lightweight particles have their own pool, so they don't need to leave room for objects.
+    if (particleType != PARTICLE_TYPE_NONE) {
+        for (i = 0; i < numParticles; i++) {
+            scale = random_float() * (info->sizeRange * 0.1f) + info->sizeBase * 0.1f;
+            s16 yaw = random_u16();
+            f32 forwardVel = random_float() * info->forwardVelRange + info->forwardVelBase;
+            f32 velY = random_float() * info->velYRange + info->velYBase;
+
+            if (!spawn_lightweight_particle(particleType, o, info->offsetY, forwardVel, yaw, velY,
+                                            info->gravity, info->dragStrength, scale, info->behParam)) {
+                break;
+            }
+        }
+        return;
+    }
+#endif
 
     // If there are a lot of objects already, limit the number of particles
     if ((gPrevFrameObjectCount > (OBJECT_POOL_CAPACITY - 90)) && numParticles > 10) {
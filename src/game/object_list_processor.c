@@ -17,6 +17,7 @@
 #include "object_collision.h"
 #include "object_helpers.h"
 #include "object_list_processor.h"
+#include "particle_system.h"
 #include "platform_displacement.h"
 #include "spawn_object.h"
 #include "puppyprint.h"
@@ -533,6 +534,9 @@ void clear_objects(void) {
     gObjectLists = gObjectListArray;
 
     clear_dynamic_surfaces();
+#ifdef LIGHTWEIGHT_PARTICLES
+    clear_lightweight_particles();
+#endif
 }
 
 /**
@@ -668,6 +672,10 @@ void update_objects(UNUSED s32 unused) {
     // Unload any objects that have been deactivated
     unload_deactivated_objects();
 
+#ifdef LIGHTWEIGHT_PARTICLES
+    update_lightweight_particles();
+#endif
+
     // Check if Mario is on a platform object and save this object
     update_mario_platform();
 
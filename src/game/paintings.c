@@ -2,6 +2,7 @@
 
 #include "sm64.h"
 #include "area.h"
+#include "buffers/buffers.h"
 #include "engine/graph_node.h"
 #include "engine/surface_collision.h"
 #include "engine/math_util.h"
@@ -156,6 +157,33 @@ struct PaintingMeshVertex *gPaintingMesh;
  */
 Vec3f *gPaintingTriNorms;
 
+#ifdef PAINTING_CACHE
+/**
+ * Rippling paintings further than this from the camera only regenerate their mesh every
+ * PAINTING_RIPPLE_LOD_FRAMES frames. Measured to the painting's position, its bottom left corner.
+ */
+#define PAINTING_RIPPLE_LOD_DIST 3000.0f
+#define PAINTING_RIPPLE_LOD_FRAMES 2
+
+/**
+ * The painting and ripple gPaintingMesh was generated for. The mesh is kept between frames and only
+ * regenerated once the ripple changes.
+ */
+struct PaintingMeshCache {
+    struct Painting *painting;
+    f32 rippleTimer;
+    f32 currRippleMag;
+    f32 currRippleRate;
+    f32 dispersionFactor;
+    f32 rippleX;
+    f32 rippleY;
+    f32 size;
+    u8 framesSinceUpdate;
+};
+
+static struct PaintingMeshCache sPaintingMeshCache;
+#endif
+
 /**
  * The painting that is currently rippling. Only one painting can be rippling at once.
  */
@@ -680,7 +708,14 @@ s16 ripple_if_movable(struct Painting *painting, s16 movable, s16 posX, s16 posY
 void painting_generate_mesh(struct Painting *painting, s16 *mesh, s16 numTris) {
     s16 i;
 
+#ifdef PAINTING_CACHE
+    // The mesh is kept between frames, see painting_mesh_needs_update
+    if (gPaintingMesh == NULL) {
+        gPaintingMesh = mem_pool_alloc(gEffectsMemoryPool, numTris * sizeof(struct PaintingMeshVertex));
+    }
+#else
     gPaintingMesh = mem_pool_alloc(gEffectsMemoryPool, numTris * sizeof(struct PaintingMeshVertex));
+#endif
 
     // accesses are off by 1 since the first entry is the number of vertices
     for (i = 0; i < numTris; i++) {
@@ -893,6 +928,66 @@ Gfx *render_painting(u8 *img, s16 tWidth, s16 tHeight, s16 *textureMap, s16 mapV
     return dlist;
 }
 
+#ifdef PAINTING_CACHE
+/**
+ * Writes the transform that orients the painting mesh for rendering to mtx, and a display list that
+ * loads it to dlist.
+ */
+static void painting_build_transform(struct Painting *painting, Mtx *mtx, Gfx *dlist) {
+    f32 sizeRatio = painting->size / PAINTING_SIZE;
+    Mat4 scale, rotY, rotX, translate;
+    Mat4 scaleRotY, scaleRot, transform;
+
+    guScaleF(scale, sizeRatio, sizeRatio, sizeRatio);
+    guRotateF(rotY, painting->yaw, 0.0f, 1.0f, 0.0f);
+    guRotateF(rotX, painting->pitch, 1.0f, 0.0f, 0.0f);
+    guTranslateF(translate, painting->posX, painting->posY, painting->posZ);
+
+    // Same order as loading each matrix in turn: scale, then rotate about y and x, then translate
+    guMtxCatF(scale, rotY, scaleRotY);
+    guMtxCatF(scaleRotY, rotX, scaleRot);
+    guMtxCatF(scaleRot, translate, transform);
+    guMtxF2L(transform, mtx);
+
+    gSPMatrix(dlist++, mtx, G_MTX_MODELVIEW | G_MTX_MUL | G_MTX_PUSH);
+    gSPEndDisplayList(dlist);
+}
+
+/**
+ * Orient the painting mesh for rendering.
+ *
+ * The transform is kept in the painting once it has held still for GFX_NUM_POOLS frames. Until then it
+ * comes from the gfx pool, since the RCP may still be reading the cached one from an earlier frame.
+ */
+Gfx *painting_model_view_transform(struct Painting *painting) {
+    struct PaintingTransformCache *cache = &painting->transformCache;
+    Mtx *mtx;
+    Gfx *dlist;
+
+    if (cache->pos[0] != painting->posX || cache->pos[1] != painting->posY || cache->pos[2] != painting->posZ
+        || cache->pitch != painting->pitch || cache->yaw != painting->yaw || cache->size != painting->size) {
+        vec3f_set(cache->pos, painting->posX, painting->posY, painting->posZ);
+        cache->pitch = painting->pitch;
+        cache->yaw = painting->yaw;
+        cache->size = painting->size;
+        cache->framesStill = 0;
+    }
+
+    if (cache->framesStill >= GFX_NUM_POOLS) {
+        if (cache->framesStill == GFX_NUM_POOLS) {
+            painting_build_transform(painting, &cache->mtx, cache->dl);
+            cache->framesStill++;
+        }
+        return cache->dl;
+    }
+    cache->framesStill++;
+
+    mtx = alloc_display_list(sizeof(*mtx));
+    dlist = alloc_display_list(2 * sizeof(Gfx));
+    painting_build_transform(painting, mtx, dlist);
+    return dlist;
+}
+#else
 /**
  * Orient the painting mesh for rendering.
  */
@@ -918,6 +1013,7 @@ Gfx *painting_model_view_transform(struct Painting *painting) {
 
     return dlist;
 }
+#endif
 
 /**
  * Ripple a painting that has 1 or more images that need to be mapped
@@ -997,9 +1093,63 @@ Gfx *painting_ripple_env_mapped(struct Painting *painting) {
     return dlist;
 }
 
+#ifdef PAINTING_CACHE
+/**
+ * Returns whether gPaintingMesh has to be regenerated for the painting's current ripple, and remembers
+ * the ripple if so. A painting far from the camera keeps its mesh for PAINTING_RIPPLE_LOD_FRAMES frames
+ * even while it ripples.
+ */
+static s32 painting_mesh_needs_update(struct Painting *painting) {
+    struct PaintingMeshCache *cache = &sPaintingMeshCache;
+
+    if (gPaintingMesh != NULL && cache->painting == painting) {
+        if (cache->rippleTimer == painting->rippleTimer && cache->currRippleMag == painting->currRippleMag
+            && cache->currRippleRate == painting->currRippleRate
+            && cache->dispersionFactor == painting->dispersionFactor && cache->rippleX == painting->rippleX
+            && cache->rippleY == painting->rippleY && cache->size == painting->size) {
+            return FALSE;
+        }
+
+        if (++cache->framesSinceUpdate < PAINTING_RIPPLE_LOD_FRAMES && gCurGraphNodeCamera != NULL) {
+            f32 dx = gCurGraphNodeCamera->pos[0] - painting->posX;
+            f32 dy = gCurGraphNodeCamera->pos[1] - painting->posY;
+            f32 dz = gCurGraphNodeCamera->pos[2] - painting->posZ;
+
+            if (sqr(dx) + sqr(dy) + sqr(dz) > sqr(PAINTING_RIPPLE_LOD_DIST)) {
+                return FALSE;
+            }
+        }
+    }
+
+    cache->painting = painting;
+    cache->rippleTimer = painting->rippleTimer;
+    cache->currRippleMag = painting->currRippleMag;
+    cache->currRippleRate = painting->currRippleRate;
+    cache->dispersionFactor = painting->dispersionFactor;
+    cache->rippleX = painting->rippleX;
+    cache->rippleY = painting->rippleY;
+    cache->size = painting->size;
+    cache->framesSinceUpdate = 0;
+    return TRUE;
+}
+
+/**
+ * Frees gPaintingMesh if it belongs to the painting.
+ */
+static void painting_free_mesh(struct Painting *painting) {
+    if (gPaintingMesh != NULL && sPaintingMeshCache.painting == painting) {
+        mem_pool_free(gEffectsMemoryPool, gPaintingMesh);
+        gPaintingMesh = NULL;
+        sPaintingMeshCache.painting = NULL;
+    }
+}
+
+#endif
+
 /**
  * Generates a mesh, calculates vertex normals for lighting, and renders a rippling painting.
- * The mesh and vertex normals are regenerated and freed every frame.
+ * The mesh and vertex normals are regenerated and freed every frame, unless PAINTING_CACHE is on, which
+ * keeps the mesh until the painting stops rippling and only regenerates it when the ripple changes.
  */
 Gfx *display_painting_rippling(struct Painting *painting) {
     s16 *mesh = segmented_to_virtual(seg2_painting_triangle_mesh);
@@ -1008,10 +1158,20 @@ Gfx *display_painting_rippling(struct Painting *painting) {
     s16 numTris = mesh[numVtx * 3 + 1];
     Gfx *dlist = NULL;
 
+#ifdef PAINTING_CACHE
+    if (painting_mesh_needs_update(painting)) {
+        // Generate the mesh and its lighting data
+        painting_generate_mesh(painting, mesh, numVtx);
+        painting_calculate_triangle_normals(mesh, numVtx, numTris);
+        painting_average_vertex_normals(neighborTris, numVtx);
+        mem_pool_free(gEffectsMemoryPool, gPaintingTriNorms);
+    }
+#else
     // Generate the mesh and its lighting data
     painting_generate_mesh(painting, mesh, numVtx);
     painting_calculate_triangle_normals(mesh, numVtx, numTris);
     painting_average_vertex_normals(neighborTris, numVtx);
+#endif
 
     // Map the painting's texture depending on the painting's texture type.
     switch (painting->textureType) {
@@ -1023,9 +1183,11 @@ Gfx *display_painting_rippling(struct Painting *painting) {
             break;
     }
 
+#ifndef PAINTING_CACHE
     // The mesh data is freed every frame.
     mem_pool_free(gEffectsMemoryPool, gPaintingMesh);
     mem_pool_free(gEffectsMemoryPool, gPaintingTriNorms);
+#endif
     return dlist;
 }
 
@@ -1036,6 +1198,9 @@ Gfx *display_painting_not_rippling(struct Painting *painting) {
     Gfx *dlist = alloc_display_list(4 * sizeof(Gfx));
     Gfx *gfx = dlist;
 
+#ifdef PAINTING_CACHE
+    painting_free_mesh(painting);
+#endif
     if (dlist == NULL) {
         return dlist;
     }
@@ -1058,6 +1223,9 @@ void reset_painting(struct Painting *painting) {
     painting->marioWentUnder = 0;
 
     gRipplingPainting = NULL;
+#ifdef PAINTING_CACHE
+    painting_free_mesh(painting);
+#endif
 
 #ifdef NO_SEGMENTED_MEMORY
     // Make sure all variables are reset correctly.
@@ -41,6 +41,23 @@ enum PaintingType {
     PAINTING_ENV_MAP
 };
 
+#ifdef PAINTING_CACHE
+/**
+ * A painting's model view transform, kept across frames while the painting doesn't move.
+ */
+struct PaintingTransformCache {
+    Mtx mtx;
+    Gfx dl[2];
+    /// The position, rotation and size the transform was built for
+    Vec3f pos;
+    f32 pitch;
+    f32 yaw;
+    f32 size;
+    /// How many frames the painting has held still, see painting_model_view_transform
+    u8 framesStill;
+};
+#endif
+
 struct Painting {
     s16 id;
     /// How many images should be drawn when the painting is rippling.
@@ -123,6 +140,11 @@ struct Painting {
     /// Uniformly scales the painting to a multiple of PAINTING_SIZE.
     /// By default a painting is 614.0 x 614.0
     f32 size;
+
+#ifdef PAINTING_CACHE
+    /// Left zeroed in level data, filled in when the painting is drawn.
+    struct PaintingTransformCache transformCache;
+#endif
 };
 
 /**
@@ -0,0 +1,255 @@
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "area.h"
+#include "engine/math_util.h"
+#include "memory.h"
+#include "object_fields.h"
+#include "particle_system.h"
+#include "rendering_graph_node.h"
+#include "actors/common1.h"
+#include "actors/group0.h"
+
+#ifdef LIGHTWEIGHT_PARTICLES
+
+/**
+ * A lightweight replacement for short lived effects like puffs, mist and dust that used to take a full
+ * object slot each. Particles have no behavior script or graph node, they're updated in one pass after
+ * the objects and drawn with one display list per particle type.
+ */
+
+struct ParticlePool gParticlePool;
+
+static const struct ParticleType sParticleTypes[PARTICLE_TYPE_COUNT] = {
+    [PARTICLE_TYPE_MIST]                 = { MODEL_MIST,                 LAYER_TRANSPARENT,              TRUE,  mist_seg3_dl_03000880 },
+    [PARTICLE_TYPE_SAND_DUST]            = { MODEL_SAND_DUST,            LAYER_OCCLUDE_SILHOUETTE_ALPHA, FALSE, sand_seg3_dl_particle },
+    [PARTICLE_TYPE_WHITE_PARTICLE]       = { MODEL_WHITE_PARTICLE_DL,    LAYER_OCCLUDE_SILHOUETTE_ALPHA, FALSE, white_particle_dl     },
+    [PARTICLE_TYPE_WHITE_PARTICLE_SMALL] = { MODEL_WHITE_PARTICLE_SMALL, LAYER_OCCLUDE_SILHOUETTE_ALPHA, FALSE, white_particle_small_dl },
+};
+
+// Same lifetime as bhvWhitePuffExplosion.
+#define PARTICLE_LIFETIME 20
+
+/**
+ * Return which particle type draws the same thing as this model, or PARTICLE_TYPE_NONE if the effect
+ * still has to be spawned as an object.
+ */
+s32 particle_type_from_model(ModelID32 model) {
+    s32 i;
+
+    for (i = 0; i < PARTICLE_TYPE_COUNT; i++) {
+        if (sParticleTypes[i].model == model) {
+            // The display list is only safe to use if the segment holding it is loaded.
+            return (gLoadedGraphNodes[model] != NULL) ? i : PARTICLE_TYPE_NONE;
+        }
+    }
+
+    return PARTICLE_TYPE_NONE;
+}
+
+/**
+ * Spawn a particle that acts like a bhvWhitePuffExplosion object spawned from parent.
+ * behParam picks the fade, same as oBehParams2ndByte for the object.
+ * Return FALSE if the particle pool is full, in which case the particle is dropped.
+ */
+s32 spawn_lightweight_particle(s32 type, struct Object *parent, f32 offsetY, f32 forwardVel, s16 yaw, f32 velY,
+                               f32 gravity, f32 drag, f32 scale, s32 behParam) {
+    struct ParticlePool *pool = &gParticlePool;
+    u32 i = pool->count;
+
+    if (i >= PARTICLE_POOL_CAPACITY) {
+        return FALSE;
+    }
+
+    pool->posX[i] = parent->oPosX;
+    pool->posY[i] = parent->oPosY + offsetY;
+    pool->posZ[i] = parent->oPosZ;
+    pool->velX[i] = forwardVel * sins(yaw);
+    pool->velY[i] = velY;
+    pool->velZ[i] = forwardVel * coss(yaw);
+    pool->gravity[i] = gravity;
+    pool->drag[i] = drag * 0.0001f;
+    pool->baseScale[i] = scale;
+    pool->scale[i] = scale;
+    pool->timer[i] = 0;
+    pool->type[i] = type;
+    pool->areaIndex[i] = parent->header.gfx.areaIndex;
+
+    switch (behParam) {
+        case 2:
+            pool->opacity[i] = 254;
+            pool->opacityDiff[i] = -21;
+            pool->slowFade[i] = FALSE;
+            break;
+        case 3:
+            pool->opacity[i] = 254;
+            pool->opacityDiff[i] = -13;
+            pool->slowFade[i] = TRUE;
+            break;
+        default:
+            pool->opacity[i] = 0;
+            pool->opacityDiff[i] = 0;
+            pool->slowFade[i] = FALSE;
+            break;
+    }
+
+    pool->count++;
+    return TRUE;
+}
+
+void clear_lightweight_particles(void) {
+    gParticlePool.count = 0;
+}
+
+/**
+ * Move the last particle into slot i, keeping the live particles packed.
+ */
+static void remove_particle(struct ParticlePool *pool, u32 i) {
+    u32 last = --pool->count;
+
+    pool->posX[i] = pool->posX[last];
+    pool->posY[i] = pool->posY[last];
+    pool->posZ[i] = pool->posZ[last];
+    pool->velX[i] = pool->velX[last];
+    pool->velY[i] = pool->velY[last];
+    pool->velZ[i] = pool->velZ[last];
+    pool->gravity[i] = pool->gravity[last];
+    pool->drag[i] = pool->drag[last];
+    pool->baseScale[i] = pool->baseScale[last];
+    pool->scale[i] = pool->scale[last];
+    pool->timer[i] = pool->timer[last];
+    pool->opacity[i] = pool->opacity[last];
+    pool->opacityDiff[i] = pool->opacityDiff[last];
+    pool->slowFade[i] = pool->slowFade[last];
+    pool->type[i] = pool->type[last];
+    pool->areaIndex[i] = pool->areaIndex[last];
+}
+
+// Same as apply_drag_to_value, with the strength already scaled.
+static f32 apply_particle_drag(f32 value, f32 drag) {
+    if (value > 0.0f) {
+        value -= sqr(value) * drag;
+        if (value < 0.001f) {
+            value = 0.0f;
+        }
+    } else if (value < 0.0f) {
+        value += sqr(value) * drag;
+        if (value > -0.001f) {
+            value = 0.0f;
+        }
+    }
+    return value;
+}
+
+/**
+ * Step every particle once. Called after the objects have updated, so it's skipped while paused.
+ */
+void update_lightweight_particles(void) {
+    struct ParticlePool *pool = &gParticlePool;
+    u32 i;
+
+    // Integrate everything first, this loop only touches the position and velocity arrays.
+    for (i = 0; i < pool->count; i++) {
+        pool->velY[i] += pool->gravity[i];
+        pool->posX[i] += pool->velX[i];
+        pool->posY[i] += pool->velY[i];
+        pool->posZ[i] += pool->velZ[i];
+        pool->velX[i] = apply_particle_drag(pool->velX[i], pool->drag[i]);
+        pool->velZ[i] = apply_particle_drag(pool->velZ[i], pool->drag[i]);
+        if (pool->velY[i] > 100.0f) {
+            pool->velY[i] = 100.0f;
+        }
+    }
+
+    // Then age and fade them, removing the ones that are done. Walk backwards so a removal
+    // only ever pulls in a particle that has already been processed.
+    i = pool->count;
+    while (i-- > 0) {
+        if (pool->timer[i]++ > PARTICLE_LIFETIME) {
+            remove_particle(pool, i);
+            continue;
+        }
+
+        if (pool->opacity[i] != 0) {
+            pool->opacity[i] += pool->opacityDiff[i];
+            if (pool->opacity[i] < 2) {
+                remove_particle(pool, i);
+                continue;
+            }
+            if (pool->slowFade[i]) {
+                pool->scale[i] = pool->baseScale[i] * ((254 - pool->opacity[i]) / 254.0f);
+            } else {
+                pool->scale[i] = pool->baseScale[i] * (pool->opacity[i] / 254.0f);
+            }
+        }
+    }
+}
+
+/**
+ * Draw the particles in this area. Each particle type gets one display list, which loads a billboard
+ * matrix per particle and calls the shared model display list.
+ */
+void render_lightweight_particles(Mat4 cameraMtx, s16 roll, s32 areaIndex) {
+    struct ParticlePool *pool = &gParticlePool;
+    u32 typeCounts[PARTICLE_TYPE_COUNT] = { 0 };
+    Gfx *typeHeads[PARTICLE_TYPE_COUNT];
+    Gfx *typeStarts[PARTICLE_TYPE_COUNT];
+    Mat4 mtxf;
+    Vec3f pos, scale;
+    s32 type;
+    u32 i;
+
+    for (i = 0; i < pool->count; i++) {
+        if (pool->areaIndex[i] == areaIndex) {
+            typeCounts[pool->type[i]]++;
+        }
+    }
+
+    for (type = 0; type < PARTICLE_TYPE_COUNT; type++) {
+        typeStarts[type] = NULL;
+        if (typeCounts[type] != 0) {
+            typeStarts[type] = alloc_display_list((typeCounts[type] * 3 + 1) * sizeof(Gfx));
+            if (typeStarts[type] == NULL) {
+                return;
+            }
+        }
+        typeHeads[type] = typeStarts[type];
+    }
+
+    for (i = 0; i < pool->count; i++) {
+        if (pool->areaIndex[i] != areaIndex) {
+            continue;
+        }
+
+        vec3f_set(pos, pool->posX[i], pool->posY[i], pool->posZ[i]);
+        vec3_same(scale, pool->scale[i]);
+        mtxf_billboard(mtxf, cameraMtx, pos, scale, roll);
+
+        // Skip particles behind the camera, which looks down -Z in view space.
+        if (mtxf[3][2] > 0.0f) {
+            continue;
+        }
+
+        Mtx *mtx = alloc_display_list(sizeof(Mtx));
+        if (mtx == NULL) {
+            break;
+        }
+        mtxf_to_mtx(mtx, mtxf);
+
+        type = pool->type[i];
+        gSPMatrix(typeHeads[type]++, VIRTUAL_TO_PHYSICAL(mtx), (G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH));
+        if (sParticleTypes[type].useOpacity) {
+            gDPSetEnvColor(typeHeads[type]++, 255, 255, 255, pool->opacity[i]);
+        }
+        gSPDisplayList(typeHeads[type]++, sParticleTypes[type].displayList);
+    }
+
+    for (type = 0; type < PARTICLE_TYPE_COUNT; type++) {
+        if (typeStarts[type] != NULL && typeHeads[type] != typeStarts[type]) {
+            gSPEndDisplayList(typeHeads[type]);
+            geo_append_display_list(typeStarts[type], sParticleTypes[type].layer);
+        }
+    }
+}
+
+#endif // LIGHTWEIGHT_PARTICLES
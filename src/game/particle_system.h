@@ -0,0 +1,66 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#include "config.h"
+#include "types.h"
+
+#ifdef LIGHTWEIGHT_PARTICLES
+
+// How many lightweight particles can exist at once. This pool is separate from the object pool.
+#define PARTICLE_POOL_CAPACITY 128
+
+enum ParticleTypes {
+    PARTICLE_TYPE_NONE = -1,
+    PARTICLE_TYPE_MIST,
+    PARTICLE_TYPE_SAND_DUST,
+    PARTICLE_TYPE_WHITE_PARTICLE,
+    PARTICLE_TYPE_WHITE_PARTICLE_SMALL,
+    PARTICLE_TYPE_COUNT
+};
+
+struct ParticleType {
+    /*0x00*/ ModelID16 model; // The model the object version of this effect used.
+    /*0x02*/ u8 layer;
+    /*0x03*/ u8 useOpacity;   // The display list takes its alpha from the env color, like geo_update_layer_transparency.
+    /*0x04*/ const Gfx *displayList;
+};
+
+/**
+ * Every particle is split across these arrays, so the update loop only streams through what it needs.
+ * Particles are kept packed in [0, count), removing one moves the last particle into its slot.
+ */
+struct ParticlePool {
+    f32 posX[PARTICLE_POOL_CAPACITY];
+    f32 posY[PARTICLE_POOL_CAPACITY];
+    f32 posZ[PARTICLE_POOL_CAPACITY];
+    f32 velX[PARTICLE_POOL_CAPACITY];
+    f32 velY[PARTICLE_POOL_CAPACITY];
+    f32 velZ[PARTICLE_POOL_CAPACITY];
+    f32 gravity[PARTICLE_POOL_CAPACITY];
+    f32 drag[PARTICLE_POOL_CAPACITY];
+    f32 baseScale[PARTICLE_POOL_CAPACITY];
+    f32 scale[PARTICLE_POOL_CAPACITY];
+    s16 timer[PARTICLE_POOL_CAPACITY];
+    s16 opacity[PARTICLE_POOL_CAPACITY];
+    s8 opacityDiff[PARTICLE_POOL_CAPACITY];
+    u8 slowFade[PARTICLE_POOL_CAPACITY];
+    u8 type[PARTICLE_POOL_CAPACITY];
+    s8 areaIndex[PARTICLE_POOL_CAPACITY];
+    u32 count;
+};
+
+extern struct ParticlePool gParticlePool;
+
+s32 particle_type_from_model(ModelID32 model);
+s32 spawn_lightweight_particle(s32 type, struct Object *parent, f32 offsetY, f32 forwardVel, s16 yaw, f32 velY,
+                               f32 gravity, f32 drag, f32 scale, s32 behParam);
+void clear_lightweight_particles(void);
+void update_lightweight_particles(void);
+void render_lightweight_particles(Mat4 cameraMtx, s16 roll, s32 areaIndex);
+
+#endif // LIGHTWEIGHT_PARTICLES
+
+#endif // PARTICLE_SYSTEM_H
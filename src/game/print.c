@@ -5,6 +5,7 @@
 #include "memory.h"
 #include "print.h"
 #include "segment2.h"
+#include "buffers/buffers.h"
 
 /**
  * This file handles printing and formatting the colorful text that
@@ -25,6 +26,38 @@ struct TextLabel {
 struct TextLabel *sTextLabels[52];
 s16 sTextLabelsCount = 0;
 
+#ifdef HUD_DL_CACHE
+#define TEXT_LABEL_CACHE_SLOTS  16
+#define TEXT_LABEL_CACHE_LENGTH 6
+
+// A glyph is a texture load and a texture rectangle, EU draws its Ü as two glyphs
+#ifdef VERSION_EU
+#define TEXT_LABEL_GLYPH_GFX 12
+#else
+#define TEXT_LABEL_GLYPH_GFX 6
+#endif
+
+/**
+ * The display list of a short text label, kept across frames for as long as the same text is
+ * printed at the same place. HUD counters only change a few times a minute, so their labels
+ * are almost never rebuilt.
+ *
+ * There is one set per gfx pool, since the RCP may still be drawing the frame built with the previous one.
+ */
+struct TextLabelCache {
+    Gfx dl[TEXT_LABEL_CACHE_LENGTH * TEXT_LABEL_GLYPH_GFX + 1];
+    u32 x;
+    u32 y;
+    s16 length;
+    char buffer[TEXT_LABEL_CACHE_LENGTH];
+    /// The frame the slot was last drawn on, 0 if it is empty
+    u32 lastUsed;
+};
+
+static struct TextLabelCache sTextLabelCache[GFX_NUM_POOLS][TEXT_LABEL_CACHE_SLOTS];
+static u32 sTextLabelFrame = 0;
+#endif
+
 /**
  * Returns n to the exponent power, only for non-negative powers.
  */
@@ -362,12 +395,16 @@ s32 char_to_glyph_index(char c) {
 /**
  * Adds an individual glyph to be rendered.
  */
-void add_glyph_texture(s8 glyphIndex) {
+static void add_glyph_texture_to(Gfx **dlist, s8 glyphIndex) {
     const Texture *const *glyphs = segmented_to_virtual(main_hud_lut);
 
-    gDPPipeSync(gDisplayListHead++);
-    gDPSetTextureImage(gDisplayListHead++, G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, glyphs[glyphIndex]);
-    gSPDisplayList(gDisplayListHead++, dl_hud_img_load_tex_block);
+    gDPPipeSync((*dlist)++);
+    gDPSetTextureImage((*dlist)++, G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, glyphs[glyphIndex]);
+    gSPDisplayList((*dlist)++, dl_hud_img_load_tex_block);
+}
+
+void add_glyph_texture(s8 glyphIndex) {
+    add_glyph_texture_to(&gDisplayListHead, glyphIndex);
 }
 
 #ifndef WIDESCREEN
@@ -396,7 +433,7 @@ void clip_to_bounds(s32 *x, s32 *y) {
 /**
  * Renders the glyph that's set at the given position.
  */
-void render_textrect(s32 x, s32 y, s32 pos) {
+static void render_textrect_to(Gfx **dlist, s32 x, s32 y, s32 pos) {
     s32 rectBaseX = x + pos * 12;
     s32 rectBaseY = 224 - y;
     s32 rectX;
@@ -408,19 +445,118 @@ void render_textrect(s32 x, s32 y, s32 pos) {
 #endif
     rectX = rectBaseX;
     rectY = rectBaseY;
-    gSPTextureRectangle(gDisplayListHead++, rectX << 2, rectY << 2, (rectX + 15) << 2,
+    gSPTextureRectangle((*dlist)++, rectX << 2, rectY << 2, (rectX + 15) << 2,
                         (rectY + 15) << 2, G_TX_RENDERTILE, 0, 0, 4 << 10, 1 << 10);
 }
 
+void render_textrect(s32 x, s32 y, s32 pos) {
+    render_textrect_to(&gDisplayListHead, x, y, pos);
+}
+
+/**
+ * Renders every glyph of a text label.
+ */
+static void render_text_label(Gfx **dlist, struct TextLabel *label) {
+    s32 j;
+    s8 glyphIndex;
+
+    for (j = 0; j < label->length; j++) {
+        glyphIndex = char_to_glyph_index(label->buffer[j]);
+
+        if (glyphIndex != GLYPH_SPACE) {
+#ifdef VERSION_EU
+            // Beta Key was removed by EU, so glyph slot reused.
+            // This produces a colorful Ü.
+            if (glyphIndex == GLYPH_BETA_KEY) {
+                add_glyph_texture_to(dlist, GLYPH_U);
+                render_textrect_to(dlist, label->x, label->y, j);
+
+                add_glyph_texture_to(dlist, GLYPH_UMLAUT);
+                render_textrect_to(dlist, label->x, label->y + 3, j);
+            } else {
+                add_glyph_texture_to(dlist, glyphIndex);
+                render_textrect_to(dlist, label->x, label->y, j);
+            }
+#else
+            add_glyph_texture_to(dlist, glyphIndex);
+            render_textrect_to(dlist, label->x, label->y, j);
+#endif
+        }
+    }
+}
+
+#ifdef HUD_DL_CACHE
+static s32 text_label_cache_matches(struct TextLabelCache *slot, struct TextLabel *label) {
+    s32 i;
+
+    if (slot->lastUsed == 0 || slot->x != label->x || slot->y != label->y || slot->length != label->length) {
+        return FALSE;
+    }
+
+    for (i = 0; i < label->length; i++) {
+        if (slot->buffer[i] != label->buffer[i]) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Returns this gfx pool's cached display list for the label, building it in the slot that has gone
+ * unused the longest if the label isn't cached yet. Returns NULL if the label is too long to cache
+ * or every slot is already drawn this frame.
+ */
+static Gfx *get_cached_text_label(struct TextLabel *label) {
+    struct TextLabelCache *slots = sTextLabelCache[gGfxPool - gGfxPools];
+    struct TextLabelCache *slot = NULL;
+    Gfx *dlHead;
+    s32 i;
+
+    if (label->length > TEXT_LABEL_CACHE_LENGTH) {
+        return NULL;
+    }
+
+    for (i = 0; i < TEXT_LABEL_CACHE_SLOTS; i++) {
+        if (text_label_cache_matches(&slots[i], label)) {
+            slots[i].lastUsed = sTextLabelFrame;
+            return slots[i].dl;
+        }
+
+        // An earlier label this frame may be drawing the slot's display list
+        if (slots[i].lastUsed != sTextLabelFrame && (slot == NULL || slots[i].lastUsed < slot->lastUsed)) {
+            slot = &slots[i];
+        }
+    }
+
+    if (slot == NULL) {
+        return NULL;
+    }
+
+    dlHead = slot->dl;
+    render_text_label(&dlHead, label);
+    gSPEndDisplayList(dlHead++);
+
+    slot->x = label->x;
+    slot->y = label->y;
+    slot->length = label->length;
+    bcopy(label->buffer, slot->buffer, label->length);
+    slot->lastUsed = sTextLabelFrame;
+
+    return slot->dl;
+}
+#endif
+
 /**
  * Renders the text in sTextLabels on screen at the proper locations by iterating
  * a for loop.
  */
 void render_text_labels(void) {
     s32 i;
-    s32 j;
-    s8 glyphIndex;
     Mtx *mtx;
+#ifdef HUD_DL_CACHE
+    Gfx *labelDL;
+#endif
 
     if (sTextLabelsCount == 0) {
         return;
@@ -438,30 +574,20 @@ void render_text_labels(void) {
     gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(mtx), G_MTX_PROJECTION | G_MTX_LOAD | G_MTX_NOPUSH);
     gSPDisplayList(gDisplayListHead++, dl_hud_img_begin);
 
-    for (i = 0; i < sTextLabelsCount; i++) {
-        for (j = 0; j < sTextLabels[i]->length; j++) {
-            glyphIndex = char_to_glyph_index(sTextLabels[i]->buffer[j]);
+#ifdef HUD_DL_CACHE
+    sTextLabelFrame++;
+#endif
 
-            if (glyphIndex != GLYPH_SPACE) {
-#ifdef VERSION_EU
-                // Beta Key was removed by EU, so glyph slot reused.
-                // This produces a colorful Ü.
-                if (glyphIndex == GLYPH_BETA_KEY) {
-                    add_glyph_texture(GLYPH_U);
-                    render_textrect(sTextLabels[i]->x, sTextLabels[i]->y, j);
-
-                    add_glyph_texture(GLYPH_UMLAUT);
-                    render_textrect(sTextLabels[i]->x, sTextLabels[i]->y + 3, j);
-                } else {
-                    add_glyph_texture(glyphIndex);
-                    render_textrect(sTextLabels[i]->x, sTextLabels[i]->y, j);
-                }
+    for (i = 0; i < sTextLabelsCount; i++) {
+#ifdef HUD_DL_CACHE
+        if ((labelDL = get_cached_text_label(sTextLabels[i])) != NULL) {
+            gSPDisplayList(gDisplayListHead++, labelDL);
+        } else {
+            render_text_label(&gDisplayListHead, sTextLabels[i]);
+        }
 #else
-                add_glyph_texture(glyphIndex);
-                render_textrect(sTextLabels[i]->x, sTextLabels[i]->y, j);
+        render_text_label(&gDisplayListHead, sTextLabels[i]);
 #endif
-            }
-        }
 
         mem_pool_free(gEffectsMemoryPool, sTextLabels[i]);
     }
@@ -229,6 +229,34 @@ u32 profiler_get_rdp_microseconds() {
     return RDP_CYCLE_CONV(rdp_max_cycles / PROFILING_BUFFER_SIZE);
 }
 
+#ifdef LAG_FRAME_RECORDER
+static int profiler_previous_index(int index) {
+    return ((index == 0) ? PROFILING_BUFFER_SIZE : index) - 1;
+}
+
+/**
+ * Copies the most recent raw value of every profiler bucket into times.
+ * The RSP and audio buckets run on their own indices, so take the last one they completed.
+ */
+void profiler_get_latest_times(u32 times[PROFILER_TIME_COUNT]) {
+    int audio_index = profiler_previous_index(audio_buffer_index);
+
+    for (int i = 0; i < PROFILER_TIME_COUNT; i++) {
+        times[i] = all_profiling_data[i].counts[profile_buffer_index];
+    }
+
+    times[PROFILER_TIME_AUDIO] = all_profiling_data[PROFILER_TIME_AUDIO].counts[audio_index];
+#ifdef AUDIO_PROFILING
+    for (int i = PROFILER_TIME_SUB_AUDIO_START; i < PROFILER_TIME_SUB_AUDIO_END; i++) {
+        times[i] = all_profiling_data[i].counts[audio_index];
+    }
+#endif
+    for (int i = 0; i < PROFILER_RSP_COUNT; i++) {
+        times[PROFILER_TIME_RSP_GFX + i] = all_profiling_data[PROFILER_TIME_RSP_GFX + i].counts[profiler_previous_index(rsp_buffer_indices[i])];
+    }
+}
+#endif
+
 void profiler_print_times() {
     u32 microseconds[PROFILER_TIME_COUNT];
     char text_buffer[196];
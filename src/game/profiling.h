@@ -110,6 +110,9 @@ u32 profiler_get_delta(enum ProfilerDeltaTime which);
 u32 profiler_get_cpu_microseconds();
 u32 profiler_get_rsp_microseconds();
 u32 profiler_get_rdp_microseconds();
+#ifdef LAG_FRAME_RECORDER
+void profiler_get_latest_times(u32 times[PROFILER_TIME_COUNT]);
+#endif
 // See profiling.c to see why profiler_rsp_yielded isn't its own function
 static ALWAYS_INLINE void profiler_rsp_yielded() {
     profiler_rsp_resumed();
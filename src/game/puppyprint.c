@@ -50,6 +50,7 @@ a modern game engine's developer's console.
 #include "color_presets.h"
 #include "buffers/buffers.h"
 #include "profiling.h"
+#include "lag_recorder.h"
 #include "segment_symbols.h"
 
 #ifdef PUPPYPRINT
@@ -232,9 +233,39 @@ void set_segment_memory_printout(u32 segment, u32 amount) {
     ramsizeSegment[segment + nameTable - 2] = amount;
 }
 
+#ifdef GENERAL_HEAP
+#define HEAP_BAR_X1 24
+#define HEAP_BAR_X2 (SCREEN_WIDTH - 24)
+#define HEAP_BAR_Y  64
+
+static u32 sHeapBarTotal;
+
+// Draws one heap block as a slice of the bar. Used blocks are red, free blocks are green.
+static void render_heap_block(u32 offset, u32 size, s32 isFree) {
+    f32 scale = (f32) (HEAP_BAR_X2 - HEAP_BAR_X1) / (f32) sHeapBarTotal;
+    s32 x1 = HEAP_BAR_X1 + (s32) (offset * scale);
+    s32 x2 = HEAP_BAR_X1 + (s32) ((offset + size) * scale);
+    s32 y = HEAP_BAR_Y - gPPSegScroll;
+
+    if (x2 <= x1) {
+        x2 = x1 + 1;
+    }
+    if (isFree) {
+        render_blank_box(x1, y, x2, y + 6, 0, 160, 0, 255);
+    } else {
+        render_blank_box(x1, y, x2, y + 6, 192, 0, 0, 255);
+    }
+}
+#endif
+
 void print_ram_overview(void) {
     char textBytes[64];
+#ifdef GENERAL_HEAP
+    // Leave room for the heap row and bar
+    s32 y = 80;
+#else
     s32 y = 56;
+#endif
     f32 ramSize = RAM_END - 0x80000000;
     s32 tempNums[32];
     u8 tempPos[32] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31};
@@ -265,6 +296,26 @@ void print_ram_overview(void) {
     print_small_text_light(SCREEN_WIDTH/2, 40 - gPPSegScroll, textBytes, PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_DEFAULT);
     sprintf(textBytes, "(%2.3f%%)", (((f32)(main_pool_available() - 0x400) / (f32)(RAM_END - 0x80000000)) * 100));
     print_small_text_light(SCREEN_WIDTH - 24, 40 - gPPSegScroll, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_DEFAULT);
+#ifdef GENERAL_HEAP
+    if (gGeneralHeap != NULL) {
+        struct HeapStats stats;
+        heap_pool_get_stats(gGeneralHeap, &stats);
+        // Fragmentation is how much of the free space can't be handed out in one allocation.
+        f32 frag = (stats.freeSpace != 0) ? (100.0f - (((f32) stats.largestFree / (f32) stats.freeSpace) * 100.0f)) : 0.0f;
+        sprintf(textBytes, "Heap:");
+        print_small_text_light(24, 52 - gPPSegScroll, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_DEFAULT);
+        sprintf(textBytes, "0x%X/0x%X", stats.usedSpace, stats.totalSpace);
+        print_small_text_light(SCREEN_WIDTH/2, 52 - gPPSegScroll, textBytes, PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_DEFAULT);
+        sprintf(textBytes, "Frag: %2.1f%%", frag);
+        print_small_text_light(SCREEN_WIDTH - 24, 52 - gPPSegScroll, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_DEFAULT);
+        if (HEAP_BAR_Y - gPPSegScroll > 0 && HEAP_BAR_Y - gPPSegScroll < SCREEN_HEIGHT) {
+            sHeapBarTotal = stats.totalSpace;
+            prepare_blank_box();
+            heap_pool_walk(gGeneralHeap, &render_heap_block);
+            finish_blank_box();
+        }
+    }
+#endif
     for (u8 i = 0; i < NUM_TLB_SEGMENTS; i++) {
         if (tempNums[i] == 0) {
             continue;
@@ -1032,6 +1083,9 @@ struct PuppyPrintPage ppPages[] = {
 #ifdef USE_PROFILER
     [PUPPYPRINT_PAGE_PROFILER]      = {&puppyprint_render_standard,     "Profiler"},
     [PUPPYPRINT_PAGE_MINIMAL]       = {&puppyprint_render_minimal,      "Minimal"},
+#endif
+#ifdef LAG_FRAME_RECORDER
+    [PUPPYPRINT_PAGE_LAG_FRAMES]    = {&lag_recorder_render_page,       "Lag Frames"},
 #endif
     [PUPPYPRINT_PAGE_GENERAL]       = {&puppyprint_render_general_vars, "General"},
     [PUPPYPRINT_PAGE_AUDIO]         = {&print_audio_overview,           "Audio"},
@@ -1185,6 +1239,11 @@ void puppyprint_profiler_process(void) {
             if (viewCycle == 255)
                 viewCycle = 3;
         }
+#endif
+#ifdef LAG_FRAME_RECORDER
+        if (sPPDebugPage == PUPPYPRINT_PAGE_LAG_FRAMES) {
+            lag_recorder_page_input();
+        }
 #endif
         if (sPPDebugPage == PUPPYPRINT_PAGE_RAM) {
             if (gPlayer1Controller->buttonDown & U_JPAD && gPPSegScroll > 0)  {
@@ -87,6 +87,9 @@ enum PPPages {
 #ifdef USE_PROFILER
     PUPPYPRINT_PAGE_PROFILER,
     PUPPYPRINT_PAGE_MINIMAL,
+#endif
+#ifdef LAG_FRAME_RECORDER
+    PUPPYPRINT_PAGE_LAG_FRAMES,
 #endif
     PUPPYPRINT_PAGE_GENERAL,
     PUPPYPRINT_PAGE_AUDIO,
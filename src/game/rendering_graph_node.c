@@ -18,6 +18,7 @@
 #include "string.h"
 #include "color_presets.h"
 #include "emutest.h"
+#include "particle_system.h"
 
 #include "config.h"
 #include "config/config_world.h"
@@ -348,7 +349,7 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
  * render modes of layers.
  */
 void geo_append_display_list(void *displayList, s32 layer) {
-#ifdef F3DEX_GBI_2
+#if defined(F3DEX_GBI_2) && !defined(BILLBOARD_INSTANCING)
     gSPLookAt(gDisplayListHead++, gCurLookAt);
 #endif
 #if SILHOUETTE
@@ -390,6 +391,55 @@ static void inc_mat_stack() {
     gMatStackFixed[gMatStackIndex] = mtx;
 }
 
+#ifdef BILLBOARD_INSTANCING
+#define BILLBOARD_INSTANCE_SCALES 4
+
+/**
+ * Every billboard drawn by the same camera gets the same rotation, so billboards with the same
+ * scale only differ in their translation. The fixed point matrix of the last few scales is kept
+ * here and copied for each instance, which then only needs its translation converted.
+ */
+struct BillboardInstance {
+    Mtx mtx;
+    Vec3f scale;
+};
+
+static struct BillboardInstance sBillboardInstances[BILLBOARD_INSTANCE_SCALES];
+static s32 sNumBillboardInstances = 0;
+static s32 sNextBillboardInstance = 0;
+
+/**
+ * Like inc_mat_stack, for a matrix made by mtxf_billboard with the given scale.
+ */
+static void inc_mat_stack_billboard(Vec3f scale) {
+    Mtx *mtx = alloc_display_list(sizeof(*mtx));
+    struct BillboardInstance *instance;
+    s32 i;
+
+    gMatStackIndex++;
+    gMatStackFixed[gMatStackIndex] = mtx;
+
+    for (i = 0; i < sNumBillboardInstances; i++) {
+        instance = &sBillboardInstances[i];
+        if (instance->scale[0] == scale[0] && instance->scale[1] == scale[1] && instance->scale[2] == scale[2]) {
+            *mtx = instance->mtx;
+            mtxf_to_mtx_translation_fast((s16 *) mtx, (f32 *) gMatStack[gMatStackIndex]);
+            return;
+        }
+    }
+
+    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+
+    instance = &sBillboardInstances[sNextBillboardInstance];
+    instance->mtx = *mtx;
+    vec3f_copy(instance->scale, scale);
+    sNextBillboardInstance = (sNextBillboardInstance + 1) % BILLBOARD_INSTANCE_SCALES;
+    if (sNumBillboardInstances < BILLBOARD_INSTANCE_SCALES) {
+        sNumBillboardInstances++;
+    }
+}
+#endif
+
 static void append_dl_and_return(struct GraphNodeDisplayList *node) {
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, GET_GRAPH_NODE_LAYER(node->node.flags));
@@ -588,7 +638,14 @@ void geo_process_camera(struct GraphNodeCamera *node) {
     gCurLookAt->l[1].l.dir[0] = (s8)(127.0f * -(*cameraMatrix)[0][1]);
     gCurLookAt->l[1].l.dir[1] = (s8)(127.0f * -(*cameraMatrix)[1][1]);
     gCurLookAt->l[1].l.dir[2] = (s8)(127.0f * -(*cameraMatrix)[2][1]);
+#ifdef BILLBOARD_INSTANCING
+    // Every display list uses the same LookAt, and they are all drawn after this
+    gSPLookAt(gDisplayListHead++, gCurLookAt);
+#endif
 #endif // F3DEX_GBI_2
+#ifdef BILLBOARD_INSTANCING
+    sNumBillboardInstances = 0;
+#endif
 
 #if WORLD_SCALE > 1
     // Make a copy of the view matrix and scale its translation based on WORLD_SCALE
@@ -692,7 +749,11 @@ void geo_process_billboard(struct GraphNodeBillboard *node) {
 
     mtxf_billboard(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], translation, scale, gCurGraphNodeCamera->roll);
 
+#ifdef BILLBOARD_INSTANCING
+    inc_mat_stack_billboard(scale);
+#else
     inc_mat_stack();
+#endif
     append_dl_and_return((struct GraphNodeDisplayList *)node);
 }
 
@@ -1002,6 +1063,83 @@ s32 obj_is_in_view(struct GraphNodeObject *node) {
     return TRUE;
 }
 
+#ifdef STATIC_GEO_FLATTENING
+/**
+ * Like obj_is_in_view, for the bounding sphere of a static display list. The radius is scaled by
+ * 'hMargin' / 'vMargin' to measure it perpendicular to the sides of the frustum, since level geometry
+ * is large enough for the difference to be visible.
+ */
+static s32 static_list_is_in_view(struct StaticDisplayList *list, f32 hMargin, UNUSED f32 vMargin) {
+    Vec3f cameraToCenter;
+
+    if (list->radius < 0.0f) {
+        return TRUE;
+    }
+
+    linear_mtxf_mul_vec3f_and_translate(gCameraTransform, cameraToCenter, list->center);
+
+    // Entirely behind the camera
+    if (cameraToCenter[2] > list->radius) {
+        return FALSE;
+    }
+
+#ifndef CULLING_ON_EMULATOR
+    if (!(gEmulator & NO_CULLING_EMULATOR_BLACKLIST)) {
+        return TRUE;
+    }
+#endif
+
+#ifdef VERTICAL_CULLING
+    f32 vScreenEdge = -cameraToCenter[2] * gCurGraphNodeCamFrustum->halfFovVertical;
+
+    if (absf(cameraToCenter[1]) > vScreenEdge + list->radius * vMargin) {
+        return FALSE;
+    }
+#endif
+
+    f32 hScreenEdge = -cameraToCenter[2] * gCurGraphNodeCamFrustum->halfFovHorizontal;
+
+    if (absf(cameraToCenter[0]) > hScreenEdge + list->radius * hMargin) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Process a static list node. Draws the display lists flattened out of static nodes when the
+ * area was loaded, with their precomputed matrices, skipping the ones that are off screen.
+ * The original nodes are its children, but they aren't processed.
+ */
+void geo_process_static_list(struct GraphNodeStaticList *node) {
+    struct StaticDisplayList *list = node->lists;
+    s32 cull = (gCurGraphNodeCamera != NULL && gCurGraphNodeCamFrustum != NULL);
+    f32 hMargin = 1.0f;
+    f32 vMargin = 1.0f;
+    s32 i;
+
+    if (cull) {
+        hMargin = sqrtf(1.0f + sqr(gCurGraphNodeCamFrustum->halfFovHorizontal));
+#ifdef VERTICAL_CULLING
+        vMargin = sqrtf(1.0f + sqr(gCurGraphNodeCamFrustum->halfFovVertical));
+#endif
+    }
+
+    for (i = 0; i < node->numLists; i++, list++) {
+        if (cull && !static_list_is_in_view(list, hMargin, vMargin)) {
+            continue;
+        }
+        if (list->transform != NULL) {
+            gMatStackIndex++;
+            gMatStackFixed[gMatStackIndex] = list->transform;
+            geo_append_display_list(list->displayList, list->layer);
+            gMatStackIndex--;
+        } else {
+            geo_append_display_list(list->displayList, list->layer);
+        }
+    }
+}
+#endif
+
 #ifdef VISUAL_DEBUG
 void visualise_object_hitbox(struct Object *node) {
     Vec3f bnds1, bnds2;
@@ -1070,7 +1208,15 @@ void geo_process_object(struct Object *node) {
 
         if (!isInvisible && obj_is_in_view(&node->header.gfx)) {
             gMatStackIndex--;
+#ifdef BILLBOARD_INSTANCING
+            if (noThrowMatrix && (node->header.gfx.node.flags & GRAPH_RENDER_BILLBOARD)) {
+                inc_mat_stack_billboard(node->header.gfx.scale);
+            } else {
+                inc_mat_stack();
+            }
+#else
             inc_mat_stack();
+#endif
 
             if (node->header.gfx.sharedChild != NULL) {
 #ifdef VISUAL_DEBUG
@@ -1107,6 +1253,9 @@ void geo_process_object_parent(struct GraphNodeObjectParent *node) {
     if (node->node.children != NULL) {
         geo_process_node_and_siblings(node->node.children);
     }
+#ifdef LIGHTWEIGHT_PARTICLES
+    render_lightweight_particles(gMatStack[gMatStackIndex], gCurGraphNodeCamera->roll, gCurGraphNodeRoot->areaIndex);
+#endif
 }
 
 /**
@@ -1202,6 +1351,9 @@ static GeoProcessFunc GeoProcessJumpTable[] = {
     [GRAPH_NODE_TYPE_CULLING_RADIUS      ] = geo_try_process_children,
     [GRAPH_NODE_TYPE_ROOT                ] = geo_try_process_children,
     [GRAPH_NODE_TYPE_START               ] = geo_try_process_children,
+#ifdef STATIC_GEO_FLATTENING
+    [GRAPH_NODE_TYPE_STATIC_LIST         ] = geo_process_static_list,
+#endif
 };
 
 /**
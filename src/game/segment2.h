@@ -51,6 +51,7 @@ extern Gfx dl_hud_img_begin[];
 extern Gfx dl_hud_img_end[];
 extern void *main_font_lut[];
 extern Gfx dl_ia_text_tex_settings[];
+extern Gfx dl_ia_text_atlas_char[];
 extern Gfx dl_rgba16_load_tex_block[];
 extern void *main_credits_font_lut[];
 extern Texture *main_hud_camera_lut[6];
@@ -4,6 +4,7 @@
 #include "engine/math_util.h"
 #include "engine/surface_collision.h"
 #include "behavior_data.h"
+#include "game_init.h"
 #include "geo_misc.h"
 #include "level_table.h"
 #include "memory.h"
@@ -179,6 +180,59 @@ static void add_shadow_to_display_list(Gfx *displayListHead, s8 shadowType) {
     gSPEndDisplayList(displayListHead);
 }
 
+#ifdef SHADOW_FLOOR_CACHE
+/**
+ * How far an object can move from where its shadow last looked for a floor before looking again.
+ */
+#define SHADOW_FLOOR_CACHE_DIST 50.0f
+
+/**
+ * How many frames a cached shadow floor is used for before looking again. Dynamic floors are never
+ * cached, this limits how long a platform moving in above the cached floor goes unnoticed.
+ */
+#define SHADOW_FLOOR_CACHE_FRAMES 8
+
+/**
+ * Return the floor the object's shadow found on a recent frame if the object is still close to where
+ * it was and over the same triangle, writing its height at x, z to floorHeight. Return NULL otherwise.
+ */
+static struct Surface *get_cached_shadow_floor(struct Object *obj, f32 x, f32 y, f32 z, f32 *floorHeight) {
+    struct Surface *floor = obj->shadowFloor;
+
+    if (floor == NULL
+        || gGlobalTimer - obj->shadowFloorTimer >= SHADOW_FLOOR_CACHE_FRAMES
+        || absf(x - obj->shadowFloorPos[0]) > SHADOW_FLOOR_CACHE_DIST
+        || absf(y - obj->shadowFloorPos[1]) > SHADOW_FLOOR_CACHE_DIST
+        || absf(z - obj->shadowFloorPos[2]) > SHADOW_FLOOR_CACHE_DIST
+        || !check_within_floor_triangle_bounds(x, z, floor)) {
+        return NULL;
+    }
+
+    *floorHeight = get_surface_height_at_location(x, z, floor);
+
+    // The same check find_floor uses for floors above the position
+    if (y < (*floorHeight - FIND_FLOOR_BUFFER)) {
+        return NULL;
+    }
+
+    return floor;
+}
+
+/**
+ * Remember the floor found for the object's shadow. Dynamic floors are rebuilt every frame, so those
+ * aren't kept.
+ */
+static void cache_shadow_floor(struct Object *obj, Vec3f pos, struct Surface *floor) {
+    if (floor != NULL && !(floor->flags & SURFACE_FLAG_DYNAMIC)) {
+        obj->shadowFloor = floor;
+        vec3f_copy(obj->shadowFloorPos, pos);
+        obj->shadowFloorTimer = gGlobalTimer;
+    } else {
+        obj->shadowFloor = NULL;
+    }
+}
+#endif
+
 //! TODO:
 //      - Breakout create_shadow_below_xyz into multiple functions
 /**
@@ -215,7 +269,19 @@ Gfx *create_shadow_below_xyz(Vec3f pos, s16 shadowScale, u8 shadowSolidity, s8 s
     } else {
         // The object has no referenced floor, so find a new one.
         // gCollisionFlags |= COLLISION_FLAG_RETURN_FIRST;
+#ifdef SHADOW_FLOOR_CACHE
+        // Held objects and mirror Mario aren't drawn from their own object, so they can't keep a floor.
+        s32 canCache = (notHeldObj && (gCurGraphNodeObject != &gMirrorMario));
+
+        if (!canCache || (floor = get_cached_shadow_floor(obj, x, y, z, &floorHeight)) == NULL) {
+            floorHeight = find_floor(x, y, z, &floor);
+            if (canCache) {
+                cache_shadow_floor(obj, pos, floor);
+            }
+        }
+#else
         floorHeight = find_floor(x, y, z, &floor);
+#endif
 
         // No shadow if the position is OOB.
         if (floor == NULL) {
@@ -11,6 +11,7 @@
 #include "sm64.h"
 #include "geo_commands.h"
 #include "color_presets.h"
+#include "buffers/buffers.h"
 
 /**
  * @file skybox.c
@@ -125,6 +126,42 @@ ColorRGB sSkyboxColors[] = {
  */
 #define SKYBOX_ROWS (8 * SKYBOX_SIZE)
 
+/**
+ * The number of tiles drawn each frame, a 3x3 grid of SKYBOX_SIZE x SKYBOX_SIZE tiles.
+ */
+#define SKYBOX_GRID_TILES ((3 * SKYBOX_SIZE) * (3 * SKYBOX_SIZE))
+
+/**
+ * The length of the skybox's display list: 5 commands for the start and end, plus 7 per tile.
+ */
+#define SKYBOX_DL_LENGTH (5 + SKYBOX_GRID_TILES * 7)
+
+#ifdef SKYBOX_CACHE
+/**
+ * A skybox display list that is kept across frames. The tiles only change when the camera turns far
+ * enough to move the tile grid, and the ortho matrix only when the camera turns at all, so nothing is
+ * rebuilt while the camera holds still and only the matrix while it turns within a tile.
+ *
+ * There is one per gfx pool, since the RCP may still be drawing the frame built with the previous one.
+ */
+struct SkyboxCache {
+    Gfx dl[SKYBOX_DL_LENGTH];
+    Vtx verts[SKYBOX_GRID_TILES * 4];
+    Mtx ortho;
+    /// The tile list the display list was built from
+    const void *textures;
+    s32 upperLeftTile;
+    s32 scaledX;
+    s32 scaledY;
+    s8 player;
+    s8 colorIndex;
+    u8 dlValid;
+    u8 orthoValid;
+};
+
+static struct SkyboxCache sSkyboxCache[GFX_NUM_POOLS];
+#endif
+
 
 /**
  * Convert the camera's yaw into an x position into the scaled skybox image.
@@ -181,36 +218,34 @@ static s32 get_top_left_tile_idx(s8 player) {
 }
 
 /**
- * Generates vertices for the skybox tile.
+ * Generates the 4 vertices for the skybox tile in verts.
  *
  * @param tileIndex The index into the 32x32 sections of the whole skybox image. The index is converted
  *                  into an x and y by modulus and division by SKYBOX_COLS. x and y are then scaled by
  *                  SKYBOX_TILE_WIDTH to get a point in world space.
  */
-Vtx *make_skybox_rect(s32 tileIndex, s8 colorIndex) {
-    Vtx *verts = alloc_display_list(4 * sizeof(*verts));
+void make_skybox_rect(Vtx *verts, s32 tileIndex, s8 colorIndex) {
     s16 x = tileIndex % SKYBOX_COLS * SKYBOX_TILE_WIDTH;
     s16 y = SKYBOX_HEIGHT - tileIndex / SKYBOX_COLS * SKYBOX_TILE_HEIGHT;
 
-    if (verts != NULL) {
-        make_vertex(verts, 0, x, y, -1, 0, 0, sSkyboxColors[colorIndex][0], sSkyboxColors[colorIndex][1],
-                    sSkyboxColors[colorIndex][2], 255);
-        make_vertex(verts, 1, x, y - SKYBOX_TILE_HEIGHT, -1, 0, 31 << 5, sSkyboxColors[colorIndex][0], sSkyboxColors[colorIndex][1],
-                    sSkyboxColors[colorIndex][2], 255);
-        make_vertex(verts, 2, x + SKYBOX_TILE_WIDTH, y - SKYBOX_TILE_HEIGHT, -1, 31 << 5, 31 << 5, sSkyboxColors[colorIndex][0],
-                    sSkyboxColors[colorIndex][1], sSkyboxColors[colorIndex][2], 255);
-        make_vertex(verts, 3, x + SKYBOX_TILE_WIDTH, y, -1, 31 << 5, 0, sSkyboxColors[colorIndex][0], sSkyboxColors[colorIndex][1],
-                    sSkyboxColors[colorIndex][2], 255);
-    }
-    return verts;
+    make_vertex(verts, 0, x, y, -1, 0, 0, sSkyboxColors[colorIndex][0], sSkyboxColors[colorIndex][1],
+                sSkyboxColors[colorIndex][2], 255);
+    make_vertex(verts, 1, x, y - SKYBOX_TILE_HEIGHT, -1, 0, 31 << 5, sSkyboxColors[colorIndex][0], sSkyboxColors[colorIndex][1],
+                sSkyboxColors[colorIndex][2], 255);
+    make_vertex(verts, 2, x + SKYBOX_TILE_WIDTH, y - SKYBOX_TILE_HEIGHT, -1, 31 << 5, 31 << 5, sSkyboxColors[colorIndex][0],
+                sSkyboxColors[colorIndex][1], sSkyboxColors[colorIndex][2], 255);
+    make_vertex(verts, 3, x + SKYBOX_TILE_WIDTH, y, -1, 31 << 5, 0, sSkyboxColors[colorIndex][0], sSkyboxColors[colorIndex][1],
+                sSkyboxColors[colorIndex][2], 255);
 }
 
 /**
  * Draws a 3x3 grid of 32x32 sections of the original skybox image.
  * The row and column are converted into an index into the skybox's tile list, which is then drawn in
  * world space so that the tiles will rotate with the camera.
+ *
+ * @param verts Space for the vertices of SKYBOX_GRID_TILES tiles
  */
-void draw_skybox_tile_grid(Gfx **dlist, s8 background, s8 player, s8 colorIndex) {
+void draw_skybox_tile_grid(Gfx **dlist, Vtx *verts, s8 background, s8 player, s8 colorIndex) {
     s32 row;
     s32 col;
 
@@ -223,21 +258,21 @@ void draw_skybox_tile_grid(Gfx **dlist, s8 background, s8 player, s8 colorIndex)
 
             const Texture *const texture =
                 (*(SkyboxTexture *) segmented_to_virtual(sSkyboxTextures[background]))[tileIndex];
-            Vtx *vertices = make_skybox_rect(tileIndex, colorIndex);
+            make_skybox_rect(verts, tileIndex, colorIndex);
 
             gLoadBlockTexture((*dlist)++, 32, 32, G_IM_FMT_RGBA, texture);
-            gSPVertex((*dlist)++, VIRTUAL_TO_PHYSICAL(vertices), 4, 0);
+            gSPVertex((*dlist)++, VIRTUAL_TO_PHYSICAL(verts), 4, 0);
             gSPDisplayList((*dlist)++, dl_draw_quad_verts_0123);
+            verts += 4;
         }
     }
 }
 
-void *create_skybox_ortho_matrix(s8 player) {
+void create_skybox_ortho_matrix(Mtx *mtx, s8 player) {
     f32 left = sSkyBoxInfo[player].scaledX;
     f32 right = sSkyBoxInfo[player].scaledX + SCREEN_WIDTH;
     f32 bottom = sSkyBoxInfo[player].scaledY - SCREEN_HEIGHT;
     f32 top = sSkyBoxInfo[player].scaledY;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
 #ifdef WIDESCREEN
     f32 half_width = (4.0f / 3.0f) / GFX_DIMENSIONS_ASPECT_RATIO * SCREEN_CENTER_X;
@@ -249,35 +284,69 @@ void *create_skybox_ortho_matrix(s8 player) {
     }
 #endif
 
-    if (mtx != NULL) {
-        guOrtho(mtx, left, right, bottom, top, 0.0f, 3.0f, 1.0f);
-    }
+    guOrtho(mtx, left, right, bottom, top, 0.0f, 3.0f, 1.0f);
+}
 
-    return mtx;
+/**
+ * Writes the skybox's display list to dlist, then draws the 3x3 grid of tiles.
+ */
+static void build_skybox_display_list(Gfx *dlist, Vtx *verts, Mtx *ortho, s8 player, s8 background, s8 colorIndex) {
+    gSPDisplayList(dlist++, dl_skybox_begin);
+    gSPMatrix(dlist++, VIRTUAL_TO_PHYSICAL(ortho), G_MTX_PROJECTION | G_MTX_MUL | G_MTX_NOPUSH);
+    gSPDisplayList(dlist++, dl_skybox_tile_tex_settings);
+    draw_skybox_tile_grid(&dlist, verts, background, player, colorIndex);
+    gSPDisplayList(dlist++, dl_skybox_end);
+    gSPEndDisplayList(dlist);
 }
 
+#ifdef SKYBOX_CACHE
+/**
+ * Returns this gfx pool's cached skybox display list, updating the parts the camera has moved out of.
+ */
+Gfx *init_skybox_display_list(s8 player, s8 background, s8 colorIndex) {
+    struct SkyboxCache *cache = &sSkyboxCache[gGfxPool - gGfxPools];
+    struct Skybox *info = &sSkyBoxInfo[player];
+    const void *textures = segmented_to_virtual(sSkyboxTextures[background]);
+
+    if (!cache->orthoValid || cache->player != player
+        || cache->scaledX != info->scaledX || cache->scaledY != info->scaledY) {
+        create_skybox_ortho_matrix(&cache->ortho, player);
+        cache->scaledX = info->scaledX;
+        cache->scaledY = info->scaledY;
+        cache->orthoValid = TRUE;
+    }
+
+    // The tile list's address covers both a different background and the skybox segment moving
+    if (!cache->dlValid || cache->player != player || cache->textures != textures
+        || cache->upperLeftTile != info->upperLeftTile || cache->colorIndex != colorIndex) {
+        build_skybox_display_list(cache->dl, cache->verts, &cache->ortho, player, background, colorIndex);
+        cache->textures = textures;
+        cache->upperLeftTile = info->upperLeftTile;
+        cache->colorIndex = colorIndex;
+        cache->dlValid = TRUE;
+    }
+    cache->player = player;
+
+    return cache->dl;
+}
+#else
 /**
  * Creates the skybox's display list, then draws the 3x3 grid of tiles.
  */
 Gfx *init_skybox_display_list(s8 player, s8 background, s8 colorIndex) {
-    s32 dlCommandCount = 5 + (3 * 3) * 7; // 5 for the start and end, plus 9 skybox tiles
-    void *skybox = alloc_display_list(dlCommandCount * sizeof(Gfx) * sqr(SKYBOX_SIZE));
-    Gfx *dlist = skybox;
+    Gfx *skybox = alloc_display_list(SKYBOX_DL_LENGTH * sizeof(Gfx));
+    Vtx *verts = alloc_display_list(SKYBOX_GRID_TILES * 4 * sizeof(Vtx));
+    Mtx *ortho = alloc_display_list(sizeof(*ortho));
 
-    if (skybox == NULL) {
+    if (skybox == NULL || verts == NULL || ortho == NULL) {
         return NULL;
-    } else {
-        Mtx *ortho = create_skybox_ortho_matrix(player);
-
-        gSPDisplayList(dlist++, dl_skybox_begin);
-        gSPMatrix(dlist++, VIRTUAL_TO_PHYSICAL(ortho), G_MTX_PROJECTION | G_MTX_MUL | G_MTX_NOPUSH);
-        gSPDisplayList(dlist++, dl_skybox_tile_tex_settings);
-        draw_skybox_tile_grid(&dlist, background, player, colorIndex);
-        gSPDisplayList(dlist++, dl_skybox_end);
-        gSPEndDisplayList(dlist);
     }
+
+    create_skybox_ortho_matrix(ortho, player);
+    build_skybox_display_list(skybox, verts, ortho, player, background, colorIndex);
     return skybox;
 }
+#endif
 
 /**
  * Draw a skybox facing the direction from pos to foc.
@@ -13,6 +13,80 @@
 #include "spawn_object.h"
 #include "types.h"
 
+#ifdef OBJECT_BEHAVIOR_CHAINS
+#define BEHAVIOR_CHAIN_COUNT 64
+
+/**
+ * Objects are chained by the hash of their behavior pointer, in the order they
+ * got that behavior. A chain can hold several behaviors, so anything walking
+ * one still has to compare obj->behavior.
+ */
+struct BehaviorChain {
+    struct Object *head;
+    struct Object *tail;
+};
+
+static struct BehaviorChain sBehaviorChains[BEHAVIOR_CHAIN_COUNT];
+
+static struct BehaviorChain *get_behavior_chain(const BehaviorScript *behavior) {
+    uintptr_t addr = (uintptr_t) behavior;
+
+    return &sBehaviorChains[((addr >> 2) ^ (addr >> 8)) & (BEHAVIOR_CHAIN_COUNT - 1)];
+}
+
+static void behavior_chain_link(struct Object *obj) {
+    struct BehaviorChain *chain = get_behavior_chain(obj->behavior);
+
+    obj->behaviorChainNext = NULL;
+    obj->behaviorChainPrev = chain->tail;
+    if (chain->tail != NULL) {
+        chain->tail->behaviorChainNext = obj;
+    } else {
+        chain->head = obj;
+    }
+    chain->tail = obj;
+}
+
+static void behavior_chain_unlink(struct Object *obj) {
+    struct BehaviorChain *chain = get_behavior_chain(obj->behavior);
+
+    if (obj->behaviorChainPrev != NULL) {
+        obj->behaviorChainPrev->behaviorChainNext = obj->behaviorChainNext;
+    } else {
+        chain->head = obj->behaviorChainNext;
+    }
+    if (obj->behaviorChainNext != NULL) {
+        obj->behaviorChainNext->behaviorChainPrev = obj->behaviorChainPrev;
+    } else {
+        chain->tail = obj->behaviorChainPrev;
+    }
+}
+
+/**
+ * Return the first object in the chain that objects with the given (virtual)
+ * behavior are in. Follow behaviorChainNext from there and skip the objects
+ * that have a different behavior.
+ */
+struct Object *get_behavior_chain_head(const BehaviorScript *behavior) {
+    return get_behavior_chain(behavior)->head;
+}
+#endif
+
+/**
+ * Change the behavior of an object without restarting its behavior script.
+ */
+void set_object_behavior(struct Object *obj, const BehaviorScript *behavior) {
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    if (obj->behavior != behavior) {
+        behavior_chain_unlink(obj);
+        obj->behavior = behavior;
+        behavior_chain_link(obj);
+    }
+#else
+    obj->behavior = behavior;
+#endif
+}
+
 /**
  * Attempt to allocate an object from freeList (singly linked) and append it
  * to the end of destList (doubly linked). Return the object, or NULL if
@@ -73,6 +147,10 @@ void init_free_object_list(void) {
 
     // End the list
     obj->header.next = NULL;
+
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    bzero(sBehaviorChains, sizeof(sBehaviorChains));
+#endif
 }
 
 /**
@@ -102,6 +180,9 @@ void unload_object(struct Object *obj) {
 
     obj->header.gfx.node.flags &= ~(GRAPH_RENDER_BILLBOARD | GRAPH_RENDER_ACTIVE);
 
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    behavior_chain_unlink(obj);
+#endif
     deallocate_object(&gFreeObjectList, &obj->header);
 }
 
@@ -111,7 +192,6 @@ void unload_object(struct Object *obj) {
  * infinite loop.
  */
 struct Object *allocate_object(struct ObjectNode *objList) {
-    s32 i;
     struct Object *obj = try_allocate_object(objList, &gFreeObjectList);
 
     // The object list is full if the newly created pointer is NULL.
@@ -147,15 +227,9 @@ struct Object *allocate_object(struct ObjectNode *objList) {
     obj->collidedObjInteractTypes = 0;
     obj->numCollidedObjs = 0;
 
+    bzero(&obj->rawData, sizeof(obj->rawData));
 #if IS_64_BIT
-    for (i = 0; i < MAX_OBJECT_FIELDS; i++) {
-        obj->rawData.asS32[i] = 0;
-        obj->ptrData.asVoidPtr[i] = NULL;
-    }
-#else
-    for (i = 0; i < MAX_OBJECT_FIELDS; i++) {
-        obj->rawData.asS32[i] = 0;
-    }
+    bzero(&obj->ptrData, sizeof(obj->ptrData));
 #endif
 
     obj->unused1 = 0;
@@ -182,6 +256,9 @@ struct Object *allocate_object(struct ObjectNode *objList) {
 
     obj->respawnInfoType = RESPAWN_INFO_TYPE_NULL;
     obj->respawnInfo = NULL;
+#ifdef SHADOW_FLOOR_CACHE
+    obj->shadowFloor = NULL;
+#endif
 
     obj->oDistanceToMario = 19000.0f;
     obj->oRoom = -1;
@@ -214,6 +291,10 @@ struct Object *create_object(const BehaviorScript *bhvScript) {
 
     obj->curBhvCommand = bhvScript;
     obj->behavior = bhvScript;
+#ifdef OBJECT_BEHAVIOR_CHAINS
+    obj->objListIndex = objListIndex;
+    behavior_chain_link(obj);
+#endif
 
     if (objListIndex == OBJ_LIST_UNIMPORTANT) {
         obj->activeFlags |= ACTIVE_FLAG_UNIMPORTANT;
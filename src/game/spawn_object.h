@@ -7,5 +7,9 @@ void init_free_object_list(void);
 void clear_object_lists(struct ObjectNode *objLists);
 void unload_object(struct Object *obj);
 struct Object *create_object(const BehaviorScript *bhvScript);
+void set_object_behavior(struct Object *obj, const BehaviorScript *behavior);
+#ifdef OBJECT_BEHAVIOR_CHAINS
+struct Object *get_behavior_chain_head(const BehaviorScript *behavior);
+#endif
 
 #endif // SPAWN_OBJECT_H
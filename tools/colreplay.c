@@ -0,0 +1,680 @@
+/*
+ * colreplay: replays collision query traces captured with COLLISION_TRACE
+ * against a level's collision.inc.c and reports how many surfaces each query
+ * visits, for one or more spatial partition cell sizes.
+ *
+ * Traces are the raw binary files UNFLoader writes out for DATATYPE_RAWBINARY
+ * packets (struct CollisionTraceEntry, big endian). Multiple files are read in
+ * order, so a long session can be passed as a glob.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "utils.h"
+
+#define COLREPLAY_VERSION "0.1"
+
+#define TRACE_ENTRY_SIZE 0x24
+
+#define DEFAULT_LEVEL_BOUNDARY 0x2000
+#define DEFAULT_CELL_SIZE      0x400
+#define MAX_STRATEGIES         8
+
+#define FIND_FLOOR_BUFFER          78
+#define CELL_HEIGHT_LIMIT          20000
+#define FLOOR_LOWER_LIMIT         -11000
+#define SURFACE_VERTICAL_BUFFER    5
+#define NORMAL_FLOOR_THRESHOLD     0.01f
+#define NORMAL_CEIL_THRESHOLD     -NORMAL_FLOOR_THRESHOLD
+#define NEAR_ONE                   0.99999f
+#define NEAR_ZERO                  1e-5f
+#define MAX_REFERENCED_WALLS       4
+
+// Must match the values in object_list_processor.h and surface_collision.h.
+#define COLLISION_FLAG_RETURN_FIRST       (1 << 1)
+#define COLLISION_FLAG_CAMERA             (1 << 2)
+#define COLLISION_FLAG_INCLUDE_INTANGIBLE (1 << 3)
+#define COLLISION_FLAG_EXCLUDE_DYNAMIC    (1 << 4)
+
+#define RAYCAST_FIND_FLOOR (1 << 0)
+#define RAYCAST_FIND_WALL  (1 << 1)
+#define RAYCAST_FIND_CEIL  (1 << 2)
+#define RAYCAST_FIND_WATER (1 << 3)
+
+enum TraceType { TRACE_FRAME, TRACE_FLOOR, TRACE_CEIL, TRACE_WALL, TRACE_WATER, TRACE_RAY, TRACE_TYPE_COUNT };
+enum TraceCaller { CALLER_NONE, CALLER_MARIO, CALLER_OBJECT, CALLER_CAMERA, CALLER_COUNT };
+enum TraceResult { RESULT_NONE, RESULT_STATIC, RESULT_DYNAMIC };
+
+static const char *sTypeNames[TRACE_TYPE_COUNT] = { "frame", "floor", "ceil", "wall", "water", "ray" };
+static const char *sCallerNames[CALLER_COUNT] = { "none", "mario", "object", "camera" };
+
+enum SurfaceClass {
+    SURF_DEFAULT,
+    SURF_HANGABLE,
+    SURF_INTANGIBLE,
+    SURF_CAMERA_BOUNDARY,
+    SURF_NEW_WATER,
+    SURF_NEW_WATER_BOTTOM,
+};
+
+enum Partition { PART_FLOORS, PART_CEILS, PART_WALLS, PART_WATER, NUM_PARTS };
+
+typedef struct {
+    int v[3][3];
+    float n[3];
+    float originOffset;
+    int lowerY, upperY;
+    int cls;
+    int noCamCollision;
+} surface;
+
+typedef struct {
+    int count;
+    int capacity;
+    int *items;
+} surface_list;
+
+typedef struct {
+    int cellSize;
+    int numCells;
+    surface_list *cells; // numCells * numCells * NUM_PARTS
+    unsigned long long visits[TRACE_TYPE_COUNT];
+    unsigned long long callerVisits[CALLER_COUNT];
+    unsigned int maxVisits[TRACE_TYPE_COUNT];
+    unsigned int mismatches;
+} strategy;
+
+typedef struct {
+    int type, caller, flags, result, surfaceType;
+    float pos[3];
+    float aux[3];
+    float height;
+} trace_entry;
+
+static surface *sSurfaces;
+static int sNumSurfaces;
+static int (*sWaterBoxes)[6];
+static int sNumWaterBoxes;
+static int sBoundary = DEFAULT_LEVEL_BOUNDARY;
+
+static unsigned long long sQueries[TRACE_TYPE_COUNT];
+static unsigned long long sCallerQueries[CALLER_COUNT];
+
+/**************************************************
+ *                COLLISION PARSING               *
+ **************************************************/
+
+static int parse_surface_class(const char *name, int *noCamCollision) {
+    static const struct { const char *name; int value; int cls; int noCam; } sTypes[] = {
+        { "SURFACE_NEW_WATER",                0x02, SURF_NEW_WATER,        0 },
+        { "SURFACE_NEW_WATER_BOTTOM",         0x03, SURF_NEW_WATER_BOTTOM, 0 },
+        { "SURFACE_HANGABLE",                 0x05, SURF_HANGABLE,         0 },
+        { "SURFACE_INTANGIBLE",               0x12, SURF_INTANGIBLE,       0 },
+        { "SURFACE_CAMERA_BOUNDARY",          0x72, SURF_CAMERA_BOUNDARY,  0 },
+        { "SURFACE_NO_CAM_COLLISION",         0x76, SURF_DEFAULT,          1 },
+        { "SURFACE_NO_CAM_COLLISION_77",      0x77, SURF_DEFAULT,          1 },
+        { "SURFACE_NO_CAM_COL_VERY_SLIPPERY", 0x78, SURF_DEFAULT,          1 },
+        { "SURFACE_SWITCH",                   0x7A, SURF_DEFAULT,          1 },
+    };
+    int numeric = isdigit((unsigned char) name[0]);
+    int value = numeric ? (int) strtol(name, NULL, 0) : -1;
+
+    *noCamCollision = 0;
+    for (size_t i = 0; i < DIM(sTypes); i++) {
+        if ((numeric && value == sTypes[i].value) || (!numeric && strcmp(name, sTypes[i].name) == 0)) {
+            *noCamCollision = sTypes[i].noCam;
+            return sTypes[i].cls;
+        }
+    }
+    return SURF_DEFAULT;
+}
+
+static void add_surface(int verts[][3], int numVerts, int a, int b, int c, int cls, int noCam) {
+    if (a >= numVerts || b >= numVerts || c >= numVerts) {
+        ERROR("Triangle references vertex out of range (%d, %d, %d / %d)\n", a, b, c, numVerts);
+        exit(1);
+    }
+
+    surface *s = &sSurfaces[sNumSurfaces];
+    memcpy(s->v[0], verts[a], sizeof(s->v[0]));
+    memcpy(s->v[1], verts[b], sizeof(s->v[1]));
+    memcpy(s->v[2], verts[c], sizeof(s->v[2]));
+
+    float n[3];
+    n[0] = (float)(s->v[1][1] - s->v[0][1]) * (s->v[2][2] - s->v[1][2]) - (float)(s->v[2][1] - s->v[1][1]) * (s->v[1][2] - s->v[0][2]);
+    n[1] = (float)(s->v[1][2] - s->v[0][2]) * (s->v[2][0] - s->v[1][0]) - (float)(s->v[2][2] - s->v[1][2]) * (s->v[1][0] - s->v[0][0]);
+    n[2] = (float)(s->v[1][0] - s->v[0][0]) * (s->v[2][1] - s->v[1][1]) - (float)(s->v[2][0] - s->v[1][0]) * (s->v[1][1] - s->v[0][1]);
+    float mag = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (mag < NEAR_ZERO) {
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        s->n[i] = n[i] / mag;
+    }
+    s->originOffset = -(s->n[0] * s->v[0][0] + s->n[1] * s->v[0][1] + s->n[2] * s->v[0][2]);
+
+    int minY = MIN(s->v[0][1], MIN(s->v[1][1], s->v[2][1]));
+    int maxY = MAX(s->v[0][1], MAX(s->v[1][1], s->v[2][1]));
+    s->lowerY = minY - SURFACE_VERTICAL_BUFFER;
+    s->upperY = maxY + SURFACE_VERTICAL_BUFFER;
+    s->cls = cls;
+    s->noCamCollision = noCam;
+    sNumSurfaces++;
+}
+
+// Reads the comma separated arguments of a COL_ macro into args, returns the count.
+static int read_macro_args(const char *p, char args[][64], int maxArgs) {
+    int count = 0;
+    while (*p && *p != ')' && count < maxArgs) {
+        while (isspace((unsigned char) *p)) p++;
+        int len = 0;
+        while (*p && *p != ',' && *p != ')' && len < 63) {
+            if (!isspace((unsigned char) *p)) {
+                args[count][len++] = *p;
+            }
+            p++;
+        }
+        args[count][len] = '\0';
+        if (len > 0) count++;
+        if (*p == ',') p++;
+    }
+    return count;
+}
+
+static void parse_collision(const char *filename) {
+    unsigned char *data;
+    long size = read_file(filename, &data);
+    if (size < 0) {
+        ERROR("Error reading collision file \"%s\"\n", filename);
+        exit(1);
+    }
+    data = realloc(data, size + 1);
+    data[size] = '\0';
+
+    int capacity = 0;
+    for (const char *p = (char *) data; (p = strstr(p, "COL_TRI")) != NULL; p++) capacity++;
+    sSurfaces = calloc(capacity + 1, sizeof(surface));
+    sWaterBoxes = calloc(64, sizeof(*sWaterBoxes));
+
+    int (*verts)[3] = NULL;
+    int numVerts = 0, vertCapacity = 0;
+    int cls = SURF_DEFAULT, noCam = 0;
+    char args[8][64];
+
+    for (const char *p = (char *) data; (p = strstr(p, "COL_")) != NULL; ) {
+        const char *paren = strchr(p, '(');
+        if (paren == NULL) break;
+        char name[32];
+        int nameLen = MIN((int)(paren - p), 31);
+        memcpy(name, p, nameLen);
+        name[nameLen] = '\0';
+        int argc = read_macro_args(paren + 1, args, 8);
+        p = paren + 1;
+
+        if (strcmp(name, "COL_VERTEX_INIT") == 0 && argc == 1) {
+            vertCapacity = strtol(args[0], NULL, 0);
+            verts = realloc(verts, MAX(vertCapacity, 1) * sizeof(*verts));
+            numVerts = 0;
+        } else if (strcmp(name, "COL_VERTEX") == 0 && argc == 3) {
+            if (numVerts < vertCapacity) {
+                for (int i = 0; i < 3; i++) verts[numVerts][i] = strtol(args[i], NULL, 0);
+                numVerts++;
+            }
+        } else if (strcmp(name, "COL_TRI_INIT") == 0 && argc == 2) {
+            cls = parse_surface_class(args[0], &noCam);
+        } else if ((strcmp(name, "COL_TRI") == 0 && argc == 3) || (strcmp(name, "COL_TRI_SPECIAL") == 0 && argc == 4)) {
+            add_surface(verts, numVerts, strtol(args[0], NULL, 0), strtol(args[1], NULL, 0), strtol(args[2], NULL, 0), cls, noCam);
+        } else if (strcmp(name, "COL_WATER_BOX") == 0 && argc == 6 && sNumWaterBoxes < 64) {
+            for (int i = 0; i < 6; i++) sWaterBoxes[sNumWaterBoxes][i] = strtol(args[i], NULL, 0);
+            sNumWaterBoxes++;
+        }
+    }
+
+    free(verts);
+    free(data);
+}
+
+/**************************************************
+ *                   PARTITIONING                 *
+ **************************************************/
+
+static surface_list *get_cell(strategy *st, int cellX, int cellZ, int part) {
+    return &st->cells[(cellZ * st->numCells + cellX) * NUM_PARTS + part];
+}
+
+static int get_cell_coord(strategy *st, float p) {
+    return (((int) p + sBoundary) / st->cellSize) & (st->numCells - 1);
+}
+
+static int clamp_cell_index(strategy *st, int coord) {
+    coord += sBoundary;
+    if (coord < 0) coord = 0;
+    return MIN(coord / st->cellSize, st->numCells - 1);
+}
+
+// Mirrors add_surface_to_cell: floors and water sorted highest first, ceilings lowest first, walls in load order.
+static void insert_sorted(surface_list *list, int index, int sortDir) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->items = realloc(list->items, list->capacity * sizeof(int));
+    }
+
+    int priority = sSurfaces[index].upperY * sortDir;
+    int pos = list->count;
+    if (list->count > 0 && priority > sSurfaces[list->items[0]].upperY * sortDir) {
+        pos = 0;
+    } else {
+        for (int i = 1; i < list->count; i++) {
+            if (priority > sSurfaces[list->items[i]].upperY * sortDir) {
+                pos = i;
+                break;
+            }
+        }
+    }
+    memmove(&list->items[pos + 1], &list->items[pos], (list->count - pos) * sizeof(int));
+    list->items[pos] = index;
+    list->count++;
+}
+
+static void build_strategy(strategy *st, int cellSize) {
+    memset(st, 0, sizeof(*st));
+    st->cellSize = cellSize;
+    st->numCells = (2 * sBoundary) / cellSize;
+    st->cells = calloc((size_t) st->numCells * st->numCells * NUM_PARTS, sizeof(surface_list));
+
+    for (int i = 0; i < sNumSurfaces; i++) {
+        surface *s = &sSurfaces[i];
+        int part, sortDir = 1;
+
+        if (s->cls == SURF_NEW_WATER || s->cls == SURF_NEW_WATER_BOTTOM) {
+            part = PART_WATER;
+        } else if (s->n[1] > NORMAL_FLOOR_THRESHOLD) {
+            part = PART_FLOORS;
+        } else if (s->n[1] < NORMAL_CEIL_THRESHOLD) {
+            part = PART_CEILS;
+            sortDir = -1;
+        } else {
+            part = PART_WALLS;
+            sortDir = 0;
+        }
+
+        int minX = MIN(s->v[0][0], MIN(s->v[1][0], s->v[2][0]));
+        int maxX = MAX(s->v[0][0], MAX(s->v[1][0], s->v[2][0]));
+        int minZ = MIN(s->v[0][2], MIN(s->v[1][2], s->v[2][2]));
+        int maxZ = MAX(s->v[0][2], MAX(s->v[1][2], s->v[2][2]));
+
+        for (int cz = clamp_cell_index(st, minZ); cz <= clamp_cell_index(st, maxZ); cz++) {
+            for (int cx = clamp_cell_index(st, minX); cx <= clamp_cell_index(st, maxX); cx++) {
+                insert_sorted(get_cell(st, cx, cz, part), i, sortDir);
+            }
+        }
+    }
+}
+
+/**************************************************
+ *                      QUERIES                   *
+ **************************************************/
+
+static float surface_height(surface *s, float x, float z) {
+    return -(x * s->n[0] + z * s->n[2] + s->originOffset) / s->n[1];
+}
+
+static int skip_for_camera(surface *s, int flags) {
+    if (flags & COLLISION_FLAG_CAMERA) {
+        return s->noCamCollision;
+    }
+    return (s->cls == SURF_CAMERA_BOUNDARY);
+}
+
+static int within_floor_bounds(int x, int z, surface *s) {
+    for (int i = 0; i < 3; i++) {
+        int *a = s->v[i];
+        int *b = s->v[(i + 1) % 3];
+        if (((a[2] - z) * (b[0] - a[0]) - (a[0] - x) * (b[2] - a[2])) < 0) return 0;
+    }
+    return 1;
+}
+
+static int within_ceil_bounds(int x, int z, surface *s) {
+    for (int i = 0; i < 3; i++) {
+        int *a = s->v[i];
+        int *b = s->v[(i + 1) % 3];
+        if (((a[2] - z) * (b[0] - a[0]) - (a[0] - x) * (b[2] - a[2])) > 0) return 0;
+    }
+    return 1;
+}
+
+static unsigned int replay_floor(strategy *st, trace_entry *e, float *height) {
+    int x = e->pos[0], y = e->pos[1], z = e->pos[2];
+    int bufferY = y + FIND_FLOOR_BUFFER;
+    unsigned int visits = 0;
+
+    *height = FLOOR_LOWER_LIMIT;
+    if (x <= -sBoundary || x >= sBoundary || z <= -sBoundary || z >= sBoundary) return 0;
+
+    surface_list *list = get_cell(st, get_cell_coord(st, x), get_cell_coord(st, z), PART_FLOORS);
+    for (int i = 0; i < list->count; i++) {
+        surface *s = &sSurfaces[list->items[i]];
+        visits++;
+        if (!(e->flags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && s->cls == SURF_INTANGIBLE) continue;
+        if (skip_for_camera(s, e->flags)) continue;
+        if (bufferY < s->lowerY) continue;
+        if (!within_floor_bounds(x, z, s)) continue;
+        float h = surface_height(s, x, z);
+        if (h <= *height || bufferY < h) continue;
+        *height = h;
+        if (h == bufferY || (e->flags & COLLISION_FLAG_RETURN_FIRST)) break;
+    }
+    return visits;
+}
+
+static unsigned int replay_ceil(strategy *st, trace_entry *e, float *height) {
+    int x = e->pos[0], y = e->pos[1], z = e->pos[2];
+    unsigned int visits = 0;
+
+    *height = CELL_HEIGHT_LIMIT;
+    if (x <= -sBoundary || x >= sBoundary || z <= -sBoundary || z >= sBoundary) return 0;
+
+    surface_list *list = get_cell(st, get_cell_coord(st, x), get_cell_coord(st, z), PART_CEILS);
+    for (int i = 0; i < list->count; i++) {
+        surface *s = &sSurfaces[list->items[i]];
+        visits++;
+        if (y > s->upperY) continue;
+        if (skip_for_camera(s, e->flags)) continue;
+        if (!within_ceil_bounds(x, z, s)) continue;
+        float h = surface_height(s, x, z);
+        if (h > *height || y > h) continue;
+        *height = h;
+        if (h == y || (e->flags & COLLISION_FLAG_RETURN_FIRST)) break;
+    }
+    return visits;
+}
+
+// Only counts the walls that pass the cheap rejection tests; the push itself
+// doesn't change which lists are walked.
+static unsigned int replay_wall(strategy *st, trace_entry *e, float *numWalls) {
+    float x = e->pos[0], z = e->pos[2];
+    float y = e->pos[1] + e->aux[0];
+    float radius = e->aux[1];
+    unsigned int visits = 0;
+
+    *numWalls = 0;
+    if ((int) x <= -sBoundary || (int) x >= sBoundary || (int) z <= -sBoundary || (int) z >= sBoundary) return 0;
+
+    int minCellX = get_cell_coord(st, (int) x - radius);
+    int maxCellX = get_cell_coord(st, (int) x + radius);
+    int minCellZ = get_cell_coord(st, (int) z - radius);
+    int maxCellZ = get_cell_coord(st, (int) z + radius);
+
+    for (int cx = minCellX; cx <= maxCellX; cx++) {
+        for (int cz = minCellZ; cz <= maxCellZ; cz++) {
+            surface_list *list = get_cell(st, cx, cz, PART_WALLS);
+            for (int i = 0; i < list->count; i++) {
+                surface *s = &sSurfaces[list->items[i]];
+                visits++;
+                if (y < s->lowerY || y > s->upperY) continue;
+                if (skip_for_camera(s, e->flags)) continue;
+                float offset = s->n[0] * x + s->n[1] * y + s->n[2] * z + s->originOffset;
+                if (offset < -radius || offset > radius) continue;
+                (*numWalls)++;
+            }
+        }
+    }
+    return visits;
+}
+
+static unsigned int replay_water(strategy *st, trace_entry *e, float *level) {
+    int x = e->pos[0], z = e->pos[2];
+    unsigned int visits = 0;
+
+    *level = FLOOR_LOWER_LIMIT;
+    if (x > -sBoundary && x < sBoundary && z > -sBoundary && z < sBoundary) {
+        surface_list *list = get_cell(st, get_cell_coord(st, x), get_cell_coord(st, z), PART_WATER);
+        // find_water_floor_from_list walks the list once for bottoms and once for tops.
+        visits += 2 * list->count;
+        for (int i = 0; i < list->count; i++) {
+            surface *s = &sSurfaces[list->items[i]];
+            if (s->cls != SURF_NEW_WATER || fabsf(s->n[1]) < NORMAL_FLOOR_THRESHOLD) continue;
+            if (!(s->n[1] >= NORMAL_FLOOR_THRESHOLD ? within_floor_bounds(x, z, s) : within_ceil_bounds(x, z, s))) continue;
+            float h = surface_height(s, x, z);
+            if (h > *level) *level = h;
+        }
+    }
+
+    if (*level == FLOOR_LOWER_LIMIT) {
+        for (int i = 0; i < sNumWaterBoxes; i++) {
+            int *box = sWaterBoxes[i];
+            visits++;
+            if (box[1] < x && x < box[3] && box[2] < z && z < box[4] && box[0] < 50) {
+                *level = box[5];
+                break;
+            }
+        }
+    }
+    return visits;
+}
+
+static unsigned int ray_cell_visits(strategy *st, int cellX, int cellZ, float dirY, int flags) {
+    unsigned int visits = 0;
+    if (cellX < 0 || cellX >= st->numCells || cellZ < 0 || cellZ >= st->numCells) return 0;
+    if (dirY > -NEAR_ONE && (flags & RAYCAST_FIND_CEIL))  visits += get_cell(st, cellX, cellZ, PART_CEILS)->count;
+    if (dirY <  NEAR_ONE && (flags & RAYCAST_FIND_FLOOR)) visits += get_cell(st, cellX, cellZ, PART_FLOORS)->count;
+    if (flags & RAYCAST_FIND_WALL)  visits += get_cell(st, cellX, cellZ, PART_WALLS)->count;
+    if (flags & RAYCAST_FIND_WATER) visits += get_cell(st, cellX, cellZ, PART_WATER)->count;
+    return visits;
+}
+
+// Walks the same cells as find_surface_on_ray's grid traversal.
+static unsigned int replay_ray(strategy *st, trace_entry *e) {
+    float *orig = e->pos, *dir = e->aux;
+    float invcell = 1.0f / st->cellSize;
+    float length = sqrtf(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+    float dirY = (length > 0.0f) ? dir[1] / length : 0.0f;
+    unsigned int visits = 0;
+
+    float sx = (orig[0] + sBoundary) * invcell;
+    float sz = (orig[2] + sBoundary) * invcell;
+    float ex = (orig[0] + dir[0] + sBoundary) * invcell;
+    float ez = (orig[2] + dir[2] + sBoundary) * invcell;
+
+    if (dirY >= NEAR_ONE || dirY <= -NEAR_ONE) {
+        return ray_cell_visits(st, (int) sx, (int) sz, dirY, e->flags);
+    }
+
+    float rdx = ex - sx, rdz = ez - sz;
+    float px = (int) sx, pz = (int) sz;
+    float stepX = (rdx >= 0.0f) ? 1.0f : -1.0f;
+    float stepZ = (rdz >= 0.0f) ? 1.0f : -1.0f;
+    float deltaX = MIN(stepX / rdx, 1.0f);
+    float deltaZ = MIN(stepZ / rdz, 1.0f);
+    float tMaxX = fabsf((px + MAX(stepX, 0.0f) - sx) / rdx);
+    float tMaxZ = fabsf((pz + MAX(stepZ, 0.0f) - sz) / rdz);
+
+    while (1) {
+        visits += ray_cell_visits(st, (int) px, (int) pz, dirY, e->flags);
+        if (MIN(tMaxX, tMaxZ) > 1.0f) break;
+        if (tMaxX < tMaxZ) {
+            tMaxX += deltaX;
+            px += stepX;
+        } else {
+            tMaxZ += deltaZ;
+            pz += stepZ;
+        }
+    }
+    return visits;
+}
+
+static void replay_entry(strategy *st, trace_entry *e, int validate) {
+    unsigned int visits = 0;
+    float result = 0.0f;
+
+    switch (e->type) {
+        case TRACE_FLOOR: visits = replay_floor(st, e, &result); break;
+        case TRACE_CEIL:  visits = replay_ceil(st, e, &result);  break;
+        case TRACE_WALL:  visits = replay_wall(st, e, &result);  break;
+        case TRACE_WATER: visits = replay_water(st, e, &result); break;
+        case TRACE_RAY:   visits = replay_ray(st, e);            break;
+        default: return;
+    }
+
+    st->visits[e->type] += visits;
+    st->callerVisits[e->caller] += visits;
+    st->maxVisits[e->type] = MAX(st->maxVisits[e->type], visits);
+
+    // Heights are only comparable when the game didn't pick a dynamic surface or have object surfaces in the way.
+    if (validate && (e->type == TRACE_FLOOR || e->type == TRACE_CEIL)
+        && e->result != RESULT_DYNAMIC && fabsf(result - e->height) > 1.0f) {
+        st->mismatches++;
+    }
+}
+
+/**************************************************
+ *                       MAIN                     *
+ **************************************************/
+
+static void read_entry(unsigned char *buf, trace_entry *e) {
+    e->type        = buf[0];
+    e->caller      = buf[1];
+    e->flags       = buf[2];
+    e->result      = buf[3];
+    e->surfaceType = read_s16_be(&buf[4]);
+    for (int i = 0; i < 3; i++) {
+        e->pos[i] = read_f32_be(&buf[0x08 + i * 4]);
+        e->aux[i] = read_f32_be(&buf[0x14 + i * 4]);
+    }
+    e->height = read_f32_be(&buf[0x20]);
+}
+
+static void print_usage(void) {
+    ERROR("Usage: colreplay [-c CELL_SIZE]... [-b BOUNDARY] COLLISION TRACE [TRACE ...]\n"
+          "\n"
+          "colreplay v" COLREPLAY_VERSION ": replays COLLISION_TRACE captures against level collision\n"
+          "\n"
+          "Optional arguments:\n"
+          " -c CELL_SIZE  partition cell size to compare, may be repeated (default: 0x%X)\n"
+          " -b BOUNDARY   LEVEL_BOUNDARY_MAX of the build (default: 0x%X)\n"
+          "\n"
+          "File arguments:\n"
+          " COLLISION     collision.inc.c of the traced area\n"
+          " TRACE         binary trace files received over USB, in capture order\n",
+          DEFAULT_CELL_SIZE, DEFAULT_LEVEL_BOUNDARY);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    int cellSizes[MAX_STRATEGIES];
+    int numStrategies = 0;
+    int argi = 1;
+
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (argi + 1 >= argc) print_usage();
+        if (strcmp(argv[argi], "-c") == 0 && numStrategies < MAX_STRATEGIES) {
+            cellSizes[numStrategies++] = strtol(argv[++argi], NULL, 0);
+        } else if (strcmp(argv[argi], "-b") == 0) {
+            sBoundary = strtol(argv[++argi], NULL, 0);
+        } else {
+            print_usage();
+        }
+    }
+    if (argc - argi < 2) print_usage();
+    if (numStrategies == 0) cellSizes[numStrategies++] = DEFAULT_CELL_SIZE;
+
+    for (int i = 0; i < numStrategies; i++) {
+        int numCells = (2 * sBoundary) / MAX(cellSizes[i], 1);
+        if (cellSizes[i] <= 0 || !is_power2(numCells) || numCells * cellSizes[i] != 2 * sBoundary) {
+            ERROR("Cell size 0x%X does not evenly split the level into a power of two number of cells\n", cellSizes[i]);
+            return 1;
+        }
+    }
+
+    parse_collision(argv[argi++]);
+    printf("Loaded %d surfaces and %d water boxes\n", sNumSurfaces, sNumWaterBoxes);
+
+    strategy *strategies = calloc(numStrategies, sizeof(strategy));
+    for (int i = 0; i < numStrategies; i++) {
+        build_strategy(&strategies[i], cellSizes[i]);
+    }
+
+    unsigned long long frames = 0, dropped = 0;
+    int lastLevel = -1, lastArea = -1;
+
+    for (; argi < argc; argi++) {
+        unsigned char *data;
+        long size = read_file(argv[argi], &data);
+        if (size < 0) {
+            ERROR("Error reading trace file \"%s\"\n", argv[argi]);
+            return 1;
+        }
+        if (size % TRACE_ENTRY_SIZE) {
+            ERROR("Warning: \"%s\" is not a whole number of trace entries\n", argv[argi]);
+        }
+
+        for (long off = 0; off + TRACE_ENTRY_SIZE <= size; off += TRACE_ENTRY_SIZE) {
+            trace_entry e;
+            read_entry(&data[off], &e);
+
+            if (e.type >= TRACE_TYPE_COUNT || e.caller >= CALLER_COUNT) {
+                ERROR("Invalid trace entry at %s+0x%lX\n", argv[argi], off);
+                continue;
+            }
+            if (e.type == TRACE_FRAME) {
+                frames++;
+                dropped += (unsigned long long) e.aux[0];
+                if (e.surfaceType != lastLevel || e.flags != lastArea) {
+                    if (lastLevel != -1) {
+                        ERROR("Warning: trace changes to level %d area %d after %llu frames\n", e.surfaceType, e.flags, frames);
+                    }
+                    lastLevel = e.surfaceType;
+                    lastArea = e.flags;
+                }
+                continue;
+            }
+
+            sQueries[e.type]++;
+            sCallerQueries[e.caller]++;
+            for (int i = 0; i < numStrategies; i++) {
+                replay_entry(&strategies[i], &e, (cellSizes[i] == DEFAULT_CELL_SIZE && sBoundary == DEFAULT_LEVEL_BOUNDARY));
+            }
+        }
+        free(data);
+    }
+
+    printf("Replayed %llu frames (%llu entries dropped on device) for level %d area %d\n\n", frames, dropped, lastLevel, lastArea);
+
+    printf("%-8s %10s", "query", "count");
+    for (int i = 0; i < numStrategies; i++) printf("   cell 0x%-4X   avg/max", cellSizes[i]);
+    printf("\n");
+    for (int t = TRACE_FLOOR; t < TRACE_TYPE_COUNT; t++) {
+        printf("%-8s %10llu", sTypeNames[t], sQueries[t]);
+        for (int i = 0; i < numStrategies; i++) {
+            double avg = sQueries[t] ? (double) strategies[i].visits[t] / sQueries[t] : 0.0;
+            printf("   %14.2f/%-6u", avg, strategies[i].maxVisits[t]);
+        }
+        printf("\n");
+    }
+
+    printf("\n%-8s %10s", "caller", "count");
+    for (int i = 0; i < numStrategies; i++) printf("   cell 0x%-4X  per frame", cellSizes[i]);
+    printf("\n");
+    for (int c = 0; c < CALLER_COUNT; c++) {
+        printf("%-8s %10llu", sCallerNames[c], sCallerQueries[c]);
+        for (int i = 0; i < numStrategies; i++) {
+            double perFrame = frames ? (double) strategies[i].callerVisits[c] / frames : 0.0;
+            printf("   %21.1f", perFrame);
+        }
+        printf("\n");
+    }
+
+    for (int i = 0; i < numStrategies; i++) {
+        if (strategies[i].mismatches) {
+            printf("\nWarning: %u floor/ceiling results differ from the trace; is this the right area's collision?\n",
+                   strategies[i].mismatches);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+
+# compress_auto: encodes a segment with every available format and keeps the one that scores
+# best for COMPRESS=auto. The score mixes the encoded size and the modelled time to load the
+# segment (cartridge DMA of the encoded data plus decoding), both relative to storing it raw.
+#
+# Every output starts with a 4 byte format tag and the decoded size at +4, which is what
+# load_segment_decompress dispatches on. Yay0, MIO0, LZ4S and RNC already look like that;
+# gzip and raw data get a 16 byte header of their own.
+
+import argparse, os, struct, subprocess, sys, tempfile
+
+CPU_HZ = 93750000
+# Typical PI DMA rate from a cartridge
+PI_BYTES_PER_SEC = 5 * 1024 * 1024
+
+# Modelled VR4300 cycles per decoded byte for each decoder. These are rough numbers from
+# instruction counts of the decoders, tune them against the load times the game logs with
+# PUPPYPRINT_DEBUG.
+DECODE_CYCLES_PER_BYTE = {
+    "uncomp": 1.5, # bcopy out of the DMA buffer
+    "lz4": 6,
+    "yay0": 12,
+    "mio0": 13,
+    "rnc2": 30,
+    "rnc1": 40,
+    "gzip": 60,
+}
+
+# The tag each format's output has to start with
+FORMAT_TAGS = {
+    "uncomp": b"RAW0",
+    "lz4": b"LZ4S",
+    "yay0": b"Yay0",
+    "mio0": b"MIO0",
+    "rnc2": b"RNC\x02",
+    "rnc1": b"RNC\x01",
+    "gzip": b"GZIP",
+}
+
+HEADER_LENGTH = 16
+
+
+def load_time_us(fmt, raw_size, encoded_size):
+    dma = encoded_size * 1000000.0 / PI_BYTES_PER_SEC
+    decode = raw_size * DECODE_CYCLES_PER_BYTE[fmt] * 1000000.0 / CPU_HZ
+    return dma + decode
+
+
+def run_tool(cmd, out_path, stdout=None, cwd=None):
+    subprocess.run(cmd, check=True, stdout=stdout or subprocess.DEVNULL, cwd=cwd)
+    with open(out_path, "rb") as f:
+        return f.read()
+
+
+def encode(fmt, args, in_path, raw, tmp_dir):
+    out_path = os.path.join(tmp_dir, fmt)
+    if fmt == "yay0":
+        return run_tool([os.path.join(args.tools_dir, "slienc"), in_path, out_path], out_path)
+    if fmt == "mio0":
+        return run_tool([os.path.join(args.tools_dir, "mio0"), in_path, out_path], out_path)
+    if fmt == "lz4":
+        return run_tool([os.path.join(args.tools_dir, "lz4pack"), in_path, out_path], out_path)
+    if fmt in ("rnc1", "rnc2"):
+        # rncpack only writes to paths relative to the working directory
+        return run_tool([os.path.abspath(os.path.join(args.tools_dir, "rncpack")), "p", os.path.abspath(in_path), fmt,
+                         "-m" + fmt[-1]], out_path, cwd=tmp_dir)
+    if fmt == "gzip":
+        with open(out_path, "wb") as f:
+            gz = run_tool([args.gzip, "-c", "-" + args.gzip_level, "-n", in_path], out_path, stdout=f)
+        # Strip the 10 byte gzip header, inflate stops by itself at the end of the deflate stream
+        deflate = gz[10:]
+        return b"GZIP" + struct.pack(">III", len(raw), len(deflate), 0) + deflate
+    if fmt == "uncomp":
+        return b"RAW0" + struct.pack(">III", len(raw), 0, 0) + raw
+    raise ValueError("unknown format " + fmt)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pick the best compression format for one segment")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--weight", type=int, default=50,
+                        help="0 picks the smallest encoding, 100 the fastest to load")
+    parser.add_argument("--formats", default=" ".join(DECODE_CYCLES_PER_BYTE),
+                        help="space separated formats to try")
+    parser.add_argument("--tools-dir", default=os.path.dirname(os.path.abspath(__file__)))
+    parser.add_argument("--gzip", default="gzip")
+    parser.add_argument("--gzip-level", default="9")
+    args = parser.parse_args()
+
+    if not 0 <= args.weight <= 100:
+        sys.exit("weight must be between 0 and 100")
+
+    with open(args.input, "rb") as f:
+        raw = f.read()
+
+    raw_size = max(len(raw), 1)
+    raw_time = load_time_us("uncomp", raw_size, raw_size + HEADER_LENGTH)
+    results = []
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for fmt in args.formats.split():
+            if fmt not in DECODE_CYCLES_PER_BYTE:
+                sys.exit("unknown format " + fmt)
+            try:
+                data = encode(fmt, args, args.input, raw, tmp_dir)
+            except (OSError, subprocess.CalledProcessError):
+                # Some encoders refuse tiny inputs, the other formats still cover them
+                continue
+            if data[:4] != FORMAT_TAGS[fmt]:
+                continue
+            time = load_time_us(fmt, len(raw), len(data))
+            score = (100 - args.weight) * len(data) / raw_size + args.weight * time / raw_time
+            results.append((score, fmt, data, time))
+
+    if not results:
+        sys.exit("no format could encode " + args.input)
+    score, fmt, data, time = min(results, key=lambda r: r[0])
+
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    # Keep what every format did, for make compress-report
+    with open(args.output + ".auto", "w") as f:
+        f.write("%s raw %d picked %s" % (args.input, len(raw), fmt))
+        for r in results:
+            f.write(" | %s %d %dus" % (r[1], len(r[2]), r[3]))
+        f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
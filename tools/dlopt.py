@@ -0,0 +1,598 @@
+#!/usr/bin/env python3
+
+# dlopt: shortens the static display lists in model .inc.c files without changing what they draw.
+#
+#  - State commands that set what is already set are dropped: combine and render modes, other
+#    mode bits, colors, geometry mode, texture image, tiles, tile sizes and texture loads.
+#    Every display list is assumed to start with unknown state, and calls to display lists in
+#    the same file are followed, so a call to a material that is already fully set up is dropped
+#    as well.
+#  - Vertex loads of consecutive ranges of the same array are merged into one larger load when
+#    the vertex buffer has room, and the triangles after them are renumbered.
+#  - Pairs of gsSP1Triangle become gsSP2Triangles.
+#
+# Triangles are never reordered: the draw order is visible on blended and decal layers and
+# wherever triangles overlap, so a reordered display list would not draw the same image.
+#
+# Every change is checked by replaying the display list: each triangle must still resolve to the
+# same vertices, loaded with the same transform and lighting state. Files where a display list
+# draws with vertices it didn't load itself are left alone by the vertex merge, since they rely
+# on what the caller left in the vertex buffer.
+#
+# Usage: dlopt.py [--write] [--vertex-buffer N] FILE_OR_DIR...
+# Without --write it only prints the report.
+
+import argparse, os, re, sys
+
+# Gfx words of the macros that expand to more than one command
+MACRO_WORDS = {
+    "gsDPLoadTextureBlock": 7,
+    "gsDPLoadTextureBlock_4b": 7,
+    "gsDPLoadTextureBlockS": 7,
+    "gsDPLoadTextureBlock_4bS": 7,
+    "gsDPLoadTextureTile": 7,
+    "gsDPLoadTextureTile_4b": 7,
+    "gsDPLoadMultiBlock": 7,
+    "gsDPLoadMultiBlock_4b": 7,
+    "gsDPLoadMultiBlockS": 7,
+    "gsDPLoadMultiBlock_4bS": 7,
+    "gsDPLoadMultiTile": 7,
+    "gsDPLoadMultiTile_4b": 7,
+    "gsDPLoadTLUT_pal16": 6,
+    "gsDPLoadTLUT_pal256": 6,
+    "gsDPLoadTLUT": 6,
+    "gsSPTextureRectangle": 3,
+    "gsSPTextureRectangleFlip": 3,
+    "gsSPSetLights0": 3,
+    "gsSPSetLights1": 3,
+    "gsSPSetLights2": 4,
+    "gsSPSetLights3": 5,
+    "gsSPSetLights4": 6,
+    "gsSPSetLights5": 7,
+    "gsSPSetLights6": 8,
+    "gsSPSetLights7": 9,
+}
+
+# Commands that set one piece of state to a value given by all of their arguments
+SLOT_COMMANDS = {
+    "gsDPSetCombineMode": "combine",
+    "gsDPSetCombineLERP": "combine",
+    "gsDPSetRenderMode": "rendermode",
+    "gsDPSetCycleType": "cycletype",
+    "gsDPSetTextureFilter": "texturefilter",
+    "gsDPSetTextureLUT": "texturelut",
+    "gsDPSetTexturePersp": "texturepersp",
+    "gsDPSetTextureLOD": "texturelod",
+    "gsDPSetTextureDetail": "texturedetail",
+    "gsDPSetTextureConvert": "textureconvert",
+    "gsDPSetAlphaCompare": "alphacompare",
+    "gsDPSetDepthSource": "depthsource",
+    "gsDPSetCombineKey": "combinekey",
+    "gsDPSetColorDither": "colordither",
+    "gsDPSetAlphaDither": "alphadither",
+    "gsDPPipelineMode": "pipelinemode",
+    "gsDPSetEnvColor": "envcolor",
+    "gsDPSetPrimColor": "primcolor",
+    "gsDPSetFogColor": "fogcolor",
+    "gsDPSetBlendColor": "blendcolor",
+    "gsDPSetFillColor": "fillcolor",
+    "gsDPSetPrimDepth": "primdepth",
+    "gsSPTexture": "sptexture",
+    "gsSPFogPosition": "fogposition",
+    "gsSPFogFactor": "fogposition",
+}
+
+OTHER_MODE_SLOTS = ("rendermode", "cycletype", "texturefilter", "texturelut", "texturepersp", "texturelod",
+                    "texturedetail", "textureconvert", "alphacompare", "depthsource", "combinekey",
+                    "colordither", "alphadither", "pipelinemode")
+
+SYNC_COMMANDS = {"gsDPPipeSync", "gsDPLoadSync", "gsDPTileSync", "gsDPFullSync", "gsDPNoOp", "gsSPNoOp"}
+
+TRIANGLE_COMMANDS = {"gsSP1Triangle", "gsSP2Triangles", "gsSP1Quadrangle"}
+
+# Commands that draw or use the vertex buffer but leave the tracked state alone
+DRAW_COMMANDS = TRIANGLE_COMMANDS | {"gsSPVertex", "gsSPCullDisplayList", "gsDPFillRectangle",
+                                     "gsSPTextureRectangle", "gsSPTextureRectangleFlip"}
+
+LOAD_COMMANDS = {"gsDPLoadBlock", "gsDPLoadTile", "gsDPLoadTLUTCmd"}
+
+# Single geometry mode bits, and the names that stand for several of them
+GEOMETRY_BITS = {"G_ZBUFFER", "G_SHADE", "G_TEXTURE_ENABLE", "G_SHADING_SMOOTH", "G_CULL_FRONT", "G_CULL_BACK",
+                 "G_FOG", "G_LIGHTING", "G_TEXTURE_GEN", "G_TEXTURE_GEN_LINEAR", "G_LOD", "G_CLIPPING",
+                 "G_LIGHTING_POSITIONAL"}
+GEOMETRY_ALIASES = {"G_CULL_BOTH": {"G_CULL_FRONT", "G_CULL_BACK"}}
+
+# Vertex processing state is read when vertices are loaded, so loads can't move across these.
+# Everything else starting with gsSP is treated the same way.
+RDP_ONLY_PREFIX = "gsDP"
+
+
+class Command:
+    def __init__(self, text):
+        self.text = text.strip()
+        m = re.match(r"^(\w+)\s*\((.*)\)$", self.text, re.S)
+        if m:
+            self.name = m.group(1)
+            self.args = split_top_level(m.group(2)) if m.group(2).strip() else []
+        else:
+            self.name = self.text
+            self.args = []
+
+    def words(self):
+        return MACRO_WORDS.get(self.name, 1)
+
+    def key(self):
+        return (self.name, tuple(self.args))
+
+
+def split_top_level(s):
+    parts, depth, start = [], 0, 0
+    for i, ch in enumerate(s):
+        if ch in "([{":
+            depth += 1
+        elif ch in ")]}":
+            depth -= 1
+        elif ch == "," and depth == 0:
+            parts.append(s[start:i].strip())
+            start = i + 1
+    parts.append(s[start:].strip())
+    return parts
+
+
+def make_command(name, args):
+    return Command("%s(%s)" % (name, ", ".join(args)))
+
+
+def is_padded(c):
+    # Vanilla display lists pad triangle indices to two columns, Fast64 doesn't
+    return re.search(r"\(\s+\d|,\s{2,}\d", c.text) is not None
+
+
+def format_index(i, padded):
+    return ("%2d" if padded else "%d") % i
+
+
+def parse_int(s):
+    try:
+        return int(s, 0)
+    except ValueError:
+        return None
+
+
+def tile_index(s):
+    if s == "G_TX_RENDERTILE":
+        return 0
+    if s == "G_TX_LOADTILE":
+        return 7
+    return parse_int(s)
+
+
+def parse_geometry_mask(s):
+    bits = set()
+    for token in s.replace("(", " ").replace(")", " ").split("|"):
+        token = token.strip()
+        if parse_int(token) == 0:
+            continue
+        if token in GEOMETRY_ALIASES:
+            bits |= GEOMETRY_ALIASES[token]
+        elif token in GEOMETRY_BITS:
+            bits.add(token)
+        else:
+            return None
+    return bits
+
+
+class State:
+    def __init__(self):
+        self.slots = {}
+        self.geo_on = set()
+        self.geo_off = set()
+
+    def copy(self):
+        s = State()
+        s.slots = dict(self.slots)
+        s.geo_on = set(self.geo_on)
+        s.geo_off = set(self.geo_off)
+        return s
+
+    def reset(self):
+        self.slots.clear()
+        self.geo_on.clear()
+        self.geo_off.clear()
+
+    def forget_textures(self):
+        for k in list(self.slots):
+            if k in ("teximg", "tmem", "texmacro") or (isinstance(k, tuple) and k[0] in ("tile", "tilesize")):
+                del self.slots[k]
+
+
+class DisplayListFile:
+    def __init__(self, path, text):
+        self.path = path
+        self.text = text
+        self.lists = {}   # name -> list of Command
+        self.spans = {}   # name -> (start, end, indent) of the body in text
+
+        pattern = re.compile(r"(?:static\s+)?(?:const\s+)?Gfx\s+(\w+)\s*\[\s*\w*\s*\]\s*=\s*\{\s*\n(.*?)\n\};", re.S)
+        for m in pattern.finditer(text):
+            body = m.group(2)
+            # Leave anything with comments or preprocessor lines alone
+            if "//" in body or "/*" in body or "#" in body:
+                continue
+            lines = [l for l in body.split("\n") if l.strip()]
+            indent = re.match(r"^\s*", lines[0]).group(0) if lines else "    "
+            cmds = [Command(c) for c in split_top_level(body) if c.strip()]
+            self.lists[m.group(1)] = cmds
+            self.spans[m.group(1)] = (m.start(2), m.end(2), indent)
+
+    def write(self, optimized):
+        out = self.text
+        # Replace from the end so earlier spans stay valid
+        for name in sorted(optimized, key=lambda n: self.spans[n][0], reverse=True):
+            start, end, indent = self.spans[name]
+            body = "\n".join(indent + c.text + "," for c in optimized[name])
+            out = out[:start] + body + out[end:]
+        return out
+
+
+class Stats:
+    def __init__(self):
+        self.words_before = 0
+        self.words_after = 0
+        self.state_removed = 0
+        self.calls_removed = 0
+        self.loads_merged = 0
+        self.tris_paired = 0
+        self.lists = 0
+
+    def add(self, other):
+        for k in vars(self):
+            setattr(self, k, getattr(self, k) + getattr(other, k))
+
+
+def run_state(cmds, state, dlfile, depth, keep=None):
+    """
+    Step state through cmds. If keep is given, clears the entries of commands that change nothing.
+    Returns (state, pure) where pure is True if cmds only set state, False if they draw or do
+    something that isn't understood, and None if the list ends with a branch or runs off the end.
+    """
+    pure = True
+    for i, c in enumerate(cmds):
+        redundant = False
+        n = c.name
+
+        if n in SYNC_COMMANDS:
+            pass
+        elif n in DRAW_COMMANDS or n in ("gsSPMatrix", "gsSPPopMatrix"):
+            pure = False
+        elif n == "gsSPEndDisplayList":
+            return state, pure
+        elif n in SLOT_COMMANDS:
+            slot = SLOT_COMMANDS[n]
+            redundant = state.slots.get(slot) == c.key()
+            state.slots[slot] = c.key()
+            if slot in OTHER_MODE_SLOTS:
+                state.slots.pop("othermode", None)
+        elif n == "gsDPSetOtherMode":
+            redundant = state.slots.get("othermode") == c.key()
+            for slot in OTHER_MODE_SLOTS:
+                state.slots.pop(slot, None)
+            state.slots["othermode"] = c.key()
+        elif n == "gsDPSetTextureImage":
+            redundant = state.slots.get("teximg") == c.key()
+            state.slots["teximg"] = c.key()
+            state.slots.pop("texmacro", None)
+        elif n == "gsDPSetTile" and len(c.args) == 12 and tile_index(c.args[4]) is not None:
+            slot = ("tile", tile_index(c.args[4]))
+            redundant = state.slots.get(slot) == c.key()
+            state.slots[slot] = c.key()
+            state.slots.pop("texmacro", None)
+        elif n == "gsDPSetTileSize" and len(c.args) == 5 and tile_index(c.args[0]) is not None:
+            slot = ("tilesize", tile_index(c.args[0]))
+            redundant = state.slots.get(slot) == c.key()
+            state.slots[slot] = c.key()
+            state.slots.pop("texmacro", None)
+        elif n in LOAD_COMMANDS and c.args and tile_index(c.args[0]) is not None:
+            tile = tile_index(c.args[0])
+            teximg = state.slots.get("teximg")
+            desc = state.slots.get(("tile", tile))
+            if teximg is None or desc is None:
+                state.slots.pop("tmem", None)
+                state.slots.pop(("tilesize", tile), None)
+            else:
+                # Loads also set the tile's size registers, so those have to match the last load too
+                key = ("load", teximg, desc, c.key())
+                redundant = state.slots.get("tmem") == key and state.slots.get(("tilesize", tile)) == key
+                state.slots["tmem"] = key
+                state.slots[("tilesize", tile)] = key
+            state.slots.pop("texmacro", None)
+        elif n in MACRO_WORDS and n.startswith("gsDPLoad"):
+            redundant = state.slots.get("texmacro") == c.key()
+            state.forget_textures()
+            state.slots["texmacro"] = c.key()
+        elif n in ("gsSPSetGeometryMode", "gsSPClearGeometryMode") and len(c.args) == 1:
+            bits = parse_geometry_mask(c.args[0])
+            if bits is None:
+                state.geo_on.clear()
+                state.geo_off.clear()
+            elif n == "gsSPSetGeometryMode":
+                redundant = bits <= state.geo_on
+                state.geo_on |= bits
+                state.geo_off -= bits
+            else:
+                redundant = bits <= state.geo_off
+                state.geo_off |= bits
+                state.geo_on -= bits
+        elif n == "gsSPGeometryMode" and len(c.args) == 2:
+            clear_bits = parse_geometry_mask(c.args[0])
+            set_bits = parse_geometry_mask(c.args[1])
+            if clear_bits is None or set_bits is None:
+                state.geo_on.clear()
+                state.geo_off.clear()
+            else:
+                redundant = set_bits <= state.geo_on and (clear_bits - set_bits) <= state.geo_off
+                state.geo_on = (state.geo_on - clear_bits) | set_bits
+                state.geo_off = (state.geo_off | clear_bits) - set_bits
+        elif re.match(r"^gsSPSetLights\d$", n):
+            redundant = state.slots.get("lights") == c.key()
+            state.slots["lights"] = c.key()
+        elif n in ("gsSPLight", "gsSPNumLights", "gsSPLightColor"):
+            state.slots.pop("lights", None)
+        elif n in ("gsSPDisplayList", "gsSPBranchList") and len(c.args) == 1:
+            callee = dlfile.lists.get(c.args[0])
+            if callee is None or depth >= 8:
+                state.reset()
+                return state, False if n == "gsSPDisplayList" else None
+            before = state.copy()
+            callee_keep = [True] * len(callee)
+            state, callee_pure = run_state(callee, state, dlfile, depth + 1, callee_keep)
+            if n == "gsSPBranchList":
+                # The branch ends this list too
+                return state, (pure and callee_pure) if callee_pure is not None else None
+            if callee_pure is None:
+                state.reset()
+                pure = False
+            elif callee_pure and not any(k and callee[j].name not in SYNC_COMMANDS
+                                         and callee[j].name != "gsSPEndDisplayList"
+                                         for j, k in enumerate(callee_keep)):
+                # Everything the call would set is already set
+                redundant = True
+                state = before
+            elif not callee_pure:
+                pure = False
+        else:
+            state.reset()
+            pure = False
+
+        if keep is not None and redundant:
+            keep[i] = False
+
+    return state, None
+
+
+def remove_redundant_state(cmds, dlfile, stats):
+    keep = [True] * len(cmds)
+    run_state(cmds, State(), dlfile, 0, keep)
+    out = []
+    for c, k in zip(cmds, keep):
+        if k:
+            out.append(c)
+        elif c.name == "gsSPDisplayList":
+            stats.calls_removed += 1
+        else:
+            stats.state_removed += 1
+    return out
+
+
+def parse_vertex_source(s):
+    s = s.strip()
+    m = re.match(r"^(\w+)$", s)
+    if m:
+        return m.group(1), 0
+    m = re.match(r"^(\w+)\s*\+\s*(\d+)$", s)
+    if m:
+        return m.group(1), int(m.group(2))
+    m = re.match(r"^&\s*(\w+)\s*\[\s*(\d+)\s*\]$", s)
+    if m:
+        return m.group(1), int(m.group(2))
+    return None
+
+
+def vertex_trace(cmds):
+    """
+    Replay the vertex buffer and return, in order, the vertices each triangle ends up using.
+    A vertex is identified by its source and the vertex processing state it was loaded with.
+    Slots never loaded here show up as ("init", slot).
+    """
+    buf = {}
+    epoch = 0
+    calls = 0
+    trace = []
+
+    def slot(i):
+        return buf.get(i, ("init", i))
+
+    for c in cmds:
+        n = c.name
+        if n == "gsSPVertex" and len(c.args) == 3:
+            src = parse_vertex_source(c.args[0])
+            count, v0 = parse_int(c.args[1]), parse_int(c.args[2])
+            if count is None or v0 is None:
+                return None
+            for i in range(count):
+                buf[v0 + i] = ((src[0], src[1] + i) if src else (c.args[0], i), epoch)
+        elif n in TRIANGLE_COMMANDS or n == "gsSPCullDisplayList":
+            idx = [parse_int(a) for a in c.args]
+            if n == "gsSP1Triangle":
+                idx = idx[:3]
+            elif n == "gsSP2Triangles":
+                idx = idx[:3] + idx[4:7]
+            elif n == "gsSP1Quadrangle":
+                idx = idx[:4]
+            if any(i is None for i in idx):
+                return None
+            trace.append((n, tuple(slot(i) for i in idx)))
+        elif n in ("gsSPDisplayList", "gsSPBranchList"):
+            # The callee may load or draw anything, so every slot now depends on the call
+            calls += 1
+            epoch += 1
+            buf = {i: ("call", calls, slot(i)) for i in range(64)}
+            trace.append((n, tuple(c.args)))
+        elif n == "gsSPModifyVertex":
+            return None
+        elif not n.startswith(RDP_ONLY_PREFIX) and n not in SYNC_COMMANDS and n != "gsSPEndDisplayList":
+            epoch += 1
+    return trace
+
+
+def uses_caller_vertices(cmds):
+    trace = vertex_trace(cmds)
+    if trace is None:
+        return True
+    for entry in trace:
+        for v in entry[1]:
+            while isinstance(v, tuple) and v and v[0] == "call":
+                v = v[2]
+            if isinstance(v, tuple) and v and v[0] == "init":
+                return True
+    return False
+
+
+def renumber_triangle(c, mapping):
+    idx_pos = {"gsSP1Triangle": (0, 1, 2), "gsSP2Triangles": (0, 1, 2, 4, 5, 6),
+               "gsSP1Quadrangle": (0, 1, 2, 3)}[c.name]
+    args = list(c.args)
+    padded = is_padded(c)
+    for p in idx_pos:
+        i = parse_int(args[p])
+        args[p] = format_index(mapping.get(i, i), padded)
+    return make_command(c.name, args)
+
+
+def merge_vertex_loads(cmds, vertex_buffer, stats):
+    reference = vertex_trace(cmds)
+    if reference is None:
+        return cmds
+
+    loads = [i for i, c in enumerate(cmds) if c.name == "gsSPVertex"]
+    if len(loads) < 2:
+        return cmds
+
+    cmds = list(cmds)
+    first = 0
+    while first < len(loads) - 1:
+        p, q = loads[first], loads[first + 1]
+        a, b = cmds[p], cmds[q]
+        src_a, src_b = parse_vertex_source(a.args[0]), parse_vertex_source(b.args[0])
+        n_a, v0_a = parse_int(a.args[1]), parse_int(a.args[2])
+        n_b, v0_b = parse_int(b.args[1]), parse_int(b.args[2])
+        if (src_a is None or src_b is None or None in (n_a, v0_a, n_b, v0_b)
+                or src_a[0] != src_b[0] or src_b[1] != src_a[1] + n_a or v0_a + n_a + n_b > vertex_buffer):
+            first += 1
+            continue
+
+        # Load both ranges at once, with the second one right after the first in the buffer
+        mapping = {v0_b + i: v0_a + n_a + i for i in range(n_b)}
+        end = loads[first + 2] if first + 2 < len(loads) else len(cmds)
+        candidate = cmds[:p] + [make_command("gsSPVertex", [a.args[0], str(n_a + n_b), a.args[2]])] + cmds[p + 1:q]
+        candidate += [renumber_triangle(c, mapping) if c.name in TRIANGLE_COMMANDS else c for c in cmds[q + 1:end]]
+        candidate += cmds[end:]
+
+        if vertex_trace(candidate) == reference:
+            cmds = candidate
+            stats.loads_merged += 1
+            # One command fewer, keep trying to grow the merged load
+            loads = [i for i, c in enumerate(cmds) if c.name == "gsSPVertex"]
+        else:
+            first += 1
+
+    return cmds
+
+
+def pair_triangles(cmds, stats):
+    out = []
+    for c in cmds:
+        if (c.name == "gsSP1Triangle" and out and out[-1].name == "gsSP1Triangle"
+                and len(c.args) == 4 and len(out[-1].args) == 4):
+            prev = out.pop()
+            padded = is_padded(prev)
+            args = [format_index(parse_int(a), padded) if j % 4 != 3 and parse_int(a) is not None else a
+                    for j, a in enumerate(prev.args + c.args)]
+            out.append(make_command("gsSP2Triangles", args))
+            stats.tris_paired += 1
+        else:
+            out.append(c)
+    return out
+
+
+def count_words(cmds):
+    return sum(c.words() for c in cmds)
+
+
+def optimize_file(path, args):
+    with open(path) as f:
+        text = f.read()
+    dlfile = DisplayListFile(path, text)
+    stats = Stats()
+    if not dlfile.lists:
+        return None
+
+    can_merge = not any(uses_caller_vertices(cmds) for cmds in dlfile.lists.values())
+    optimized = {}
+
+    for name, cmds in dlfile.lists.items():
+        before = count_words(cmds)
+        new = remove_redundant_state(cmds, dlfile, stats)
+        if can_merge:
+            new = merge_vertex_loads(new, args.vertex_buffer, stats)
+        new = pair_triangles(new, stats)
+        after = count_words(new)
+        stats.lists += 1
+        stats.words_before += before
+        stats.words_after += after
+        if [c.text for c in new] != [c.text for c in cmds]:
+            optimized[name] = new
+
+    if args.write and optimized:
+        with open(path, "w") as f:
+            f.write(dlfile.write(optimized))
+    return stats
+
+
+def print_stats(name, s):
+    saved = 100.0 * (s.words_before - s.words_after) / s.words_before if s.words_before else 0.0
+    print("%-60s %5d %7d %7d %6.2f%% %6d %6d %6d %6d" % (name, s.lists, s.words_before, s.words_after, saved,
+                                                       s.state_removed, s.calls_removed, s.loads_merged,
+                                                       s.tris_paired))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Remove redundant commands from model display lists")
+    parser.add_argument("paths", nargs="+", help="model .c files or directories to search for them")
+    parser.add_argument("--write", action="store_true", help="rewrite the files instead of only reporting")
+    parser.add_argument("--vertex-buffer", type=int, default=32, help="vertex buffer size of the microcode")
+    args = parser.parse_args()
+
+    files = []
+    for p in args.paths:
+        if os.path.isdir(p):
+            for root, _, names in os.walk(p):
+                files += [os.path.join(root, n) for n in sorted(names) if n.endswith(".c")]
+        else:
+            files.append(p)
+
+    print("%-60s %5s %7s %7s %7s %6s %6s %6s %6s" % ("file", "DLs", "before", "after", "saved", "state",
+                                                    "calls", "vtx", "tris"))
+    total = Stats()
+    for path in sorted(files):
+        stats = optimize_file(path, args)
+        if stats is None:
+            continue
+        if stats.words_after != stats.words_before:
+            print_stats(path, stats)
+        total.add(stats)
+    print_stats("total", total)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,389 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "liblz4.h"
+#include "utils.h"
+
+// defines
+
+#define HASH_BITS 16
+#define HASH_SIZE (1 << HASH_BITS)
+#define NO_POS    -1
+
+// How many earlier positions with the same hash are checked per byte. The window is
+// 16 times larger than Yay0's, so this is lower than liblzss to keep encoding fast.
+#define MAX_CHAIN 256
+
+#define MAX_OFFSET (LZ4S_WINDOW_SIZE - 1)
+
+// Limits from the LZ4 block format, so the output also decodes with any standard
+// LZ4 decoder: the last match has to start 12 bytes before the end and the last
+// 5 bytes are always literals.
+#define MATCH_START_LIMIT 12
+#define LAST_LITERALS     5
+
+// The optimal parser tries every length up to this for each match, plus the longest.
+// Longer matches only get cheaper per byte, so shorter ones matter only to make room
+// for a better match right after.
+#define OPTIMAL_SHORT_LENGTHS 64
+
+// types
+
+typedef struct
+{
+   int head[HASH_SIZE];
+   int prev[LZ4S_WINDOW_SIZE];
+} match_finder;
+
+typedef struct
+{
+   unsigned int length;   // 1 for a literal
+   unsigned int distance; // 0 for a literal
+} lz4s_token;
+
+// functions
+
+static inline unsigned int hash4(const unsigned char *p)
+{
+   return ((unsigned int)(p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void finder_init(match_finder *mf)
+{
+   for (int i = 0; i < HASH_SIZE; i++) {
+      mf->head[i] = NO_POS;
+   }
+}
+
+static inline void finder_insert(match_finder *mf, const unsigned char *in, unsigned int length, int pos)
+{
+   if (pos + LZ4S_MIN_MATCH <= (int)length) {
+      unsigned int h = hash4(&in[pos]);
+      mf->prev[pos & (LZ4S_WINDOW_SIZE - 1)] = mf->head[h];
+      mf->head[h] = pos;
+   }
+}
+
+// find the longest match for pos among the positions inserted so far
+// returns match length (0 if shorter than LZ4S_MIN_MATCH) and sets *distance
+static int finder_longest(const match_finder *mf, const unsigned char *in, unsigned int length, int pos,
+                          int *distance)
+{
+   int best_length = 0;
+   int farthest = pos - MAX_OFFSET;
+   int chain = MAX_CHAIN;
+   int max_length = (int)length - LAST_LITERALS - pos;
+   int cand;
+
+   if (pos + MATCH_START_LIMIT > (int)length || max_length < LZ4S_MIN_MATCH) {
+      return 0;
+   }
+
+   cand = mf->head[hash4(&in[pos])];
+   while (cand != NO_POS && cand >= farthest && chain-- > 0) {
+      if (in[cand + best_length] == in[pos + best_length]) {
+         int len = 0;
+         while (len < max_length && in[cand + len] == in[pos + len]) {
+            len++;
+         }
+         if (len > best_length) {
+            best_length = len;
+            *distance = pos - cand;
+            if (len == max_length) {
+               break;
+            }
+         }
+      }
+      int next = mf->prev[cand & (LZ4S_WINDOW_SIZE - 1)];
+      if (next >= cand) {
+         break;
+      }
+      cand = next;
+   }
+
+   return (best_length >= LZ4S_MIN_MATCH) ? best_length : 0;
+}
+
+// extra bytes needed to store a length beyond its 4-bit nibble
+static inline unsigned int length_ext_bytes(unsigned int nibble_value)
+{
+   return (nibble_value < 15) ? 0 : 1 + (nibble_value - 15) / 255;
+}
+
+// encoded size in bytes of a match: token, offset and length extension
+// Literals cost one byte each. The extension bytes of long literal runs aren't counted,
+// they're rare enough that it makes no difference to the parse.
+static inline unsigned int match_cost(unsigned int match_length)
+{
+   return 1 + 2 + length_ext_bytes(match_length - LZ4S_MIN_MATCH);
+}
+
+static int parse_lazy(const unsigned char *in, unsigned int length, lz4s_token *tokens)
+{
+   match_finder *mf = malloc(sizeof(*mf));
+   int count = 0;
+   unsigned int pos = 0;
+
+   if (mf == NULL) {
+      return -1;
+   }
+   finder_init(mf);
+
+   while (pos < length) {
+      int distance = 0;
+      int match = finder_longest(mf, in, length, pos, &distance);
+      finder_insert(mf, in, length, pos);
+      if (match > 0) {
+         int next_distance = 0;
+         int next_match = finder_longest(mf, in, length, pos + 1, &next_distance);
+         if (next_match > match + 1) {
+            tokens[count].length = 1;
+            tokens[count].distance = 0;
+            count++;
+            pos++;
+            finder_insert(mf, in, length, pos);
+            match = next_match;
+            distance = next_distance;
+         }
+         tokens[count].length = match;
+         tokens[count].distance = distance;
+         count++;
+         for (int i = 1; i < match; i++) {
+            finder_insert(mf, in, length, pos + i);
+         }
+         pos += match;
+      } else {
+         tokens[count].length = 1;
+         tokens[count].distance = 0;
+         count++;
+         pos++;
+      }
+   }
+
+   free(mf);
+   return count;
+}
+
+// Same backward pass as the liblzss optimal parser: the offset always costs two bytes,
+// so only the longest match at each position is needed.
+static int parse_optimal(const unsigned char *in, unsigned int length, lz4s_token *tokens)
+{
+   match_finder *mf = malloc(sizeof(*mf));
+   unsigned int *match_length = malloc(length * sizeof(*match_length));
+   unsigned short *match_distance = malloc(length * sizeof(*match_distance));
+   unsigned int *cost = malloc((length + 1) * sizeof(*cost));
+   unsigned int *choice = malloc(length * sizeof(*choice));
+   int count = -1;
+
+   if (mf == NULL || match_length == NULL || match_distance == NULL || cost == NULL || choice == NULL) {
+      goto free_all;
+   }
+   finder_init(mf);
+
+   for (unsigned int pos = 0; pos < length; pos++) {
+      int distance = 0;
+      // Inside a long match the rest of it is still a match at the same distance. Searching
+      // again there is quadratic on long runs, and finds at most a slightly longer match.
+      if (pos > 0 && match_length[pos - 1] > OPTIMAL_SHORT_LENGTHS) {
+         match_length[pos] = match_length[pos - 1] - 1;
+         match_distance[pos] = match_distance[pos - 1];
+      } else {
+         match_length[pos] = finder_longest(mf, in, length, pos, &distance);
+         match_distance[pos] = distance;
+      }
+      finder_insert(mf, in, length, pos);
+   }
+
+   cost[length] = 0;
+   for (int pos = length - 1; pos >= 0; pos--) {
+      unsigned int longest = match_length[pos];
+      unsigned int best_cost = 1 + cost[pos + 1];
+      unsigned int best_length = 1;
+      if (longest >= LZ4S_MIN_MATCH) {
+         unsigned int c = match_cost(longest) + cost[pos + longest];
+         if (c < best_cost) {
+            best_cost = c;
+            best_length = longest;
+         }
+         for (int len = MIN(longest - 1, OPTIMAL_SHORT_LENGTHS); len >= LZ4S_MIN_MATCH; len--) {
+            c = match_cost(len) + cost[pos + len];
+            if (c < best_cost) {
+               best_cost = c;
+               best_length = len;
+            }
+         }
+      }
+      cost[pos] = best_cost;
+      choice[pos] = best_length;
+   }
+
+   count = 0;
+   for (unsigned int pos = 0; pos < length; pos += choice[pos]) {
+      tokens[count].length = choice[pos];
+      tokens[count].distance = (choice[pos] > 1) ? match_distance[pos] : 0;
+      count++;
+   }
+
+free_all:
+   free(mf);
+   free(match_length);
+   free(match_distance);
+   free(cost);
+   free(choice);
+   return count;
+}
+
+static unsigned char *write_length_ext(unsigned char *out, unsigned int nibble_value)
+{
+   if (nibble_value >= 15) {
+      nibble_value -= 15;
+      while (nibble_value >= 255) {
+         *out++ = 255;
+         nibble_value -= 255;
+      }
+      *out++ = nibble_value;
+   }
+   return out;
+}
+
+static unsigned char *write_sequence(unsigned char *out, const unsigned char *literals, unsigned int literal_length,
+                                     const lz4s_token *match)
+{
+   unsigned int match_nibble = (match != NULL) ? match->length - LZ4S_MIN_MATCH : 0;
+
+   *out++ = (MIN(literal_length, 15) << 4) | MIN(match_nibble, 15);
+   out = write_length_ext(out, literal_length);
+   memcpy(out, literals, literal_length);
+   out += literal_length;
+   if (match != NULL) {
+      *out++ = match->distance & 0xFF;
+      *out++ = match->distance >> 8;
+      out = write_length_ext(out, match_nibble);
+   }
+   return out;
+}
+
+int lz4s_encode(const unsigned char *in, unsigned int length, lz4s_parse_mode mode, unsigned char *out)
+{
+   // at most one token per byte
+   lz4s_token *tokens = malloc(MAX(length, 1) * sizeof(*tokens));
+   unsigned char *dest = &out[LZ4S_HEADER_LENGTH];
+   unsigned int literal_start = 0;
+   unsigned int pos = 0;
+   int count;
+
+   if (tokens == NULL) {
+      return -1;
+   }
+
+   if (mode == LZ4S_PARSE_OPTIMAL) {
+      count = parse_optimal(in, length, tokens);
+   } else {
+      count = parse_lazy(in, length, tokens);
+   }
+   if (count < 0) {
+      free(tokens);
+      return count;
+   }
+
+   for (int i = 0; i < count; i++) {
+      if (tokens[i].length > 1) {
+         dest = write_sequence(dest, &in[literal_start], pos - literal_start, &tokens[i]);
+         literal_start = pos + tokens[i].length;
+      }
+      pos += tokens[i].length;
+   }
+   // the last sequence is only literals, which is what tells the decoder it is done
+   if (length > 0) {
+      dest = write_sequence(dest, &in[literal_start], length - literal_start, NULL);
+   }
+
+   memcpy(out, "LZ4S", 4);
+   write_u32_be(&out[4], length);
+   write_u32_be(&out[8], dest - &out[LZ4S_HEADER_LENGTH]);
+   memset(&out[12], 0, 4);
+
+   free(tokens);
+   return dest - out;
+}
+
+int lz4s_decoded_size(const unsigned char *in, unsigned int in_size, unsigned int *size)
+{
+   if (in_size < LZ4S_HEADER_LENGTH || memcmp(in, "LZ4S", 4)) {
+      return 0;
+   }
+   *size = read_u32_be(&in[4]);
+   return 1;
+}
+
+// read the extension bytes of a length whose nibble was 15
+// returns 0 if the data ends first
+static int read_length_ext(const unsigned char *in, unsigned int in_size, unsigned int *idx, unsigned int *value)
+{
+   unsigned int byte;
+
+   do {
+      if (*idx >= in_size) {
+         return 0;
+      }
+      byte = in[(*idx)++];
+      *value += byte;
+   } while (byte == 255);
+   return 1;
+}
+
+int lz4s_decode(const unsigned char *in, unsigned int in_size, unsigned char *out, unsigned int out_size)
+{
+   unsigned int dest_size, payload_end;
+   unsigned int idx = LZ4S_HEADER_LENGTH;
+   unsigned int written = 0;
+
+   if (!lz4s_decoded_size(in, in_size, &dest_size) || dest_size > out_size) {
+      return -1;
+   }
+   payload_end = LZ4S_HEADER_LENGTH + read_u32_be(&in[8]);
+   if (payload_end > in_size) {
+      return -2;
+   }
+
+   while (written < dest_size) {
+      unsigned int token, literal_length, match_length, distance;
+
+      if (idx >= payload_end) {
+         return -2;
+      }
+      token = in[idx++];
+      literal_length = token >> 4;
+      if (literal_length == 15 && !read_length_ext(in, payload_end, &idx, &literal_length)) {
+         return -2;
+      }
+      if (idx + literal_length > payload_end || written + literal_length > dest_size) {
+         return -2;
+      }
+      memcpy(&out[written], &in[idx], literal_length);
+      idx += literal_length;
+      written += literal_length;
+      if (written == dest_size) {
+         break;
+      }
+
+      if (idx + 2 > payload_end) {
+         return -2;
+      }
+      distance = in[idx] | (in[idx + 1] << 8);
+      idx += 2;
+      match_length = token & 0xF;
+      if (match_length == 15 && !read_length_ext(in, payload_end, &idx, &match_length)) {
+         return -2;
+      }
+      match_length += LZ4S_MIN_MATCH;
+      if (distance == 0 || distance > written || written + match_length > dest_size) {
+         return -3;
+      }
+      for (unsigned int i = 0; i < match_length; i++, written++) {
+         out[written] = out[written - distance];
+      }
+   }
+
+   return written;
+}
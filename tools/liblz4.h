@@ -0,0 +1,47 @@
+#ifndef LIBLZ4_H_
+#define LIBLZ4_H_
+
+// Encoder for LZ4S, the LZ4 block format behind a 16 byte header that keeps the
+// decoded size at the same offset as Yay0 and MIO0. LZ4 stores literals and matches
+// as byte aligned runs with no control bits, which compresses a bit worse than Yay0
+// but decodes with far fewer instructions per byte. Nothing here uses globals.
+
+// defines
+
+#define LZ4S_HEADER_LENGTH 16
+#define LZ4S_WINDOW_SIZE   65536
+#define LZ4S_MIN_MATCH     4
+
+// worst case encoded size of 'length' bytes, for sizing output buffers
+#define LZ4S_MAX_ENCODED_SIZE(length) (LZ4S_HEADER_LENGTH + (length) + (length) / 255 + 16)
+
+// typedefs
+
+typedef enum
+{
+   // longest match with one byte of lookahead
+   LZ4S_PARSE_LAZY,
+   // picks the sequence of literals and matches with the smallest encoded size
+   LZ4S_PARSE_OPTIMAL,
+} lz4s_parse_mode;
+
+// function prototypes
+
+// encode data in memory
+// in: buffer containing raw data
+// out: buffer of at least LZ4S_MAX_ENCODED_SIZE(length) bytes
+// returns size of encoded data in 'out' including header, or negative value on failure
+int lz4s_encode(const unsigned char *in, unsigned int length, lz4s_parse_mode mode, unsigned char *out);
+
+// decode LZ4S data in memory, checking every reference
+// in: buffer containing encoded data including header
+// in_size: size of 'in'
+// out: buffer of at least 'out_size' bytes
+// returns bytes written to 'out' or negative value on failure
+int lz4s_decode(const unsigned char *in, unsigned int in_size, unsigned char *out, unsigned int out_size);
+
+// get the decoded size from an LZ4S header
+// returns 1 if valid header, 0 otherwise
+int lz4s_decoded_size(const unsigned char *in, unsigned int in_size, unsigned int *size);
+
+#endif // LIBLZ4_H_
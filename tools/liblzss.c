@@ -0,0 +1,424 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "liblzss.h"
+#include "utils.h"
+
+// defines
+
+#define HASH_BITS 15
+#define HASH_SIZE (1 << HASH_BITS)
+#define NO_POS    -1
+
+// How many earlier positions with the same hash are checked per byte. The window
+// only holds 4096 positions, so this is rarely reached outside of very repetitive data.
+#define MAX_CHAIN 1024
+
+#define YAY0_MAX_MATCH 0x111 // 15 lengths in the nibble, then 256 in an extra byte
+#define MIO0_MAX_MATCH 0x12
+
+// types
+
+// Hash chains over the last LZSS_WINDOW_SIZE positions. head holds the newest
+// position for each hash of the next 3 bytes, prev links each position to the
+// previous one with the same hash.
+typedef struct
+{
+   int head[HASH_SIZE];
+   int prev[LZSS_WINDOW_SIZE];
+} match_finder;
+
+// functions
+
+static inline unsigned int hash3(const unsigned char *p)
+{
+   return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void finder_init(match_finder *mf)
+{
+   for (int i = 0; i < HASH_SIZE; i++) {
+      mf->head[i] = NO_POS;
+   }
+}
+
+static inline void finder_insert(match_finder *mf, const unsigned char *in, unsigned int length, int pos)
+{
+   if (pos + LZSS_MIN_MATCH <= (int)length) {
+      unsigned int h = hash3(&in[pos]);
+      mf->prev[pos & (LZSS_WINDOW_SIZE - 1)] = mf->head[h];
+      mf->head[h] = pos;
+   }
+}
+
+// find the longest match for pos among the positions inserted so far
+// returns match length (0 if shorter than LZSS_MIN_MATCH) and sets *distance
+static int finder_longest(const match_finder *mf, const unsigned char *in, unsigned int length, int pos,
+                          int max_length, int *distance)
+{
+   int best_length = 0;
+   int farthest = pos - LZSS_WINDOW_SIZE;
+   int chain = MAX_CHAIN;
+   int cand;
+
+   max_length = MIN(max_length, (int)length - pos);
+   if (max_length < LZSS_MIN_MATCH) {
+      return 0;
+   }
+
+   cand = mf->head[hash3(&in[pos])];
+   while (cand != NO_POS && cand >= farthest && chain-- > 0) {
+      // check the byte that would make this match longer first, most candidates fail there
+      if (in[cand + best_length] == in[pos + best_length]) {
+         int len = 0;
+         while (len < max_length && in[cand + len] == in[pos + len]) {
+            len++;
+         }
+         if (len > best_length) {
+            best_length = len;
+            *distance = pos - cand;
+            if (len == max_length) {
+               break;
+            }
+         }
+      }
+      int next = mf->prev[cand & (LZSS_WINDOW_SIZE - 1)];
+      // chains only ever point further back, anything else is a slot reused by a newer position
+      if (next >= cand) {
+         break;
+      }
+      cand = next;
+   }
+
+   return (best_length >= LZSS_MIN_MATCH) ? best_length : 0;
+}
+
+unsigned int lzss_max_match(lzss_format format)
+{
+   return (format == LZSS_FORMAT_YAY0) ? YAY0_MAX_MATCH : MIO0_MAX_MATCH;
+}
+
+// encoded size in bits of a literal or a match, including its control bit
+static inline unsigned int token_cost(lzss_format format, unsigned int match_length)
+{
+   if (match_length < LZSS_MIN_MATCH) {
+      return 1 + 8;
+   }
+   if (format == LZSS_FORMAT_YAY0 && match_length > 0x11) {
+      return 1 + 16 + 8;
+   }
+   return 1 + 16;
+}
+
+static int parse_lazy(const unsigned char *in, unsigned int length, lzss_format format, lzss_token *tokens)
+{
+   match_finder *mf = malloc(sizeof(*mf));
+   int max_match = lzss_max_match(format);
+   int count = 0;
+   unsigned int pos = 0;
+
+   if (mf == NULL) {
+      return -1;
+   }
+   finder_init(mf);
+
+   while (pos < length) {
+      int distance = 0;
+      int match = finder_longest(mf, in, length, pos, max_match, &distance);
+      finder_insert(mf, in, length, pos);
+      if (match > 0) {
+         int next_distance = 0;
+         int next_match = finder_longest(mf, in, length, pos + 1, max_match, &next_distance);
+         // a literal followed by a longer match is better, same rule as the old encoders
+         if (next_match > match + 1) {
+            tokens[count].length = 1;
+            tokens[count].distance = 0;
+            count++;
+            pos++;
+            finder_insert(mf, in, length, pos);
+            match = next_match;
+            distance = next_distance;
+         }
+         tokens[count].length = match;
+         tokens[count].distance = distance;
+         count++;
+         for (int i = 1; i < match; i++) {
+            finder_insert(mf, in, length, pos + i);
+         }
+         pos += match;
+      } else {
+         tokens[count].length = 1;
+         tokens[count].distance = 0;
+         count++;
+         pos++;
+      }
+   }
+
+   free(mf);
+   return count;
+}
+
+// Neither format charges more for a far reference than a near one, so the only thing
+// that matters at each position is the longest match: every shorter length is available
+// at the same distance. Walking backwards, cost[i] is the fewest bits needed to encode
+// everything from i to the end, which makes the parse optimal for this cost model.
+static int parse_optimal(const unsigned char *in, unsigned int length, lzss_format format, lzss_token *tokens)
+{
+   match_finder *mf = malloc(sizeof(*mf));
+   unsigned short *match_length = malloc(length * sizeof(*match_length));
+   unsigned short *match_distance = malloc(length * sizeof(*match_distance));
+   unsigned int *cost = malloc((length + 1) * sizeof(*cost));
+   unsigned short *choice = malloc(length * sizeof(*choice));
+   int max_match = lzss_max_match(format);
+   int count = -1;
+
+   if (mf == NULL || match_length == NULL || match_distance == NULL || cost == NULL || choice == NULL) {
+      goto free_all;
+   }
+   finder_init(mf);
+
+   for (unsigned int pos = 0; pos < length; pos++) {
+      int distance = 0;
+      match_length[pos] = finder_longest(mf, in, length, pos, max_match, &distance);
+      match_distance[pos] = distance;
+      finder_insert(mf, in, length, pos);
+   }
+
+   cost[length] = 0;
+   for (int pos = length - 1; pos >= 0; pos--) {
+      unsigned int best_cost = token_cost(format, 1) + cost[pos + 1];
+      unsigned int best_length = 1;
+      // longer matches first, so ties go to fewer tokens
+      for (int len = match_length[pos]; len >= LZSS_MIN_MATCH; len--) {
+         unsigned int c = token_cost(format, len) + cost[pos + len];
+         if (c < best_cost) {
+            best_cost = c;
+            best_length = len;
+         }
+      }
+      cost[pos] = best_cost;
+      choice[pos] = best_length;
+   }
+
+   count = 0;
+   for (unsigned int pos = 0; pos < length; pos += choice[pos]) {
+      tokens[count].length = choice[pos];
+      tokens[count].distance = (choice[pos] > 1) ? match_distance[pos] : 0;
+      count++;
+   }
+
+free_all:
+   free(mf);
+   free(match_length);
+   free(match_distance);
+   free(cost);
+   free(choice);
+   return count;
+}
+
+int lzss_parse(const unsigned char *in, unsigned int length, lzss_format format, lzss_parse_mode mode,
+               lzss_token **tokens)
+{
+   int count;
+
+   // at most one token per byte
+   *tokens = malloc(MAX(length, 1) * sizeof(**tokens));
+   if (*tokens == NULL) {
+      return -1;
+   }
+
+   if (mode == LZSS_PARSE_OPTIMAL) {
+      count = parse_optimal(in, length, format, *tokens);
+   } else {
+      count = parse_lazy(in, length, format, *tokens);
+   }
+
+   if (count < 0) {
+      free(*tokens);
+      *tokens = NULL;
+   }
+   return count;
+}
+
+static int write_yay0(const unsigned char *in, unsigned int length, const lzss_token *tokens, int count,
+                      unsigned char *out)
+{
+   unsigned int cmd_words = (count + 31) / 32;
+   unsigned int link_count = 0;
+   unsigned int chunk_count = 0;
+   unsigned int link_offset, chunk_offset;
+   unsigned char *cmd = &out[LZSS_HEADER_LENGTH];
+   unsigned char *link, *chunk;
+   unsigned int pos = 0;
+
+   for (int i = 0; i < count; i++) {
+      if (tokens[i].length > 1) {
+         link_count++;
+         if (tokens[i].length > 0x11) {
+            chunk_count++;
+         }
+      } else {
+         chunk_count++;
+      }
+   }
+
+   link_offset = LZSS_HEADER_LENGTH + cmd_words * 4;
+   chunk_offset = link_offset + link_count * 2;
+   link = &out[link_offset];
+   chunk = &out[chunk_offset];
+
+   memcpy(out, "Yay0", 4);
+   write_u32_be(&out[4], length);
+   write_u32_be(&out[8], link_offset);
+   write_u32_be(&out[12], chunk_offset);
+   memset(cmd, 0, cmd_words * 4);
+
+   for (int i = 0; i < count; i++) {
+      if (tokens[i].length > 1) {
+         unsigned int dist = tokens[i].distance - 1;
+         if (tokens[i].length > 0x11) {
+            write_u16_be(link, dist);
+            *chunk++ = tokens[i].length - 0x12;
+         } else {
+            write_u16_be(link, ((tokens[i].length - 2) << 12) | dist);
+         }
+         link += 2;
+      } else {
+         cmd[i / 8] |= 0x80 >> (i % 8);
+         *chunk++ = in[pos];
+      }
+      pos += tokens[i].length;
+   }
+
+   return chunk - out;
+}
+
+static int write_mio0(const unsigned char *in, unsigned int length, const lzss_token *tokens, int count,
+                      unsigned char *out)
+{
+   unsigned int bit_length = (count + 7) / 8;
+   unsigned int comp_count = 0;
+   unsigned int comp_offset, uncomp_offset;
+   unsigned char *bits = &out[LZSS_HEADER_LENGTH];
+   unsigned char *comp, *uncomp;
+   unsigned int pos = 0;
+
+   for (int i = 0; i < count; i++) {
+      if (tokens[i].length > 1) {
+         comp_count++;
+      }
+   }
+
+   // compressed data after control bits and aligned to 4-byte boundary
+   comp_offset = ALIGN(LZSS_HEADER_LENGTH + bit_length, 4);
+   uncomp_offset = comp_offset + comp_count * 2;
+   comp = &out[comp_offset];
+   uncomp = &out[uncomp_offset];
+
+   memcpy(out, "MIO0", 4);
+   write_u32_be(&out[4], length);
+   write_u32_be(&out[8], comp_offset);
+   write_u32_be(&out[12], uncomp_offset);
+   memset(bits, 0, comp_offset - LZSS_HEADER_LENGTH);
+
+   for (int i = 0; i < count; i++) {
+      if (tokens[i].length > 1) {
+         write_u16_be(comp, ((tokens[i].length - 3) << 12) | (tokens[i].distance - 1));
+         comp += 2;
+      } else {
+         bits[i / 8] |= 0x80 >> (i % 8);
+         *uncomp++ = in[pos];
+      }
+      pos += tokens[i].length;
+   }
+
+   return uncomp - out;
+}
+
+int lzss_encode(const unsigned char *in, unsigned int length, lzss_format format, lzss_parse_mode mode,
+                unsigned char *out)
+{
+   lzss_token *tokens;
+   int count = lzss_parse(in, length, format, mode, &tokens);
+   int size;
+
+   if (count < 0) {
+      return count;
+   }
+
+   if (format == LZSS_FORMAT_YAY0) {
+      size = write_yay0(in, length, tokens, count, out);
+   } else {
+      size = write_mio0(in, length, tokens, count, out);
+   }
+
+   free(tokens);
+   return size;
+}
+
+int lzss_decoded_size(const unsigned char *in, unsigned int in_size, unsigned int *size)
+{
+   if (in_size < LZSS_HEADER_LENGTH || (memcmp(in, "Yay0", 4) && memcmp(in, "MIO0", 4))) {
+      return 0;
+   }
+   *size = read_u32_be(&in[4]);
+   return 1;
+}
+
+int lzss_decode(const unsigned char *in, unsigned int in_size, unsigned char *out, unsigned int out_size)
+{
+   unsigned int dest_size, link_idx, chunk_idx;
+   unsigned int bit_idx = 0;
+   unsigned int written = 0;
+   int is_yay0;
+
+   if (!lzss_decoded_size(in, in_size, &dest_size) || dest_size > out_size) {
+      return -1;
+   }
+   is_yay0 = !memcmp(in, "Yay0", 4);
+   link_idx = read_u32_be(&in[8]);
+   chunk_idx = read_u32_be(&in[12]);
+
+   while (written < dest_size) {
+      unsigned int bit_byte = LZSS_HEADER_LENGTH + bit_idx / 8;
+      if (bit_byte >= in_size) {
+         return -2;
+      }
+      if (in[bit_byte] & (0x80 >> (bit_idx % 8))) {
+         if (chunk_idx >= in_size) {
+            return -2;
+         }
+         out[written++] = in[chunk_idx++];
+      } else {
+         unsigned int val, len, dist;
+         if (link_idx + 2 > in_size) {
+            return -2;
+         }
+         val = (in[link_idx] << 8) | in[link_idx + 1];
+         link_idx += 2;
+         dist = (val & 0xFFF) + 1;
+         if (is_yay0) {
+            len = val >> 12;
+            if (len == 0) {
+               if (chunk_idx >= in_size) {
+                  return -2;
+               }
+               len = in[chunk_idx++] + 0x12;
+            } else {
+               len += 2;
+            }
+         } else {
+            len = (val >> 12) + 3;
+         }
+         if (dist > written || written + len > dest_size) {
+            return -3;
+         }
+         for (unsigned int i = 0; i < len; i++, written++) {
+            out[written] = out[written - dist];
+         }
+      }
+      bit_idx++;
+   }
+
+   return written;
+}
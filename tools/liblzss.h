@@ -0,0 +1,71 @@
+#ifndef LIBLZSS_H_
+#define LIBLZSS_H_
+
+// Encoder for the two LZSS formats the game can decompress, Yay0 and MIO0.
+// Both use a 4096 byte window and 16-bit back references, and only differ in
+// how the control bits and lengths are stored. Nothing here uses globals, so
+// any number of files can be encoded at once.
+
+// defines
+
+#define LZSS_HEADER_LENGTH 16
+#define LZSS_WINDOW_SIZE   4096
+#define LZSS_MIN_MATCH     3
+
+// worst case encoded size of 'length' bytes, for sizing output buffers
+#define LZSS_MAX_ENCODED_SIZE(length) (LZSS_HEADER_LENGTH + ((length) + 31) / 32 * 4 + (length))
+
+// typedefs
+
+typedef enum
+{
+   LZSS_FORMAT_YAY0,
+   LZSS_FORMAT_MIO0,
+} lzss_format;
+
+typedef enum
+{
+   // longest match with one byte of lookahead, the parse the old slienc and mio0 encoders used
+   LZSS_PARSE_LAZY,
+   // picks the sequence of literals and matches with the smallest encoded size
+   LZSS_PARSE_OPTIMAL,
+} lzss_parse_mode;
+
+typedef struct
+{
+   unsigned int length;   // 1 for a literal
+   unsigned int distance; // 0 for a literal
+} lzss_token;
+
+// function prototypes
+
+// longest match length a format can store
+unsigned int lzss_max_match(lzss_format format);
+
+// split data into literals and back references
+// in: buffer containing raw data
+// length: size of 'in'
+// tokens: receives a buffer of tokens that must be freed by the caller
+// returns number of tokens, or negative value on failure
+int lzss_parse(const unsigned char *in, unsigned int length, lzss_format format, lzss_parse_mode mode,
+               lzss_token **tokens);
+
+// encode data in memory
+// in: buffer containing raw data
+// out: buffer of at least LZSS_MAX_ENCODED_SIZE(length) bytes
+// returns size of encoded data in 'out' including header, or negative value on failure
+int lzss_encode(const unsigned char *in, unsigned int length, lzss_format format, lzss_parse_mode mode,
+                unsigned char *out);
+
+// decode Yay0 or MIO0 data in memory, checking every reference
+// in: buffer containing encoded data, with either header
+// in_size: size of 'in'
+// out: buffer of at least 'out_size' bytes
+// returns bytes written to 'out' or negative value on failure
+int lzss_decode(const unsigned char *in, unsigned int in_size, unsigned char *out, unsigned int out_size);
+
+// get the decoded size from a Yay0 or MIO0 header
+// returns 1 if valid header, 0 otherwise
+int lzss_decoded_size(const unsigned char *in, unsigned int in_size, unsigned int *size);
+
+#endif // LIBLZSS_H_
@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "liblz4.h"
+#include "utils.h"
+
+// lz4pack: compresses a file to LZ4S for COMPRESS=lz4
+
+static void print_usage(void)
+{
+   ERROR("Usage: lz4pack [-l] FILE_IN FILE_OUT\n"
+         "\n"
+         "Optional arguments:\n"
+         " -l  use the lazy parser (faster, larger output)\n");
+   exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+   lz4s_parse_mode mode = LZ4S_PARSE_OPTIMAL;
+   unsigned char *in_buf, *out_buf;
+   long in_size;
+   int out_size;
+   int arg = 1;
+
+   if (argc > 1 && !strcmp(argv[1], "-l")) {
+      mode = LZ4S_PARSE_LAZY;
+      arg++;
+   }
+   if (argc - arg < 2) {
+      print_usage();
+   }
+
+   in_size = read_file(argv[arg], &in_buf);
+   if (in_size < 0) {
+      ERROR("Error reading \"%s\"\n", argv[arg]);
+      return 1;
+   }
+
+   out_buf = malloc(LZ4S_MAX_ENCODED_SIZE(in_size));
+   out_size = lz4s_encode(in_buf, in_size, mode, out_buf);
+   if (out_size < 0) {
+      ERROR("Error encoding \"%s\"\n", argv[arg]);
+      return 1;
+   }
+
+   if (write_file(argv[arg + 1], out_buf, out_size) != out_size) {
+      ERROR("Error writing \"%s\"\n", argv[arg + 1]);
+      return 1;
+   }
+
+   free(in_buf);
+   free(out_buf);
+
+   return 0;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "liblz4.h"
+#include "liblzss.h"
+#include "utils.h"
+
+// lzbench: compares the lazy and optimal parsers of liblzss and liblz4 on a set
+// of files, checking that everything decodes back to the original data.
+
+typedef enum
+{
+   BENCH_YAY0,
+   BENCH_MIO0,
+   BENCH_LZ4,
+} bench_format;
+
+typedef struct
+{
+   unsigned long size;
+   double seconds;
+} bench_result;
+
+static void print_usage(void)
+{
+   ERROR("Usage: lzbench [-f yay0|mio0|lz4] FILE...\n"
+         "\n"
+         "Encodes every FILE with the lazy and the optimal parser and prints\n"
+         "the encoded sizes and encoding speed of both.\n");
+   exit(1);
+}
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// returns 0 on success
+static int bench_one(const unsigned char *in, unsigned int length, bench_format format, int optimal,
+                     unsigned char *out, unsigned char *check, bench_result *result)
+{
+   double start = now();
+   int size, decoded;
+
+   if (format == BENCH_LZ4) {
+      size = lz4s_encode(in, length, optimal ? LZ4S_PARSE_OPTIMAL : LZ4S_PARSE_LAZY, out);
+   } else {
+      size = lzss_encode(in, length, (format == BENCH_MIO0) ? LZSS_FORMAT_MIO0 : LZSS_FORMAT_YAY0,
+                         optimal ? LZSS_PARSE_OPTIMAL : LZSS_PARSE_LAZY, out);
+   }
+   result->seconds = now() - start;
+   if (size < 0) {
+      return 1;
+   }
+   result->size = size;
+
+   if (format == BENCH_LZ4) {
+      decoded = lz4s_decode(out, size, check, length);
+   } else {
+      decoded = lzss_decode(out, size, check, length);
+   }
+   if (decoded != (int)length || memcmp(in, check, length)) {
+      return 2;
+   }
+   return 0;
+}
+
+static double mb_per_sec(unsigned long bytes, double seconds)
+{
+   return (seconds > 0) ? (bytes / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+int main(int argc, char *argv[])
+{
+   bench_format format = BENCH_YAY0;
+   bench_result lazy_total = {0, 0};
+   bench_result optimal_total = {0, 0};
+   unsigned long raw_total = 0;
+   int failures = 0;
+   int first_file = 1;
+
+   if (argc > 2 && !strcmp(argv[1], "-f")) {
+      if (!strcmp(argv[2], "mio0")) {
+         format = BENCH_MIO0;
+      } else if (!strcmp(argv[2], "lz4")) {
+         format = BENCH_LZ4;
+      } else if (strcmp(argv[2], "yay0")) {
+         print_usage();
+      }
+      first_file = 3;
+   }
+   if (first_file >= argc) {
+      print_usage();
+   }
+
+   printf("%-48s %9s %9s %9s %7s %9s %9s\n", "file", "raw", "lazy", "optimal", "saved", "lazy MB/s", "opt MB/s");
+
+   for (int i = first_file; i < argc; i++) {
+      bench_result lazy, optimal;
+      unsigned char *in, *out, *check;
+      long length;
+      int ret;
+
+      length = read_file(argv[i], &in);
+      if (length < 0) {
+         ERROR("Error reading \"%s\"\n", argv[i]);
+         failures++;
+         continue;
+      }
+      out = malloc(MAX(LZSS_MAX_ENCODED_SIZE(length), LZ4S_MAX_ENCODED_SIZE(length)));
+      check = malloc(MAX(length, 1));
+
+      ret = bench_one(in, length, format, 0, out, check, &lazy);
+      if (ret == 0) {
+         ret = bench_one(in, length, format, 1, out, check, &optimal);
+      }
+
+      if (ret != 0) {
+         ERROR("%s: %s\n", argv[i], (ret == 1) ? "encode failed" : "decoded data does not match");
+         failures++;
+      } else {
+         printf("%-48s %9ld %9lu %9lu %6.2f%% %9.2f %9.2f\n", argv[i], length, lazy.size, optimal.size,
+                (lazy.size > 0) ? 100.0 * ((double)lazy.size - optimal.size) / lazy.size : 0.0,
+                mb_per_sec(length, lazy.seconds), mb_per_sec(length, optimal.seconds));
+         raw_total += length;
+         lazy_total.size += lazy.size;
+         lazy_total.seconds += lazy.seconds;
+         optimal_total.size += optimal.size;
+         optimal_total.seconds += optimal.seconds;
+      }
+
+      free(in);
+      free(out);
+      free(check);
+   }
+
+   printf("%-48s %9lu %9lu %9lu %6.2f%% %9.2f %9.2f\n", "total", raw_total, lazy_total.size, optimal_total.size,
+          (lazy_total.size > 0) ? 100.0 * ((double)lazy_total.size - optimal_total.size) / lazy_total.size : 0.0,
+          mb_per_sec(raw_total, lazy_total.seconds), mb_per_sec(raw_total, optimal_total.seconds));
+
+   return failures ? 1 : 0;
+}
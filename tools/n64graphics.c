@@ -618,8 +618,15 @@ const char *n64graphics_get_write_version(void)
 }
 
 #ifdef N64GRAPHICS_STANDALONE
-#define N64GRAPHICS_VERSION "0.4"
+#define N64GRAPHICS_VERSION "0.5"
 #include <string.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
 
 typedef enum
 {
@@ -643,6 +650,8 @@ typedef struct
    int bin_truncate;
    int pal_truncate;
    int rotate_envmap;
+   char *batch_filename;
+   int batch_threads;
 } graphics_config;
 
 static const graphics_config default_config =
@@ -661,6 +670,8 @@ static const graphics_config default_config =
    .bin_truncate = 1,
    .pal_truncate = 1,
    .rotate_envmap = 0,
+   .batch_filename = NULL,
+   .batch_threads = 0,
 };
 
 typedef struct
@@ -744,6 +755,7 @@ static int parse_encoding(write_encoding *encoding, const char *str)
 static void print_usage(void)
 {
    ERROR("Usage: n64graphics -e/-i BIN_FILE -g IMG_FILE [-p PAL_FILE] [-o BIN_OFFSET] [-P PAL_OFFSET] [-f FORMAT] [-c CI_FORMAT] [-w WIDTH] [-h HEIGHT] [-r ROTATE] [-V]\n"
+         "       n64graphics -b MANIFEST [-j THREADS]\n"
          "\n"
          "n64graphics v" N64GRAPHICS_VERSION ": N64 graphics manipulator\n"
          "\n"
@@ -762,6 +774,10 @@ static void print_usage(void)
          " -c CI_FORMAT  CI palette format: rgba16, ia16 (default: %s)\n"
          " -p PAL_FILE   palette binary file to import/export from/to\n"
          " -P PAL_OFFSET starting offset in PAL_FILE (prevents truncation during import)\n"
+         "Batch arguments:\n"
+         " -b MANIFEST   import every job in MANIFEST, one \"SCHEME FORMAT IMG_FILE BIN_FILE\" per line,\n"
+         "               skipping jobs whose BIN_FILE is already newer than IMG_FILE (RGBA, IA and I only)\n"
+         " -j THREADS    number of threads to convert with (default: one per CPU)\n"
          "Other arguments:\n"
          " -v            verbose logging\n"
          " -V            print version information\n",
@@ -786,6 +802,10 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
    for (int i = 1; i < argc; i++) {
       if (argv[i][0] == '-') {
          switch (argv[i][1]) {
+            case 'b':
+               if (++i >= argc) return 0;
+               config->batch_filename = argv[i];
+               break;
             case 'c':
                if (++i >= argc) return 0;
                if (!parse_format(&config->pal_format, argv[i])) {
@@ -816,6 +836,10 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
                config->bin_filename = argv[i];
                config->mode = MODE_IMPORT;
                break;
+            case 'j':
+               if (++i >= argc) return 0;
+               config->batch_threads = strtoul(argv[i], NULL, 0);
+               break;
             case 'o':
                if (++i >= argc) return 0;
                config->bin_offset = strtoul(argv[i], NULL, 0);
@@ -869,6 +893,9 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
 // returns 1 if config is valid
 static int valid_config(const graphics_config *config)
 {
+   if (config->batch_filename) {
+      return 1;
+   }
    if (!config->bin_filename || !config->img_filename) {
       return 0;
    }
@@ -881,6 +908,256 @@ static int valid_config(const graphics_config *config)
    return 1;
 }
 
+// read IMG_FILENAME and convert it to raw RGBA, IA or I texture data in *raw, which the caller frees
+// returns the length of the raw data, or 0 on error
+static int png2raw(uint8_t **raw, const char *img_filename, const img_format *format, int *width, int *height)
+{
+   rgba *imgr = NULL;
+   ia *imgi = NULL;
+   int raw_size;
+   int length = 0;
+
+   *raw = NULL;
+   switch (format->format) {
+      case IMG_FORMAT_RGBA:
+         imgr = png2rgba(img_filename, width, height);
+         break;
+      case IMG_FORMAT_IA:
+      case IMG_FORMAT_I:
+         imgi = png2ia(img_filename, width, height);
+         break;
+      default:
+         return 0;
+   }
+   if (!imgr && !imgi) {
+      return 0;
+   }
+
+   raw_size = (*width * *height * format->depth + 7) / 8;
+   *raw = malloc(raw_size);
+   if (!*raw) {
+      ERROR("Error allocating %u bytes\n", raw_size);
+   } else if (imgr) {
+      length = rgba2raw(*raw, imgr, *width, *height, format->depth);
+   } else if (format->format == IMG_FORMAT_IA) {
+      length = ia2raw(*raw, imgi, *width, *height, format->depth);
+   } else {
+      length = i2raw(*raw, imgi, *width, *height, format->depth);
+   }
+
+   free(imgr);
+   free(imgi);
+   return length;
+}
+
+//---------------------------------------------------------
+// batch mode: converts the textures of a whole build in one process, so the build doesn't
+// start (and set up) one n64graphics per PNG
+//---------------------------------------------------------
+
+typedef struct
+{
+   char *img_filename;
+   char *bin_filename;
+   img_format format;
+   write_encoding encoding;
+} batch_job;
+
+typedef struct
+{
+   batch_job *jobs;
+   int count;
+   int next;      // next job to hand out to a thread
+   int converted;
+   int failures;
+   pthread_mutex_t lock;
+} batch_queue;
+
+// returns 1 if BIN_FILENAME exists and is at least as new as IMG_FILENAME. make compares finer
+// timestamps than this, so its per PNG rules still catch an edit within the same second.
+static int batch_job_done(const batch_job *job)
+{
+   struct stat img_stat, bin_stat;
+
+   if (stat(job->bin_filename, &bin_stat) || stat(job->img_filename, &img_stat)) {
+      return 0;
+   }
+   return bin_stat.st_mtime >= img_stat.st_mtime;
+}
+
+// converts one job exactly like "-i BIN_FILE -g IMG_FILE -f FORMAT -s SCHEME" would, returns 1 on success
+static int batch_convert(const batch_job *job)
+{
+   uint8_t *raw;
+   FILE *bin_fp;
+   int width, height;
+   int length;
+   int flength;
+   int ret = 0;
+
+   length = png2raw(&raw, job->img_filename, &job->format, &width, &height);
+   if (length <= 0) {
+      ERROR("Error converting \"%s\" to raw format\n", job->img_filename);
+      free(raw);
+      return 0;
+   }
+
+   bin_fp = fopen(job->bin_filename, "wb");
+   if (!bin_fp) {
+      ERROR("Error opening \"%s\"\n", job->bin_filename);
+   } else {
+      flength = fprint_write_output(bin_fp, job->encoding, raw, length);
+      if (job->encoding == ENCODING_RAW && flength != length) {
+         ERROR("Error writing %d bytes to \"%s\"\n", length, job->bin_filename);
+      } else {
+         ret = 1;
+      }
+      if (fclose(bin_fp)) {
+         ERROR("Error writing to \"%s\"\n", job->bin_filename);
+         ret = 0;
+      }
+      if (!ret) {
+         // don't leave a truncated file behind that looks up to date
+         remove(job->bin_filename);
+      }
+   }
+
+   free(raw);
+   return ret;
+}
+
+static void *batch_thread(void *arg)
+{
+   batch_queue *queue = arg;
+
+   for (;;) {
+      const batch_job *job;
+      int ok;
+
+      pthread_mutex_lock(&queue->lock);
+      job = (queue->next < queue->count) ? &queue->jobs[queue->next++] : NULL;
+      pthread_mutex_unlock(&queue->lock);
+      if (!job) {
+         break;
+      }
+
+      if (batch_job_done(job)) {
+         continue;
+      }
+      ok = batch_convert(job);
+
+      pthread_mutex_lock(&queue->lock);
+      if (ok) {
+         queue->converted++;
+      } else {
+         queue->failures++;
+      }
+      pthread_mutex_unlock(&queue->lock);
+   }
+   return NULL;
+}
+
+static int cpu_count(void)
+{
+#if defined(_WIN32)
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwNumberOfProcessors;
+#else
+   return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+// parses the manifest in place, returns the number of jobs or -1 on error
+static int parse_manifest(char *text, batch_job **jobs)
+{
+   int capacity = 256;
+   int count = 0;
+   int line_num = 0;
+   char *line = text;
+
+   *jobs = malloc(capacity * sizeof(**jobs));
+   while (line && *line) {
+      char *fields[4];
+      char *next = strchr(line, '\n');
+      int n = 0;
+
+      if (next) {
+         *next++ = '\0';
+      }
+      line_num++;
+
+      for (char *tok = strtok(line, " \t\r"); tok && n < 4; tok = strtok(NULL, " \t\r")) {
+         fields[n++] = tok;
+      }
+      line = next;
+      if (n == 0 || fields[0][0] == '#') {
+         continue;
+      }
+
+      if (count == capacity) {
+         capacity *= 2;
+         *jobs = realloc(*jobs, capacity * sizeof(**jobs));
+      }
+      batch_job *job = &(*jobs)[count];
+      if (n < 4 || !parse_encoding(&job->encoding, fields[0]) || !parse_format(&job->format, fields[1]) ||
+          job->format.format == IMG_FORMAT_CI) {
+         ERROR("Error: bad job on line %d of the manifest\n", line_num);
+         return -1;
+      }
+      job->img_filename = fields[2];
+      job->bin_filename = fields[3];
+      count++;
+   }
+   return count;
+}
+
+static int batch_main(const graphics_config *config)
+{
+   batch_queue queue = {0};
+   pthread_t *threads;
+   unsigned char *manifest;
+   char *text;
+   long length;
+   int thread_count;
+
+   length = read_file(config->batch_filename, &manifest);
+   if (length < 0) {
+      ERROR("Error reading \"%s\"\n", config->batch_filename);
+      return EXIT_FAILURE;
+   }
+   text = malloc(length + 1);
+   memcpy(text, manifest, length);
+   text[length] = '\0';
+   free(manifest);
+
+   queue.count = parse_manifest(text, &queue.jobs);
+   if (queue.count < 0) {
+      return EXIT_FAILURE;
+   }
+
+   thread_count = (config->batch_threads > 0) ? config->batch_threads : cpu_count();
+   thread_count = MAX(1, MIN(thread_count, queue.count));
+   threads = malloc(thread_count * sizeof(*threads));
+   pthread_mutex_init(&queue.lock, NULL);
+
+   // stb_image only keeps the last error message in a global, everything else is per call
+   for (int i = 0; i < thread_count; i++) {
+      pthread_create(&threads[i], NULL, batch_thread, &queue);
+   }
+   for (int i = 0; i < thread_count; i++) {
+      pthread_join(threads[i], NULL);
+   }
+   pthread_mutex_destroy(&queue.lock);
+
+   INFO("Converted %d of %d textures with %d threads\n", queue.converted, queue.count, thread_count);
+
+   free(threads);
+   free(queue.jobs);
+   free(text);
+   return queue.failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
    graphics_config config = default_config;
@@ -899,6 +1176,10 @@ int main(int argc, char *argv[])
       exit(EXIT_FAILURE);
    }
 
+   if (config.batch_filename) {
+      return batch_main(&config);
+   }
+
    if (config.mode == MODE_IMPORT) {
       if (0 == strcmp("-", config.bin_filename)) {
          bin_fp = stdout;
@@ -918,31 +1199,9 @@ int main(int argc, char *argv[])
       }
       switch (config.format.format) {
          case IMG_FORMAT_RGBA:
-            imgr = png2rgba(config.img_filename, &config.width, &config.height);
-            raw_size = (config.width * config.height * config.format.depth + 7) / 8;
-            raw = malloc(raw_size);
-            if (!raw) {
-               ERROR("Error allocating %u bytes\n", raw_size);
-            }
-            length = rgba2raw(raw, imgr, config.width, config.height, config.format.depth);
-            break;
          case IMG_FORMAT_IA:
-            imgi = png2ia(config.img_filename, &config.width, &config.height);
-            raw_size = (config.width * config.height * config.format.depth + 7) / 8;
-            raw = malloc(raw_size);
-            if (!raw) {
-               ERROR("Error allocating %u bytes\n", raw_size);
-            }
-            length = ia2raw(raw, imgi, config.width, config.height, config.format.depth);
-            break;
          case IMG_FORMAT_I:
-            imgi = png2ia(config.img_filename, &config.width, &config.height);
-            raw_size = (config.width * config.height * config.format.depth + 7) / 8;
-            raw = malloc(raw_size);
-            if (!raw) {
-               ERROR("Error allocating %u bytes\n", raw_size);
-            }
-            length = i2raw(raw, imgi, config.width, config.height, config.format.depth);
+            length = png2raw(&raw, config.img_filename, &config.format, &config.width, &config.height);
             break;
          case IMG_FORMAT_CI:
          {
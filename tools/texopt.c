@@ -0,0 +1,739 @@
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "exoquant/exoquant.h"
+#include "n64graphics.h"
+#include "utils.h"
+
+// texopt: finds the smallest texture format that draws every PNG the same as the format its
+// filename asks for, or within a tolerance, and can rename the PNGs and rewrite the display
+// lists that load them to use it.
+//
+// Every candidate is checked by converting the PNG the way the build does (n64graphics for
+// RGBA, IA and I, an RGBA16 palette for CI) and comparing the texels the RDP would see.
+
+typedef enum
+{
+   TEX_RGBA,
+   TEX_IA,
+   TEX_I,
+   TEX_CI,
+} tex_kind;
+
+typedef struct
+{
+   const char *name;    // filename suffix
+   tex_kind kind;
+   int depth;
+   const char *gbi_fmt; // G_IM_FMT_*
+   const char *gbi_siz; // G_IM_SIZ_*
+} tex_format;
+
+// smallest texels first, so ties go to the format without a palette
+static const tex_format format_table[] =
+{
+   {"i4",     TEX_I,     4, "G_IM_FMT_I",    "G_IM_SIZ_4b"},
+   {"ia4",    TEX_IA,    4, "G_IM_FMT_IA",   "G_IM_SIZ_4b"},
+   {"ci4",    TEX_CI,    4, "G_IM_FMT_CI",   "G_IM_SIZ_4b"},
+   {"i8",     TEX_I,     8, "G_IM_FMT_I",    "G_IM_SIZ_8b"},
+   {"ia8",    TEX_IA,    8, "G_IM_FMT_IA",   "G_IM_SIZ_8b"},
+   {"ci8",    TEX_CI,    8, "G_IM_FMT_CI",   "G_IM_SIZ_8b"},
+   {"ia16",   TEX_IA,   16, "G_IM_FMT_IA",   "G_IM_SIZ_16b"},
+   {"rgba16", TEX_RGBA, 16, "G_IM_FMT_RGBA", "G_IM_SIZ_16b"},
+   {"rgba32", TEX_RGBA, 32, "G_IM_FMT_RGBA", "G_IM_SIZ_32b"},
+};
+
+// CI textures share TMEM with their palette
+#define TMEM_CI_TEXEL_BYTES 2048
+
+typedef struct
+{
+   const tex_format *format;
+   int bytes;
+   int error; // largest difference of any channel of any texel, 0 to 255
+} candidate;
+
+typedef struct
+{
+   int tolerance;
+   int opaque;
+   int write;
+   char **source_dirs;
+   int source_dir_count;
+} texopt_config;
+
+typedef struct
+{
+   char *path;
+   char *text;
+   size_t length;
+   int dirty;
+} source_file;
+
+typedef struct
+{
+   source_file *files;
+   int count;
+   int capacity;
+} source_list;
+
+static void print_usage(void)
+{
+   ERROR("Usage: texopt [-t TOLERANCE] [-o] [-w [-d SOURCE_DIR]...] PNG...\n"
+         "\n"
+         "Reports the smallest format that stores each PNG exactly, and the smallest one that is\n"
+         "within TOLERANCE of it. The format a PNG is built with comes from its name (name.rgba16.png).\n"
+         "\n"
+         "Optional arguments:\n"
+         " -t TOLERANCE  largest difference allowed on any channel of any texel, 0-255 (default: 0)\n"
+         " -o            assume fully opaque textures are drawn on opaque layers, where their alpha\n"
+         "               doesn't matter (I textures read their alpha from the intensity)\n"
+         " -w            rename each PNG to the smallest RGBA, IA or I format within TOLERANCE and\n"
+         "               update the gsDPLoadTextureBlock commands that load it. Textures used in any\n"
+         "               other way are only reported. CI formats need a palette load and are never\n"
+         "               written.\n"
+         " -d SOURCE_DIR directory of .c and .h files to update (default: actors bin levels src)\n");
+   exit(EXIT_FAILURE);
+}
+
+static const tex_format *find_format(const char *name)
+{
+   for (unsigned i = 0; i < DIM(format_table); i++) {
+      if (!strcmp(name, format_table[i].name)) {
+         return &format_table[i];
+      }
+   }
+   return NULL;
+}
+
+// the format in "name.FORMAT.png", or NULL
+static const tex_format *format_from_filename(const char *png_filename)
+{
+   char suffix[16];
+   const char *end = strrchr(png_filename, '.');
+   const char *start = end;
+
+   if (!end || strcmp(end, ".png")) {
+      return NULL;
+   }
+   while (start > png_filename && start[-1] != '.' && start[-1] != '/') {
+      start--;
+   }
+   if (start == png_filename || start[-1] != '.' || end - start >= (int)sizeof(suffix)) {
+      return NULL;
+   }
+   memcpy(suffix, start, end - start);
+   suffix[end - start] = '\0';
+   return find_format(suffix);
+}
+
+static int texel_bytes(const tex_format *format, int width, int height)
+{
+   return (width * height * format->depth + 7) / 8;
+}
+
+static int texture_bytes(const tex_format *format, int width, int height)
+{
+   int bytes = texel_bytes(format, width, height);
+   if (format->kind == TEX_CI) {
+      bytes += sizeof(uint16_t) << format->depth;
+   }
+   return bytes;
+}
+
+// RGBA16 round trip of a single color
+static rgba rgba16_color(rgba color)
+{
+   uint8_t raw[2];
+   rgba *img;
+   rgba out;
+
+   rgba2raw(raw, &color, 1, 1, 16);
+   img = raw2rgba(raw, 1, 1, 16);
+   out = *img;
+   free(img);
+   return out;
+}
+
+// the texels the RDP sees when IMG is built as FORMAT (RGBA, IA or I), in *out
+static void decode_texels(rgba *out, const rgba *img, int width, int height, const tex_format *format)
+{
+   int count = width * height;
+   uint8_t *raw = malloc(texel_bytes(format, width, height) + 1);
+   rgba *rgba_img = NULL;
+   ia *ia_img = NULL;
+   ia *decoded = NULL;
+
+   if (format->kind == TEX_RGBA) {
+      rgba2raw(raw, img, width, height, format->depth);
+      rgba_img = raw2rgba(raw, width, height, format->depth);
+      memcpy(out, rgba_img, count * sizeof(*out));
+      free(rgba_img);
+      free(raw);
+      return;
+   }
+
+   // the same averaging n64graphics does when it reads a PNG as IA
+   ia_img = malloc(count * sizeof(*ia_img));
+   for (int i = 0; i < count; i++) {
+      ia_img[i].intensity = (img[i].red + img[i].green + img[i].blue + 1) / 3;
+      ia_img[i].alpha = img[i].alpha;
+   }
+   if (format->kind == TEX_IA) {
+      ia2raw(raw, ia_img, width, height, format->depth);
+      decoded = raw2ia(raw, width, height, format->depth);
+   } else {
+      i2raw(raw, ia_img, width, height, format->depth);
+      decoded = raw2i(raw, width, height, format->depth);
+   }
+   for (int i = 0; i < count; i++) {
+      out[i].red = out[i].green = out[i].blue = decoded[i].intensity;
+      // the RDP reads the alpha of I texels from their intensity
+      out[i].alpha = (format->kind == TEX_I) ? decoded[i].intensity : decoded[i].alpha;
+   }
+
+   free(decoded);
+   free(ia_img);
+   free(raw);
+}
+
+// the texels of IMG as CI with an RGBA16 palette, in *out. Exact if it has few enough colors,
+// quantized with exoquant otherwise.
+static void decode_ci_texels(rgba *out, const rgba *img, int width, int height, const tex_format *format)
+{
+   int count = width * height;
+   int max_colors = 1 << format->depth;
+   uint8_t *seen = calloc(0x10000 / 8, 1);
+   uint8_t *raw16 = malloc(count * 2);
+   rgba *rgba16_img;
+   int colors = 0;
+
+   rgba2raw(raw16, img, width, height, 16);
+   for (int i = 0; i < count && colors <= max_colors; i++) {
+      uint16_t val = read_u16_be(&raw16[i * 2]);
+      if (!(seen[val / 8] & (1 << (val % 8)))) {
+         seen[val / 8] |= 1 << (val % 8);
+         colors++;
+      }
+   }
+
+   if (colors <= max_colors) {
+      rgba16_img = raw2rgba(raw16, width, height, 16);
+      memcpy(out, rgba16_img, count * sizeof(*out));
+      free(rgba16_img);
+   } else {
+      rgba palette[256];
+      uint8_t *indices = malloc(count);
+      exq_data *exq = exq_init();
+
+      exq_feed(exq, (uint8_t *)img, count);
+      exq_quantize_hq(exq, max_colors);
+      exq_get_palette(exq, (uint8_t *)palette, max_colors);
+      exq_map_image(exq, count, (uint8_t *)img, indices);
+      exq_free(exq);
+      for (int i = 0; i < max_colors; i++) {
+         palette[i] = rgba16_color(palette[i]);
+      }
+      for (int i = 0; i < count; i++) {
+         out[i] = palette[indices[i]];
+      }
+      free(indices);
+   }
+
+   free(raw16);
+   free(seen);
+}
+
+static int max_error(const rgba *a, const rgba *b, int count, int ignore_alpha)
+{
+   int error = 0;
+   for (int i = 0; i < count; i++) {
+      error = MAX(error, abs(a[i].red - b[i].red));
+      error = MAX(error, abs(a[i].green - b[i].green));
+      error = MAX(error, abs(a[i].blue - b[i].blue));
+      if (!ignore_alpha) {
+         error = MAX(error, abs(a[i].alpha - b[i].alpha));
+      }
+   }
+   return error;
+}
+
+//---------------------------------------------------------
+// rewriting sources
+//---------------------------------------------------------
+
+static int is_ident_char(char c)
+{
+   return isalnum((unsigned char)c) || c == '_';
+}
+
+static void load_sources(source_list *list, const char *dir_path)
+{
+   DIR *dir = opendir(dir_path);
+   struct dirent *entry;
+
+   if (!dir) {
+      ERROR("Error opening directory \"%s\"\n", dir_path);
+      return;
+   }
+   while ((entry = readdir(dir)) != NULL) {
+      struct stat st;
+      char *path;
+      size_t name_len = strlen(entry->d_name);
+
+      if (entry->d_name[0] == '.') {
+         continue;
+      }
+      path = malloc(strlen(dir_path) + name_len + 2);
+      sprintf(path, "%s/%s", dir_path, entry->d_name);
+      if (stat(path, &st)) {
+         free(path);
+         continue;
+      }
+      if (S_ISDIR(st.st_mode)) {
+         load_sources(list, path);
+         free(path);
+      } else if (name_len > 2 && entry->d_name[name_len - 2] == '.' &&
+                 (entry->d_name[name_len - 1] == 'c' || entry->d_name[name_len - 1] == 'h')) {
+         source_file *file;
+         unsigned char *data;
+         long length = read_file(path, &data);
+
+         if (length < 0) {
+            ERROR("Error reading \"%s\"\n", path);
+            free(path);
+            continue;
+         }
+         if (list->count == list->capacity) {
+            list->capacity = MAX(256, list->capacity * 2);
+            list->files = realloc(list->files, list->capacity * sizeof(*list->files));
+         }
+         file = &list->files[list->count++];
+         file->path = path;
+         file->text = malloc(length + 1);
+         memcpy(file->text, data, length);
+         file->text[length] = '\0';
+         file->length = length;
+         file->dirty = 0;
+         free(data);
+      } else {
+         free(path);
+      }
+   }
+   closedir(dir);
+}
+
+// replaces LENGTH bytes at OFFSET of FILE with REPLACEMENT
+static void replace_text(source_file *file, size_t offset, size_t length, const char *replacement)
+{
+   size_t new_len = strlen(replacement);
+   size_t total = file->length - length + new_len;
+
+   if (new_len > length) {
+      file->text = realloc(file->text, total + 1);
+   }
+   memmove(file->text + offset + new_len, file->text + offset + length, file->length - offset - length + 1);
+   memcpy(file->text + offset, replacement, new_len);
+   file->length = total;
+   file->dirty = 1;
+}
+
+// finds the next whole word WORD in TEXT from START
+static char *find_word(char *text, char *start, const char *word)
+{
+   size_t len = strlen(word);
+   char *p = start;
+
+   while ((p = strstr(p, word)) != NULL) {
+      if ((p == text || !is_ident_char(p[-1])) && !is_ident_char(p[len])) {
+         return p;
+      }
+      p += len;
+   }
+   return NULL;
+}
+
+#define MAX_MACRO_ARGS 16
+
+typedef struct
+{
+   char *start; // the macro name
+   char *end;   // one past the closing parenthesis
+   int is_4b;
+   int arg_count;
+   char *args[MAX_MACRO_ARGS];
+   int arg_lengths[MAX_MACRO_ARGS];
+} load_block_call;
+
+// parses the gsDPLoadTextureBlock(_4b) call whose first argument is at SYMBOL, returns 0 if
+// SYMBOL isn't the texture argument of one
+static int parse_load_block(const source_file *file, char *symbol, load_block_call *call)
+{
+   static const char *const names[] = { "gsDPLoadTextureBlock_4b", "gsDPLoadTextureBlock" };
+   char *p = symbol;
+   int depth = 0;
+
+   while (p > file->text && isspace((unsigned char)p[-1])) {
+      p--;
+   }
+   if (p == file->text || p[-1] != '(') {
+      return 0;
+   }
+   p--;
+   call->start = NULL;
+   for (unsigned i = 0; i < DIM(names); i++) {
+      size_t len = strlen(names[i]);
+      if (p - file->text >= (long)len && !strncmp(p - len, names[i], len) &&
+          (p - len == file->text || !is_ident_char(p[-len - 1]))) {
+         call->start = p - len;
+         call->is_4b = (i == 0);
+         break;
+      }
+   }
+   if (!call->start) {
+      return 0;
+   }
+
+   call->arg_count = 0;
+   for (char *arg = p + 1, *q = p + 1; *q; q++) {
+      if (*q == '(') {
+         depth++;
+      } else if (*q == ')' && depth > 0) {
+         depth--;
+      } else if ((*q == ',' && depth == 0) || *q == ')') {
+         char *arg_end = q;
+         if (call->arg_count == MAX_MACRO_ARGS) {
+            return 0;
+         }
+         while (isspace((unsigned char)*arg)) {
+            arg++;
+         }
+         while (arg_end > arg && isspace((unsigned char)arg_end[-1])) {
+            arg_end--;
+         }
+         call->args[call->arg_count] = arg;
+         call->arg_lengths[call->arg_count] = arg_end - arg;
+         call->arg_count++;
+         arg = q + 1;
+         if (*q == ')') {
+            call->end = q + 1;
+            return call->arg_count == (call->is_4b ? 11 : 12);
+         }
+      }
+   }
+   return 0;
+}
+
+static int arg_is(const load_block_call *call, int index, const char *value)
+{
+   return call->arg_lengths[index] == (int)strlen(value) && !strncmp(call->args[index], value, call->arg_lengths[index]);
+}
+
+// the new text of CALL loading its texture as FORMAT
+static char *rewrite_load_block(const load_block_call *call, const tex_format *format)
+{
+   int first_dim = call->is_4b ? 2 : 3;
+   size_t length = 64;
+   char *text;
+   char *p;
+
+   for (int i = 0; i < call->arg_count; i++) {
+      length += call->arg_lengths[i] + 2;
+   }
+   text = malloc(length);
+   if (format->depth == 4) {
+      p = text + sprintf(text, "gsDPLoadTextureBlock_4b(%.*s, %s", call->arg_lengths[0], call->args[0], format->gbi_fmt);
+   } else {
+      p = text + sprintf(text, "gsDPLoadTextureBlock(%.*s, %s, %s", call->arg_lengths[0], call->args[0],
+                         format->gbi_fmt, format->gbi_siz);
+   }
+   for (int i = first_dim; i < call->arg_count; i++) {
+      p += sprintf(p, ", %.*s", call->arg_lengths[i], call->args[i]);
+   }
+   sprintf(p, ")");
+   return text;
+}
+
+// the name of the array the #include at INCLUDE fills, in NAME
+static int array_name_for_include(const source_file *file, const char *include, char *name, size_t name_size)
+{
+   const char *p = include;
+   const char *end;
+
+   while (p > file->text && *p != '[') {
+      if (*p == ';' || *p == '}') {
+         return 0;
+      }
+      p--;
+   }
+   end = p;
+   while (end > file->text && isspace((unsigned char)end[-1])) {
+      end--;
+   }
+   p = end;
+   while (p > file->text && is_ident_char(p[-1])) {
+      p--;
+   }
+   if (p == end || (size_t)(end - p) >= name_size) {
+      return 0;
+   }
+   memcpy(name, p, end - p);
+   name[end - p] = '\0';
+   return 1;
+}
+
+// returns NULL if the texture built from PNG_FILENAME can be loaded as NEW_FORMAT by rewriting
+// the sources, or why it can't. Rewrites them if APPLY is set.
+static const char *rewrite_sources(source_list *sources, const char *png_filename, const tex_format *old_format,
+                                   const tex_format *new_format, int apply)
+{
+   char old_include[1024], new_include[1024];
+   char symbols[8][256];
+   int symbol_count = 0;
+   size_t base_len = strlen(png_filename) - strlen(old_format->name) - strlen(".png");
+
+   if (base_len + 32 >= sizeof(old_include)) {
+      return "path too long";
+   }
+   sprintf(old_include, "\"%.*s%s.inc.c\"", (int)base_len, png_filename, old_format->name);
+   sprintf(new_include, "\"%.*s%s.inc.c\"", (int)base_len, png_filename, new_format->name);
+
+   // find the arrays the texture is included into
+   for (int f = 0; f < sources->count; f++) {
+      source_file *file = &sources->files[f];
+      char *p = file->text;
+
+      while ((p = strstr(p, old_include)) != NULL) {
+         if (symbol_count == (int)DIM(symbols) ||
+             !array_name_for_include(file, p, symbols[symbol_count], sizeof(symbols[0]))) {
+            return "included somewhere other than a texture array";
+         }
+         symbol_count++;
+         if (apply) {
+            replace_text(file, p - file->text, strlen(old_include), new_include);
+         }
+         p += apply ? strlen(new_include) : strlen(old_include);
+      }
+   }
+   if (symbol_count == 0) {
+      return "not included by any source";
+   }
+
+   // every other use of the arrays has to be a gsDPLoadTextureBlock of the old format
+   for (int s = 0; s < symbol_count; s++) {
+      for (int f = 0; f < sources->count; f++) {
+         source_file *file = &sources->files[f];
+         char *p = file->text;
+
+         while ((p = find_word(file->text, p, symbols[s])) != NULL) {
+            char *after = p + strlen(symbols[s]);
+            load_block_call call;
+
+            while (isspace((unsigned char)*after)) {
+               after++;
+            }
+            if (*after == '[') {
+               // the definition, or an extern declaration
+               p = after;
+               continue;
+            }
+            if (!parse_load_block(file, p, &call)) {
+               return "used by something other than gsDPLoadTextureBlock";
+            }
+            if (!arg_is(&call, 1, old_format->gbi_fmt) || (!call.is_4b && !arg_is(&call, 2, old_format->gbi_siz)) ||
+                (call.is_4b != (old_format->depth == 4))) {
+               return "loaded as a different format than its name says";
+            }
+            if (apply) {
+               char *text = rewrite_load_block(&call, new_format);
+               size_t offset = call.start - file->text;
+               replace_text(file, offset, call.end - call.start, text);
+               p = file->text + offset + strlen(text);
+               free(text);
+            } else {
+               p = call.end;
+            }
+         }
+      }
+   }
+   return NULL;
+}
+
+static int write_sources(const source_list *sources)
+{
+   int ret = 1;
+   for (int f = 0; f < sources->count; f++) {
+      const source_file *file = &sources->files[f];
+      if (file->dirty) {
+         if (write_file(file->path, (unsigned char *)file->text, file->length) != (long)file->length) {
+            ERROR("Error writing \"%s\"\n", file->path);
+            ret = 0;
+         }
+      }
+   }
+   return ret;
+}
+
+//---------------------------------------------------------
+// analysis
+//---------------------------------------------------------
+
+static int parse_arguments(int argc, char *argv[], texopt_config *config)
+{
+   int i;
+   for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+      switch (argv[i][1]) {
+         case 'd':
+            if (++i >= argc) return -1;
+            config->source_dirs[config->source_dir_count++] = argv[i];
+            break;
+         case 'o':
+            config->opaque = 1;
+            break;
+         case 't':
+            if (++i >= argc) return -1;
+            config->tolerance = strtoul(argv[i], NULL, 0);
+            break;
+         case 'v':
+            g_verbosity = 1;
+            break;
+         case 'w':
+            config->write = 1;
+            break;
+         default:
+            return -1;
+      }
+   }
+   return (i < argc) ? i : -1;
+}
+
+int main(int argc, char *argv[])
+{
+   static char *default_dirs[] = { "actors", "bin", "levels", "src" };
+   texopt_config config = {0};
+   source_list sources = {0};
+   long total_bytes = 0, exact_bytes = 0, near_bytes = 0, written_bytes = 0;
+   int written = 0;
+   int first_png;
+
+   config.source_dirs = malloc(argc * sizeof(char *));
+   first_png = parse_arguments(argc, argv, &config);
+   if (first_png < 0) {
+      print_usage();
+   }
+   if (config.write) {
+      if (config.source_dir_count == 0) {
+         config.source_dirs = default_dirs;
+         config.source_dir_count = DIM(default_dirs);
+      }
+      for (int i = 0; i < config.source_dir_count; i++) {
+         load_sources(&sources, config.source_dirs[i]);
+      }
+   }
+
+   printf("%-64s %9s %7s %7s %7s %7s %7s %7s %4s\n", "texture", "size", "format", "bytes", "exact", "bytes", "near",
+          "bytes", "err");
+
+   for (int i = first_png; i < argc; i++) {
+      const char *png_filename = argv[i];
+      const tex_format *format = format_from_filename(png_filename);
+      candidate exact = {0}, near = {0}, writable = {0};
+      rgba *img, *stored, *texels;
+      int width, height, count, opaque = 0;
+
+      if (!format) {
+         INFO("Skipping \"%s\", no format in its name\n", png_filename);
+         continue;
+      }
+      img = png2rgba(png_filename, &width, &height);
+      if (!img) {
+         continue;
+      }
+      count = width * height;
+
+      // what the build stores now: CI textures get their palette from an RGBA16 PNG palette
+      stored = malloc(count * sizeof(*stored));
+      texels = malloc(count * sizeof(*texels));
+      if (format->kind == TEX_CI) {
+         decode_texels(stored, img, width, height, find_format("rgba16"));
+      } else {
+         decode_texels(stored, img, width, height, format);
+      }
+      if (config.opaque) {
+         opaque = 1;
+         for (int t = 0; t < count && opaque; t++) {
+            opaque = (stored[t].alpha == 0xFF);
+         }
+      }
+
+      for (unsigned f = 0; f < DIM(format_table); f++) {
+         const tex_format *cand = &format_table[f];
+         candidate c = { cand, texture_bytes(cand, width, height), 0 };
+
+         if (cand->kind == TEX_CI) {
+            if (texel_bytes(cand, width, height) > TMEM_CI_TEXEL_BYTES) {
+               continue;
+            }
+            decode_ci_texels(texels, stored, width, height, cand);
+         } else {
+            decode_texels(texels, img, width, height, cand);
+         }
+         c.error = max_error(stored, texels, count, opaque);
+
+         if (c.error == 0 && (!exact.format || c.bytes < exact.bytes)) {
+            exact = c;
+         }
+         if (c.error <= config.tolerance && (!near.format || c.bytes < near.bytes)) {
+            near = c;
+         }
+         if (cand->kind != TEX_CI && c.error <= config.tolerance && (!writable.format || c.bytes < writable.bytes)) {
+            writable = c;
+         }
+      }
+      // the format it is built with always qualifies, so exact and near are never empty
+      total_bytes += texture_bytes(format, width, height);
+      exact_bytes += exact.bytes;
+      near_bytes += near.bytes;
+
+      printf("%-64s %4dx%-4d %7s %7d %7s %7d %7s %7d %4d%s\n", png_filename, width, height, format->name,
+             texture_bytes(format, width, height), exact.format->name, exact.bytes, near.format->name, near.bytes,
+             near.error, opaque ? " (opaque)" : "");
+
+      if (config.write && format->kind != TEX_CI && writable.format && writable.bytes < texture_bytes(format, width, height)) {
+         const char *reason = rewrite_sources(&sources, png_filename, format, writable.format, 0);
+         if (reason) {
+            printf("  not rewritten as %s: %s\n", writable.format->name, reason);
+         } else {
+            char *new_png = malloc(strlen(png_filename) + 16);
+            size_t base_len = strlen(png_filename) - strlen(format->name) - strlen(".png");
+            sprintf(new_png, "%.*s%s.png", (int)base_len, png_filename, writable.format->name);
+            if (rename(png_filename, new_png)) {
+               printf("  not rewritten as %s: can't rename to \"%s\"\n", writable.format->name, new_png);
+            } else {
+               rewrite_sources(&sources, png_filename, format, writable.format, 1);
+               printf("  rewritten as %s\n", new_png);
+               written_bytes += texture_bytes(format, width, height) - writable.bytes;
+               written++;
+            }
+            free(new_png);
+         }
+      }
+
+      free(texels);
+      free(stored);
+      free(img);
+   }
+
+   printf("%-64s %9s %7s %7ld %7s %7ld %7s %7ld\n", "total", "", "", total_bytes, "", exact_bytes, "", near_bytes);
+   if (config.write) {
+      printf("%d textures rewritten, %ld bytes saved\n", written, written_bytes);
+      if (!write_sources(&sources)) {
+         return EXIT_FAILURE;
+      }
+   }
+   return EXIT_SUCCESS;
+}